@@ -26,10 +26,51 @@ typedef struct VENG_Driver VENG_Driver;
 // Forward declarations (VENG_listeners.c)
 typedef struct VENG_Listeners VENG_Listeners;
 typedef struct VENG_Listener VENG_Listener;
+typedef struct VENG_Hits VENG_Hits;
 
-typedef void (*VENG_ListenerCallback)(VENG_Element* element, SDL_Event* event);
+typedef enum VENG_EventStatus
+{
+	VENG_EVENT_PROPAGATE = 0,
+	VENG_EVENT_CONSUMED // Lower layers won't receive the event
+} VENG_EventStatus;
+
+typedef int (*VENG_ListenerCallback)(VENG_Element* element, SDL_Event* event); // Returns a VENG_EventStatus.
 typedef int (*VENG_ListenerCondition)(VENG_Element* element, SDL_Event* event); // If function returns 0, VENG will call the callback.
 
+typedef enum VENG_HoverState
+{
+	VENG_HOVER_ENTER,
+	VENG_HOVER_LEAVE,
+	VENG_HOVER_MOVE
+} VENG_HoverState;
+
+typedef void (*VENG_HoverCallback)(VENG_Element* element, VENG_HoverState state, SDL_Event* event);
+
+// Forward declarations (VENG_prewarm.c)
+typedef struct VENG_Prewarm VENG_Prewarm;
+
+// Forward declarations (VENG_scroll.c)
+typedef struct VENG_Scroll VENG_Scroll;
+
+// Forward declarations (VENG_anchor.c)
+typedef struct VENG_Anchor VENG_Anchor;
+typedef struct VENG_Anchors VENG_Anchors;
+
+// Forward declarations (VENG_lazy.c)
+typedef struct VENG_Lazy VENG_Lazy;
+
+// Forward declarations (VENG_grid.c)
+typedef struct VENG_Grid VENG_Grid;
+
+// Forward declarations (VENG_shortcut.c)
+typedef struct VENG_Shortcuts VENG_Shortcuts;
+
+// Forward declarations (VENG_focus.c)
+typedef struct VENG_Focus VENG_Focus;
+
+// Forward declarations (VENG.c)
+typedef void (*VENG_PaintCallback)(VENG_Element* element, SDL_Renderer* renderer); // Called between VENG_StartDrawing and VENG_StopDrawing
+
 /*==========================================================================*\
  *                   VENG.c - Core Functions, structs & enums
 \*==========================================================================*/
@@ -64,9 +105,18 @@ typedef enum VENG_ParentType
 typedef enum VENG_Arrangement
 {
 	VENG_HORIZONTAL,
-	VENG_VERTICAL
+	VENG_VERTICAL,
+	VENG_ANCHORED, // Childs are placed by their constraints (VENG_anchor.c), the aligns are ignored
+	VENG_GRID      // Childs fill the cells of VENG_SetGridTracks row by row, the aligns place them in their cell
 } VENG_Arrangement;
 
+typedef enum VENG_LayerMode
+{
+	VENG_LAYER_TRANSPARENT = 0, // Lower layers keep working as usual
+	VENG_LAYER_MODAL,           // Lower layers stop listening
+	VENG_LAYER_OPAQUE           // Lower layers stop listening, being prepared and painted
+} VENG_LayerMode;
+
 typedef enum VENG_Align
 {
 	VENG_LEFT,
@@ -82,6 +132,8 @@ typedef struct VENG_Driver
 	SDL_Renderer* renderer;
 } VENG_Driver;
 
+#define VENG_MAX_WINDOWS 8 // The main one and the ones screens are bound to
+
 typedef struct VENG_Layout
 {
 	VENG_Arrangement arrangement;
@@ -94,28 +146,66 @@ typedef struct VENG_Childs
 	VENG_Element** sub_elements;
 	size_t sub_elements_size;
 	size_t sub_elements_count;
+	size_t sub_elements_queued; // Adds waiting for VENG_EndUpdate
+	VENG_Anchors* anchors;      // Solver state of VENG_ANCHORED containers
+	VENG_Grid* grid;            // Tracks of VENG_GRID containers
+	VENG_Hits* hits;            // Hover lookup, NULL until the childs are hovered
 } VENG_Childs;
 
+typedef enum VENG_LayoutState // Internal usage.
+{
+	VENG_LAYOUT_CLEAN = 0,
+	VENG_LAYOUT_QUEUED, // Affected by the update being committed
+	VENG_LAYOUT_DONE
+} VENG_LayoutState;
+
+typedef struct VENG_Measure // Internal usage.
+{
+	int drawing_w, drawing_h; // Inputs of the last measure
+	float w, h;
+	bool stretch_size;
+	float size_w, size_h;     // Measured size in px, rounded by the arrange pass
+} VENG_Measure;
+
 typedef struct VENG_Screen
 {
 	VENG_ParentType type;
 
 	char* title;
 	SDL_Surface* icon;
+	SDL_Window* window; // Set by VENG_BindScreen, NULL = the main window
 	
 	VENG_Layer** layers;
 	size_t layers_size;
 	size_t layers_count;
+
+	// Kept while the screen is hidden
+	Uint32 generation;          // Bumped when a layer is added (see VENG_GetScreenGeneration)
+	int prepared_w, prepared_h; // Logical size of the last full layout, 0 = never laid out
+	Uint32 prepared_generation; // Screen generation right after that layout
+	VENG_Prewarm* prewarm;      // Snapshot painted by VENG_PrewarmScreen
+
+	VENG_Shortcuts* shortcuts; // Tried after every layer (see VENG_AddShortcut)
 } VENG_Screen;
 
 typedef struct VENG_Layer
 {
 	VENG_ParentType type;
+	VENG_LayerMode mode;
 
 	VENG_Layout layout;
 	VENG_Childs childs;
 
 	VENG_Listeners* listeners;
+	VENG_Shortcuts* shortcuts; // Tried before its listeners
+	VENG_Focus* focus;         // Focus navigation graph, NULL until used
+	VENG_Element* hovered; // Deepest element under the cursor
+
+	Uint8 layout_state; // VENG_LayoutState
+	Uint32 generation;  // Bumped when its layout or look may have changed
+
+	Uint64 key;     // Set by the reconciler (see VENG_ReconcileScreen)
+	Uint32 version;
 } VENG_Layer;
 
 typedef struct VENG_Element
@@ -127,12 +217,79 @@ typedef struct VENG_Element
 	
 	bool stretch_size;
 	bool visible;
+	bool focusable; // See VENG_SetElementFocusable
 
 	bool dirty;
 	VENG_Layout layout;
 	VENG_Childs childs;
+	VENG_Measure measure; // Size in its parent, reused until the inputs change
+
+	void* parent; // Layer or element that holds it
+	size_t slot;  // Index inside the parent's sub_elements
+
+	VENG_PaintCallback paint;
+	VENG_HoverCallback hover;
+	bool hovered;
+
+	VENG_Scroll* scroll; // NULL unless it's a scroll container
+	VENG_Anchor* anchor; // Constraints, NULL until one is added or the parent is anchored
+	VENG_Lazy* lazy;     // Builder, NULL unless its sub-elements are built lazily
+	size_t shortcuts;    // Bindings given to it, destroying elements without any skips the tables
+	size_t listeners;    // Listeners created for it, the same for the listener tables
+	size_t queued;       // Queued updates that refer to it, the same for the update lists
+	bool adding;         // Queued to be added to a container
+	size_t focus_slot;   // 1 + its node in the layer's focus graph, 0 without one
+	bool focus_moved;    // Laid out or scrolled since the focus graph last checked its sub-elements
+
+	Uint8 layout_state; // VENG_LayoutState
+	size_t table_slot;  // Index inside the elements table
+
+	Uint64 key;     // Set by the reconciler (see VENG_ReconcileLayer)
+	Uint32 version;
 } VENG_Element;
 
+typedef enum VENG_MemoryCategory
+{
+	VENG_MEMORY_SCREENS,
+	VENG_MEMORY_LAYERS,
+	VENG_MEMORY_ELEMENTS,
+	VENG_MEMORY_CHILDS,    // sub_elements and layers arrays
+	VENG_MEMORY_LISTENERS, // listener tables and listeners
+	VENG_MEMORY_TEXTURES,  // texture caches and render buffers
+	VENG_MEMORY_DIAGNOSTICS, // tracing buffers
+	VENG_MEMORY_CATEGORIES
+} VENG_MemoryCategory;
+
+typedef struct VENG_MemoryUsage
+{
+	size_t bytes;       // Currently allocated
+	size_t objects;     // Currently allocated objects (structs, arrays and tables)
+	size_t peak_bytes;  // High-water mark of bytes (only tracked globally)
+	size_t slack_bytes; // Allocated but unused capacity (empty slots)
+} VENG_MemoryUsage;
+
+typedef struct VENG_MemoryStats
+{
+	VENG_MemoryUsage categories[VENG_MEMORY_CATEGORIES];
+	size_t total_bytes;
+	size_t peak_total_bytes;
+	size_t total_slack_bytes;
+} VENG_MemoryStats;
+
+// Allocator hooks: alloc and realloc return NULL on failure, VENG reports it through return codes.
+// VENG clears every block itself, so the callbacks don't need to return zeroed memory.
+typedef void* (*VENG_AllocFunction)(size_t size, size_t alignment, void* context);
+typedef void* (*VENG_ReallocFunction)(void* ptr, size_t old_size, size_t new_size, size_t alignment, void* context);
+typedef void (*VENG_FreeFunction)(void* ptr, size_t size, void* context);
+
+typedef struct VENG_Allocator
+{
+	VENG_AllocFunction alloc;
+	VENG_ReallocFunction realloc;
+	VENG_FreeFunction free;
+	void* context;
+} VENG_Allocator;
+
 // Start and finish
 int VENG_Init(VENG_Driver driver);
 
@@ -149,6 +306,13 @@ VENG_Layout VENG_CreateLayout(VENG_Arrangement arrangement, VENG_Align align_hor
 
 VENG_Driver VENG_CreateDriver(SDL_Window* window, SDL_Renderer* renderer);
 
+// Destroy
+int VENG_DestroyElement(VENG_Element* element); // Detaches it from its parent, frees it with its sub-elements and listeners and lays the parent out again
+
+void VENG_DestroyChilds(void* container); // Internal usage. Without laying the container out again
+
+int VENG_DestroyLayer(VENG_Layer* layer); // Takes it off every screen and frees it with its elements and listener table
+
 // Add
 int VENG_AddLayerToScreen(VENG_Layer* layer, VENG_Screen* screen);
 
@@ -156,6 +320,25 @@ int VENG_AddElementToLayer(VENG_Element* element, VENG_Layer* layer);
 
 int VENG_AddSubElementToElement(VENG_Element* sub_element, VENG_Element* element);
 
+// Update
+// Adds and Set calls between these are validated and queued, then applied with one layout
+// of every affected container by the outermost VENG_EndUpdate. Brackets can be nested.
+int VENG_BeginUpdate();
+
+int VENG_EndUpdate();
+
+bool VENG_IsUpdating();
+
+int VENG_SetElementSize(VENG_Element* element, float w, float h); // Lays out the parent right away outside a bracket
+
+int VENG_SetElementVisible(VENG_Element* element, bool visible);
+
+int VENG_SetElementLayout(VENG_Element* element, VENG_Layout layout);
+
+int VENG_SetLayerLayout(VENG_Layer* layer, VENG_Layout layout);
+
+int VENG_SetChilds(void* container, VENG_Element** childs, size_t count); // Internal usage.
+
 // Prepare
 int VENG_PrepareScreen(VENG_Screen* screen);
 
@@ -163,14 +346,30 @@ int VENG_PrepareLayer(VENG_Layer* layer);
 
 void VENG_PrepareElements(void* parent_container, SDL_Rect drawing_rect);
 
+SDL_Point VENG_GetElementSize(VENG_Element* element, SDL_Rect drawing_rect); // Internal usage. Cached in element->measure
+
 // Drawing
+void VENG_Present(); // Presents the frame, use it instead of SDL_RenderPresent to let VENG know a frame ended
+
 SDL_Rect VENG_StartDrawing(VENG_Element* element);
 
 void VENG_StopDrawing(SDL_Rect* target);
 
+int VENG_SetPaintCallback(VENG_Element* element, VENG_PaintCallback paint);
+
+int VENG_DrawScreen(VENG_Screen* screen); // Paints every layer that isn't covered by an opaque one
+
+int VENG_DrawLayer(VENG_Layer* layer);
+
+void VENG_DrawElement(VENG_Element* element); // Internal usage.
+
+void VENG_DrawRegion(VENG_Element* element, SDL_Rect region); // Internal usage.
+
 // Set
 int VENG_SetDriver(VENG_Driver driver);
 
+int VENG_SetLayerMode(VENG_Layer* layer, VENG_LayerMode mode);
+
 int VENG_SetScreen(VENG_Screen* screen);
 
 // Get
@@ -180,20 +379,74 @@ SDL_Rect* VENG_GetElementRectPtr(VENG_Element* element);
 
 VENG_Screen* VENG_GetScreen();
 
-VENG_Driver VENG_GetDriver();
+VENG_Driver VENG_GetDriver(); // Driver of the current window
+
+size_t VENG_GetLowestVisibleLayer(VENG_Screen* screen); // Lowest layer not covered by an opaque layer
+
+size_t VENG_GetLowestListeningLayer(VENG_Screen* screen); // Lowest layer not covered by a modal or opaque layer
+
+// Windows
+// Every screen is shown in a window, the main one unless bound to another. Painting or
+// showing a screen makes its window the current one, which VENG_GetDriver, VENG_GetScreen
+// and VENG_Present then refer to. Listening, preparing and prewarming a screen use its
+// window and give the current one back. Fonts, glyphs and laid-out
+// text are shared by every window, only the glyph atlas textures are per renderer.
+// Render scaling, the software rasterizer and streaming only apply to the main window.
+int VENG_BindScreen(VENG_Screen* screen, VENG_Driver driver); // Empty driver = the main window
+
+int VENG_RemoveWindow(SDL_Window* window); // Call it before destroying the window, its screens go back to the main one
+
+VENG_Screen* VENG_GetEventScreen(SDL_Event* event); // Screen shown in the window the event went to (the current one without a window), NULL if that window isn't VENG's
+
+bool VENG_UseScreenWindow(VENG_Screen* screen); // Internal usage. Makes its window the current one
+
+bool VENG_IsEventForScreen(SDL_Event* event, VENG_Screen* screen); // Internal usage.
+
+bool VENG_IsMainWindow(); // Internal usage.
+
+size_t VENG_GetWindowSlot(); // Internal usage. Of the current window, in [0, VENG_MAX_WINDOWS)
+
+void VENG_UseWindowSlot(size_t slot); // Internal usage. Makes it the current window again
+
+void VENG_AdoptEvent(SDL_Event* event, VENG_Screen* screen); // Internal usage. Moves a replayed event to the screen's window and to now
 
 // Optimization
+bool VENG_IsScreenPrepared(VENG_Screen* screen); // Laid out for the current size and unchanged since, VENG_SetScreen won't lay it out again
+
+void VENG_TouchContainer(void* container); // Internal usage. Bumps the generation of the layer holding it
+
+Uint32 VENG_GetScreenGeneration(VENG_Screen* screen); // Internal usage.
+
+void VENG_SetScreenPrepared(VENG_Screen* screen); // Internal usage.
+
+// Memory
+int VENG_SetAllocator(VENG_Allocator allocator); // Must be called before VENG_Init, {0} restores the default one.
+
+int VENG_GetMemoryStats(VENG_MemoryStats* stats);
+
+int VENG_GetScreenMemoryStats(VENG_Screen* screen, VENG_MemoryStats* stats);
+
+int VENG_GetLayerMemoryStats(VENG_Layer* layer, VENG_MemoryStats* stats);
+
+void VENG_TrackMemory(VENG_MemoryCategory category, long bytes, long objects); // Internal usage.
+
+void* VENG_Alloc(VENG_MemoryCategory category, size_t count, size_t size); // Internal usage.
+
+void* VENG_Realloc(VENG_MemoryCategory category, void* ptr, size_t old_count, size_t new_count, size_t size); // Internal usage.
+
+void VENG_Free(VENG_MemoryCategory category, void* ptr, size_t count, size_t size); // Internal usage.
 
 // Debug
 bool VENG_HasStarted();
 void VENG_PrintInternalHierarchy();
 int VENG_PrintScreenHierarchy(VENG_Screen* screen);
+void VENG_PrintMemoryStats(VENG_MemoryStats* stats);
 
 /*==========================================================================*\
  *                    VENG_listeners.c - Input management 
 \*==========================================================================*/
 
-//typedef void (*VENG_ListenerCallback)(VENG_Element* element, SDL_Event* event);
+//typedef int (*VENG_ListenerCallback)(VENG_Element* element, SDL_Event* event); // Returns a VENG_EventStatus.
 //typedef int (*VENG_ListenerCondition)(VENG_Element* element, SDL_Event* event); // If function returns 0, VENG will call the callback.
 
 // Main
@@ -217,9 +470,533 @@ int VENG_ListenLayer(SDL_Event* event, VENG_Layer* layer);
 int VENG_AddListenerToLayer(VENG_Listener* listener, VENG_Layer* layer);
 VENG_Listener* VENG_CreateListener(SDL_EventType trigger, VENG_ListenerCallback callback, VENG_ListenerCondition condition, VENG_Element* element);
 
+// Hover
+int VENG_SetHoverCallback(VENG_Element* element, VENG_HoverCallback callback); // Enter/leave/move, tracked by VENG on SDL_MOUSEMOTION
+VENG_Element* VENG_GetHoveredElement(VENG_Layer* layer);
+
+// Memory
+void VENG_ForgetElement(VENG_Element* element); // Internal usage. Drops the listeners and hover of it and its sub-elements
+void VENG_InvalidateHits(VENG_Childs* childs); // Internal usage. The childs were laid out again
+void VENG_FreeHits(VENG_Childs* childs); // Internal usage.
+size_t VENG_GetListenersSlack(); // Internal usage.
+void VENG_FreeLayerListeners(VENG_Layer* layer); // Internal usage. Frees the listener table of a destroyed layer
+void VENG_DestroyListeners(); // Internal usage.
+
 // Debug
 int VENG_PrintListenersInternalHierarchy();
 int VENG_PrintLayerListeners(VENG_Layer* layer);
 
+/*==========================================================================*\
+ *                VENG_record.c - Event recording and replay
+\*==========================================================================*/
+
+typedef enum VENG_ReplaySpeed
+{
+	VENG_REPLAY_ORIGINAL, // Waits between events as they were recorded
+	VENG_REPLAY_MAXIMUM   // Feeds events back to back
+} VENG_ReplaySpeed;
+
+typedef struct VENG_ReplayStats
+{
+	size_t events;
+	size_t resizes;
+	Uint32 recorded_ms;  // Duration of the recorded session
+	Uint64 total_ns;     // Wall time of the replay
+	Uint64 dispatch_ns;  // Time spent in VENG_ListenScreen and the replay callback
+	Uint64 max_event_ns; // Slowest event
+} VENG_ReplayStats;
+
+typedef void (*VENG_ReplayCallback)(VENG_Screen* screen, SDL_Event* event); // Called after each event is dispatched (layout, paint...)
+
+// Record
+int VENG_StartRecording(const char* path); // Every event passed to VENG_ListenScreen is recorded until VENG_StopRecording.
+int VENG_StopRecording();
+bool VENG_IsRecording();
+void VENG_RecordEvent(SDL_Event* event); // Internal usage.
+
+// Replay
+int VENG_ReplayRecording(const char* path, VENG_Screen* screen, VENG_ReplaySpeed speed, VENG_ReplayCallback callback, VENG_ReplayStats* stats);
+
+/*==========================================================================*\
+ *                     VENG_text.c - Cached text rendering
+\*==========================================================================*/
+
+typedef struct VENG_Font VENG_Font; // A font file at a given size, with its own glyph atlas (needs SDL_ttf)
+
+// Fonts
+VENG_Font* VENG_OpenFont(const char* path, int size);
+void VENG_CloseFont(VENG_Font* font);
+
+// Text
+int VENG_DrawText(VENG_Font* font, const char* text, int x, int y, int wrap_width, SDL_Color color); // wrap_width <= 0 doesn't wrap
+int VENG_MeasureText(VENG_Font* font, const char* text, int wrap_width, int* w, int* h);
+
+// Cache
+int VENG_SetTextCacheBudget(size_t bytes); // Laid-out lines are evicted in LRU order past this budget (4 MiB by default)
+void VENG_ClearTextCache();
+void VENG_ForgetWindowText(size_t window); // Internal usage. Destroys the atlases of a removed window
+void VENG_DestroyText(); // Internal usage.
+
+/*==========================================================================*\
+ *                   VENG_paint.c - Batched paint primitives
+\*==========================================================================*/
+
+// Primitives are clipped to the rect set by VENG_StartDrawing and batched into as few
+// SDL_RenderGeometry calls as possible. Call VENG_PaintFlush before drawing with the
+// SDL_Render* functions directly, VENG_DrawScreen and VENG_DrawText already do it.
+
+typedef struct VENG_Insets
+{
+	int left, top, right, bottom;
+} VENG_Insets;
+
+// Primitives
+int VENG_PaintFillRect(SDL_Rect rect, SDL_Color color);
+int VENG_PaintBorder(SDL_Rect rect, int thickness, SDL_Color color);
+int VENG_PaintRoundedRect(SDL_Rect rect, int radius, SDL_Color color);
+int VENG_PaintRoundedBorder(SDL_Rect rect, int radius, int thickness, SDL_Color color);
+int VENG_PaintNineSlice(SDL_Texture* texture, SDL_Rect source, VENG_Insets insets, SDL_Rect target, SDL_Color color);
+
+// Batch
+int VENG_PaintFlush();
+size_t VENG_GetPaintDrawCalls(); // SDL_RenderGeometry calls issued so far
+bool VENG_PaintPending(); // Internal usage. Geometry batched and not drawn yet
+void VENG_DestroyPaint(); // Internal usage.
+
+/*==========================================================================*\
+ *                  VENG_raster.c - Software rasterizer
+\*==========================================================================*/
+
+// Paint primitives and text drawn to the frame are rasterized by worker threads into
+// 64x64 tiles of a surface, uploaded and copied over the frame by VENG_PaintFlush. SDL_Render*
+// calls, scroll caches and snapshots still go through SDL, after a flush they keep their order.
+// Textures are only rasterized with a CPU copy (VENG_SetRasterSource); fonts opened while
+// it's enabled make their own.
+
+// Raster
+int VENG_SetSoftwareRaster(int threads); // 0 disables it, < 0 uses a thread per CPU
+bool VENG_IsRasterizing();
+int VENG_SetRasterSource(SDL_Texture* texture, SDL_Surface* source); // ARGB8888 copy of the texture pixels, NULL removes it
+
+// Internal usage.
+bool VENG_RasterPolygon(SDL_Texture* texture, SDL_Vertex* polygon, int n); // false if SDL has to draw it
+bool VENG_RasterQuads(SDL_Texture* texture, SDL_Vertex* quads, size_t count); // TL, TR, BL, BR each, all of them or none
+void VENG_ResolveRaster(); // Before anything SDL draws on the frame and VENG_ResolveScale
+void VENG_DestroyRaster();
+
+/*==========================================================================*\
+ *                    VENG_prewarm.c - Screen prewarming
+\*==========================================================================*/
+
+// Lays out and paints a hidden screen into a snapshot a few steps at a time (call it once
+// per frame while idle, with a budget in ms). VENG_SetScreen then shows the snapshot on the
+// first VENG_DrawScreen, so switching screens costs a single texture copy.
+
+int VENG_PrewarmScreen(VENG_Screen* screen, Uint32 budget_ms, bool* done);
+
+// Internal usage.
+void VENG_ShowSnapshot(VENG_Screen* screen);
+bool VENG_DrawSnapshot(VENG_Screen* screen);
+void VENG_FreePrewarm(VENG_Screen* screen);
+
+/*==========================================================================*\
+ *                     VENG_scroll.c - Scroll containers
+\*==========================================================================*/
+
+// A scroll container lays its childs out in a content rect bigger than itself and keeps
+// them painted in a cached texture. Scrolling copies the cached pixels and only paints the
+// exposed strips, so paint callbacks of the other childs aren't called again unless they
+// are invalidated.
+
+// Scroll
+int VENG_SetElementScroll(VENG_Element* element, float content_w, float content_h); // Content size in element sizes (>= 1), 0 and 0 turns it back into a regular element
+int VENG_ScrollElement(VENG_Element* element, int dx, int dy); // Clamped to the content
+SDL_Point VENG_GetElementScroll(VENG_Element* element);
+int VENG_InvalidateElement(VENG_Element* element); // Paints the element again in the caches holding it
+
+// Internal usage.
+SDL_Rect VENG_PrepareScroll(VENG_Element* element); // Content rect for VENG_PrepareElements
+int VENG_DrawScroll(VENG_Element* element);
+void VENG_FreeScroll(VENG_Element* element);
+
+/*==========================================================================*\
+ *                     VENG_anchor.c - Anchored layout
+\*==========================================================================*/
+
+// In a VENG_ANCHORED container, each child attribute can be tied to an attribute of a
+// sibling or of the container: attribute = source attribute * multiplier + constant.
+// Per axis, a child needs its size or two of its edges/center (otherwise the size comes
+// from w and h like in the other arrangements) and an edge or the center (otherwise it
+// sticks to the container's left/top). Only what changed is solved again.
+
+typedef enum VENG_Attribute
+{
+	VENG_ATTRIBUTE_LEFT,
+	VENG_ATTRIBUTE_TOP,
+	VENG_ATTRIBUTE_RIGHT,
+	VENG_ATTRIBUTE_BOTTOM,
+	VENG_ATTRIBUTE_WIDTH,
+	VENG_ATTRIBUTE_HEIGHT,
+	VENG_ATTRIBUTE_CENTER_X,
+	VENG_ATTRIBUTE_CENTER_Y,
+	VENG_ATTRIBUTES
+} VENG_Attribute;
+
+// Constraints
+int VENG_AddConstraint(VENG_Element* element, VENG_Attribute attribute, VENG_Element* source, VENG_Attribute source_attribute, float multiplier, int constant); // source NULL = the container, replaces the attribute's constraint
+int VENG_SetConstraintConstant(VENG_Element* element, VENG_Attribute attribute, int constant);
+int VENG_RemoveConstraint(VENG_Element* element, VENG_Attribute attribute);
+
+// Internal usage.
+int VENG_SolveAnchors(VENG_Childs* childs, SDL_Rect drawing_rect);
+void VENG_DetachAnchor(VENG_Element* element);
+void VENG_FreeAnchor(VENG_Element* element);
+void VENG_FreeAnchors(VENG_Childs* childs);
+
+/*==========================================================================*\
+ *                       VENG_grid.c - Grid layout
+\*==========================================================================*/
+
+// A VENG_GRID container lays its visible childs out in cells, row by row, in one pass.
+// Childs are sized against their cell, except along auto tracks where they keep the size
+// they would have in the container (the track takes the largest one). Rows past the ones
+// given repeat the last row track, no rows at all makes them auto.
+
+typedef enum VENG_TrackType
+{
+	VENG_TRACK_FIXED,    // value px
+	VENG_TRACK_FRACTION, // value shares of the space fixed and auto tracks leave
+	VENG_TRACK_AUTO      // Largest child in it, value is ignored
+} VENG_TrackType;
+
+typedef struct VENG_Track
+{
+	VENG_TrackType type;
+	float value;
+} VENG_Track;
+
+// Grid
+int VENG_SetGridTracks(void* container, const VENG_Track* columns, size_t columns_count, const VENG_Track* rows, size_t rows_count); // A layer or an element, the tracks are copied
+
+// Internal usage.
+int VENG_SolveGrid(VENG_Childs* childs, VENG_Layout* layout, SDL_Rect drawing_rect);
+size_t VENG_GridCellAt(VENG_Childs* childs, SDL_Point point); // Cell of the last solve under the point, (size_t)-1 outside the tracks
+void VENG_FreeGrid(VENG_Childs* childs);
+
+/*==========================================================================*\
+ *                     VENG_lazy.c - Lazily built subtrees
+\*==========================================================================*/
+
+// The sub-elements of a lazy element are created by its builder the first time it's laid
+// out visible. Hidden for release_ms (checked by VENG_Present), they are destroyed again
+// and built anew the next time it's shown, so only what was shown costs memory.
+
+typedef int (*VENG_BuildCallback)(VENG_Element* element); // Adds the sub-elements, returns 0 on success
+
+// Lazy
+int VENG_SetElementBuilder(VENG_Element* element, VENG_BuildCallback build, Uint32 release_ms); // release_ms 0 keeps them once built, NULL build makes it a regular element
+bool VENG_IsElementBuilt(VENG_Element* element);
+
+// Internal usage.
+void VENG_BuildSubtree(VENG_Element* element); // Called by VENG_PrepareElements before laying it out
+void VENG_HideSubtree(VENG_Element* element);  // Called by VENG_PrepareElements while it's hidden
+void VENG_CollectSubtrees();
+void VENG_FreeLazy(VENG_Element* element);
+void VENG_DestroyLazy();
+
+/*==========================================================================*\
+ *                VENG_scale.c - Internal resolution scaling
+\*==========================================================================*/
+
+// Below a scale of 1, frames are drawn into an offscreen target of (window size * scale)
+// pixels that VENG_Present stretches over the window. Layers are laid out in that logical
+// size and pointer events given to VENG_ListenScreen are mapped into it.
+
+// Scale
+int VENG_SetRenderScale(float scale); // (0, 1], 1 draws straight into the window
+int VENG_SetScaleBudget(float frame_ms, float lowest_scale); // Adapts the scale (up to the one set) to keep frames under frame_ms, 0 disables it
+float VENG_GetRenderScale();
+int VENG_GetLogicalSize(int* w, int* h); // Size layers are laid out in
+
+// Internal usage.
+void VENG_StartScaleFrame(); // By layouts and paints, the first one after a present starts the measured frame work
+void VENG_ResolveScale(); // Before SDL_RenderPresent
+void VENG_AdaptScale();   // After SDL_RenderPresent
+bool VENG_ScaleEvent(SDL_Event* event, SDL_Event* scaled);
+SDL_Texture* VENG_GetScaleTarget(); // NULL while frames are drawn straight into the window
+void VENG_DestroyScale();
+
+/*==========================================================================*\
+ *                      VENG_gesture.c - Touch gestures
+\*==========================================================================*/
+
+// Finger events given to VENG_ListenScreen are queued from the first VENG_ProcessGestures
+// call on, and VENG_ProcessGestures (call it once per frame, before the layout and paint)
+// turns them into gestures. Each gesture is
+// given to VENG_ListenScreen as an event of type VENG_GetGestureEventType(), so listeners
+// catch it like any other event and read it with VENG_GetGesture. Positions are in the
+// logical size layers are laid out in.
+
+typedef enum VENG_GestureType
+{
+	VENG_GESTURE_TAP,
+	VENG_GESTURE_LONG_PRESS,  // Once, while the finger is still down
+	VENG_GESTURE_DRAG_BEGIN,  // The finger left the slop
+	VENG_GESTURE_DRAG,        // At most once per finger and frame
+	VENG_GESTURE_DRAG_END,
+	VENG_GESTURE_SWIPE        // After VENG_GESTURE_DRAG_END if the finger was released fast enough
+} VENG_GestureType;
+
+typedef struct VENG_Gesture
+{
+	VENG_GestureType type;
+	SDL_FingerID finger;
+	SDL_Point position;
+	SDL_Point start;     // Where the finger went down
+	SDL_Point delta;     // Since the last gesture of that finger
+	SDL_FPoint velocity; // Px per second
+	SDL_Point predicted; // Where the finger should be prediction_ms later
+	Uint32 duration;     // Ms since the finger went down
+} VENG_Gesture;
+
+typedef struct VENG_GestureConfig
+{
+	int slop;             // Px a finger can move and still tap or long press (10)
+	Uint32 tap_ms;        // Longest tap (250)
+	Uint32 long_press_ms; // (500)
+	float swipe_velocity; // Px per second (800)
+	Uint32 prediction_ms; // How far ahead positions are predicted, about the display latency (16)
+} VENG_GestureConfig;
+
+// Gestures
+Uint32 VENG_GetGestureEventType(); // Trigger for VENG_CreateListener, registered on the first call
+const VENG_Gesture* VENG_GetGesture(SDL_Event* event); // NULL if it isn't a gesture, only valid during the callback
+int VENG_ProcessGestures(VENG_Screen* screen);
+int VENG_PredictFinger(SDL_FingerID finger, Uint32 ahead_ms, SDL_Point* point); // For fingers still down
+
+// Config
+int VENG_SetGestureConfig(VENG_GestureConfig config);
+VENG_GestureConfig VENG_GetGestureConfig();
+
+// Internal usage.
+void VENG_CollectTouch(SDL_Event* event);
+void VENG_DestroyGestures();
+
+/*==========================================================================*\
+ *                 VENG_latency.c - Input-to-present latency
+\*==========================================================================*/
+
+// An event given to VENG_ListenScreen whose callbacks change or invalidate anything is
+// followed until the VENG_Present that shows it. Its latency, from SDL_Event.timestamp to
+// the end of SDL_RenderPresent, goes into a histogram of its event type, along with the
+// stages it went through.
+
+typedef enum VENG_LatencyStage
+{
+	VENG_LATENCY_TOTAL,    // Event timestamp to presented
+	VENG_LATENCY_DISPATCH, // Listener callbacks, without the layouts they run
+	VENG_LATENCY_LAYOUT,   // Layouts between the dispatch and the present
+	VENG_LATENCY_PAINT,    // VENG_DrawScreen and VENG_DrawLayer between the dispatch and the present
+	VENG_LATENCY_PRESENT,  // VENG_Present (flush and SDL_RenderPresent, vsync included)
+	VENG_LATENCY_STAGES
+} VENG_LatencyStage;
+
+typedef struct VENG_LatencyStats
+{
+	Uint64 count;
+	Uint32 p50_us, p99_us; // Within 25%
+	Uint32 max_us;
+} VENG_LatencyStats;
+
+// Latency
+int VENG_SetLatencyTracking(bool enabled); // Off by default
+bool VENG_IsTrackingLatency();
+int VENG_GetLatencyStats(Uint32 event_type, VENG_LatencyStage stage, VENG_LatencyStats* stats); // All 0 if no such event was presented
+void VENG_ResetLatencyStats();
+int VENG_PrintLatencyStats();
+
+// Internal usage.
+void VENG_LatencyDispatch(SDL_Event* event);
+void VENG_LatencyDispatched();
+void VENG_LatencyEffect(); // Called by VENG_TouchContainer
+Uint64 VENG_LatencyBegin(); // 0 while not tracking
+void VENG_LatencyEnd(VENG_LatencyStage stage, Uint64 start);
+void VENG_LatencyPresent(Uint64 present_start);
+void VENG_DestroyLatency();
+
+/*==========================================================================*\
+ *                   VENG_stream.c - Tile-diffed frame streaming
+\*==========================================================================*/
+
+// Every VENG_Present, the frame (at the logical size) is cut into tiles and only the tiles
+// that changed since the last one are given to the sink. With trust_damage, only the tiles
+// touched by layouts, VENG_InvalidateElement and VENG_DestroyElement are read back and
+// hashed: paint callbacks that animate must invalidate their element.
+
+typedef struct VENG_StreamSink
+{
+	int (*frame)(void* context, int w, int h, Uint32 tiles); // Before the changed tiles of a frame, returns 1 on error
+	int (*tile)(void* context, SDL_Rect rect, const Uint32* pixels, int pitch); // ARGB8888, pitch in bytes, returns 1 on error
+	void (*close)(void* context); // Can be NULL, called when the stream stops
+	void* context;
+} VENG_StreamSink;
+
+typedef struct VENG_StreamStats
+{
+	Uint64 frames;
+	Uint64 tiles_read;   // Read back from the renderer
+	Uint64 tiles_hashed; // Damaged ones, or all of them without trust_damage
+	Uint64 tiles_sent;
+	Uint64 bytes_sent;   // Pixels only
+} VENG_StreamStats;
+
+// Socket sink wire format (native endianness): a frame header, then per tile a tile
+// header followed by w * h ARGB8888 pixels.
+#define VENG_STREAM_MAGIC 0x474E4556 // "VENG"
+
+typedef struct VENG_StreamFrameHeader
+{
+	Uint32 magic;
+	Sint32 w, h;
+	Uint32 tiles;
+} VENG_StreamFrameHeader;
+
+typedef struct VENG_StreamTileHeader
+{
+	Sint32 x, y, w, h;
+} VENG_StreamTileHeader;
+
+// Stream
+int VENG_StartStream(VENG_StreamSink sink, int tile_size, bool trust_damage);
+int VENG_StopStream(); // Closes the sink
+bool VENG_IsStreaming();
+int VENG_GetStreamStats(VENG_StreamStats* stats);
+
+// Sinks
+int VENG_OpenSocketSink(const char* path, VENG_StreamSink* sink); // Connects to a UNIX socket listening at path
+
+// Internal usage.
+void VENG_StreamDamage(const SDL_Rect* rect); // NULL damages the whole frame
+void VENG_StreamFrame(); // Before VENG_ResolveScale
+void VENG_DestroyStream();
+
+/*==========================================================================*\
+ *                   VENG_shortcut.c - Keyboard shortcuts
+\*==========================================================================*/
+
+// Bindings of a key and its modifiers to a callback, looked up in a hash table on every
+// SDL_KEYDOWN (one lookup per layer, whatever the number of bindings). Layers are tried
+// from the top one down, each before its own listeners, then the screen. A callback that
+// returns VENG_EVENT_CONSUMED stops the event there.
+// Modifiers are any of KMOD_CTRL, KMOD_SHIFT, KMOD_ALT and KMOD_GUI: left and right are
+// the same key and lock keys are ignored.
+
+// Shortcuts
+int VENG_AddShortcut(void* owner, SDL_Keycode key, Uint16 mods, VENG_ListenerCallback callback, VENG_Element* element); // Owner is a screen or a layer, replaces the binding of the same keys. Element is given to the callback and can be NULL
+int VENG_RemoveShortcut(void* owner, SDL_Keycode key, Uint16 mods);
+
+// Internal usage.
+bool VENG_RunShortcut(VENG_Shortcuts* shortcuts, SDL_Event* event); // Returns true if the callback consumed the event
+void VENG_ForgetShortcuts(VENG_Element* element); // Drops the bindings of it and its sub-elements
+void VENG_FreeShortcuts(void* owner);
+
+/*==========================================================================*\
+ *                   VENG_focus.c - Focus navigation
+\*==========================================================================*/
+
+// Every layer can have one focused element among its visible focusable ones, moved with
+// arrow keys or a remote. The nearest element in every direction is kept in a graph built
+// from the laid-out rects and refreshed when the layer's layout changes, so a move is a
+// lookup. Moves are up to the application, e.g. from shortcuts on the arrow keys.
+
+typedef enum VENG_FocusDirection
+{
+	VENG_FOCUS_LEFT,
+	VENG_FOCUS_UP,
+	VENG_FOCUS_RIGHT,
+	VENG_FOCUS_DOWN
+} VENG_FocusDirection;
+
+typedef void (*VENG_FocusCallback)(VENG_Element* previous, VENG_Element* focused); // Either can be NULL
+
+// Focus
+int VENG_SetElementFocusable(VENG_Element* element, bool focusable);
+int VENG_SetFocus(VENG_Layer* layer, VENG_Element* element); // NULL clears it
+VENG_Element* VENG_GetFocus(VENG_Layer* layer);
+int VENG_MoveFocus(VENG_Layer* layer, VENG_FocusDirection direction); // Focuses the first one if none is, stays if there's nothing that way
+int VENG_SetFocusCallback(VENG_Layer* layer, VENG_FocusCallback callback); // Called on every focus change, focused elements getting hidden included (not destroyed ones)
+
+// Internal usage.
+void VENG_InvalidateFocus(void* container); // Its sub-elements may have moved, they're checked on the next use
+void VENG_ForgetFocus(VENG_Element* element); // Unfocuses it and its sub-elements
+void VENG_FreeFocus(VENG_Layer* layer);
+
+/*==========================================================================*\
+ *                   VENG_reconcile.c - Tree reconciliation
+\*==========================================================================*/
+
+// The application describes the whole tree every time and VENG turns the current one into
+// it: children are matched by key among their siblings, only the properties that differ
+// are set, and every affected container is laid out once. A node keeping the same non-0
+// version is trusted not to have changed, its subtree is skipped.
+
+typedef struct VENG_Node
+{
+	Uint64 key;     // Not 0, unique among its siblings
+	Uint32 version; // 0 = always compared
+	float w, h;
+	bool stretch_size;
+	bool visible;
+	bool focusable;
+	VENG_Layout layout;
+	VENG_PaintCallback paint;
+	size_t max_sub_elements; // Capacity when it's created
+	const struct VENG_Node* childs;
+	size_t childs_count;
+} VENG_Node;
+
+typedef struct VENG_LayerNode
+{
+	Uint64 key;
+	Uint32 version;
+	VENG_Layout layout;
+	VENG_LayerMode mode;
+	size_t max_elements;
+	const VENG_Node* childs;
+	size_t childs_count;
+} VENG_LayerNode;
+
+typedef struct VENG_ReconcileStats
+{
+	size_t created;
+	size_t destroyed;
+	size_t changed; // Kept nodes with at least one property set
+	size_t skipped; // Same version, subtree included
+} VENG_ReconcileStats;
+
+// Reconcile
+int VENG_ReconcileScreen(VENG_Screen* screen, const VENG_LayerNode* layers, size_t count, VENG_ReconcileStats* stats); // Layers left out are destroyed, stats can be NULL
+int VENG_ReconcileLayer(VENG_Layer* layer, const VENG_Node* childs, size_t count, VENG_ReconcileStats* stats);
+
+/*==========================================================================*\
+ *                   VENG_trace.c - Chrome trace-event export
+\*==========================================================================*/
+
+// Records spans for frames (VENG_Present), VENG_PrepareLayer, VENG_PrepareElements of containers
+// holding at least prepare_threshold sub-elements, listener callbacks and element painting
+// (VENG_StartDrawing to VENG_StopDrawing). Open the file in chrome://tracing or Perfetto.
+
+// Session
+int VENG_StartTracing(const char* path, size_t prepare_threshold);
+int VENG_StopTracing();
+bool VENG_IsTracing();
+size_t VENG_GetTracePrepareThreshold(); // Internal usage.
+
+// Spans (name must be a string literal)
+void VENG_TraceBegin(const char* name, const void* object);
+void VENG_TraceEnd();
+void VENG_TraceFrame(); // Internal usage.
+void VENG_DestroyTrace(); // Internal usage.
+
 
 #endif
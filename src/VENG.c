@@ -2,11 +2,10 @@
 #include <stdio.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include <string.h>
+#include <stddef.h>
 #include <math.h>
 
-// Pointer safety
-static void* IS_NULL(void *ptr);
-
 // SDL2 lib
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_image.h>
@@ -15,8 +14,15 @@ static void* IS_NULL(void *ptr);
 
 static bool started = false;
 
-static VENG_Driver driver;
-static VENG_Screen* rendering_screen;
+// Slot 0 is the main window (VENG_Init, VENG_SetDriver), the rest come from VENG_BindScreen
+typedef struct VENG_Window
+{
+	VENG_Driver driver; // window = NULL, free slot
+	VENG_Screen* rendering_screen;
+} VENG_Window;
+
+static VENG_Window windows[VENG_MAX_WINDOWS];
+static size_t current_window = 0; // The one being listened, laid out, painted and presented
 
 #define ALLOCATED_SCREENS_START 1
 static VENG_Screen** screens = NULL;
@@ -33,6 +39,44 @@ static VENG_Element** elements = NULL;
 static size_t elements_slots_size = ALLOCATED_ELEMENTS_START;
 static size_t elements_slots_count = 0;
 
+// Changes queued by VENG_BeginUpdate, applied by VENG_EndUpdate
+typedef enum VENG_UpdateType
+{
+	VENG_UPDATE_ADD,
+	VENG_UPDATE_SIZE,
+	VENG_UPDATE_VISIBLE,
+	VENG_UPDATE_LAYOUT,
+	VENG_UPDATE_ARRANGE // Its sub-elements were set by VENG_SetChilds, only lays it out
+} VENG_UpdateType;
+
+typedef struct VENG_Update
+{
+	VENG_UpdateType type;
+	void* target; // Container for VENG_UPDATE_ADD, VENG_UPDATE_LAYOUT and VENG_UPDATE_ARRANGE, element otherwise
+	VENG_Element* element;
+	float w, h;
+	bool visible;
+	VENG_Layout layout;
+} VENG_Update;
+
+#define ALLOCATED_UPDATES_START 16
+static VENG_Update* updates = NULL;
+static size_t updates_size = 0;
+static size_t updates_count = 0;
+static size_t update_depth = 0;
+static VENG_Update* batch = NULL; // Updates being applied and laid out by the outermost VENG_EndUpdate
+static size_t batch_count = 0;
+
+static VENG_MemoryStats memory_stats;
+
+static VENG_Element* drawing_element = NULL; // Element between VENG_StartDrawing and VENG_StopDrawing while tracing
+static SDL_Rect* drawing_bounds = NULL;       // Region being painted again by VENG_DrawRegion
+
+static void* __DefaultAlloc(size_t size, size_t alignment, void* context);
+static void* __DefaultRealloc(void* ptr, size_t old_size, size_t new_size, size_t alignment, void* context);
+static void __DefaultFree(void* ptr, size_t size, void* context);
+static VENG_Allocator allocator = {__DefaultAlloc, __DefaultRealloc, __DefaultFree, NULL};
+
 /*==========================================================================*\
  *                   			Start and finish
 \*==========================================================================*/
@@ -52,9 +96,15 @@ int VENG_Init(VENG_Driver new_driver)
 	VENG_SetDriver(new_driver);
 	
 	// Start heap
-	screens = IS_NULL(calloc(ALLOCATED_SCREENS_START, sizeof(VENG_Screen*)));
-	layers = IS_NULL(calloc(ALLOCATED_LAYERS_START, sizeof(VENG_Layer*)));
-	elements = IS_NULL(calloc(ALLOCATED_ELEMENTS_START, sizeof(VENG_Element*)));
+	screens = VENG_Alloc(VENG_MEMORY_SCREENS, ALLOCATED_SCREENS_START, sizeof(VENG_Screen*));
+	layers = VENG_Alloc(VENG_MEMORY_LAYERS, ALLOCATED_LAYERS_START, sizeof(VENG_Layer*));
+	elements = VENG_Alloc(VENG_MEMORY_ELEMENTS, ALLOCATED_ELEMENTS_START, sizeof(VENG_Element*));
+	if (screens == NULL || layers == NULL || elements == NULL)
+	{
+		printf("Couldn't allocate VENG heap\n");
+		VENG_Destroy();
+		return 1;
+	}
 
 	return 0;
 }
@@ -62,8 +112,84 @@ int VENG_Init(VENG_Driver new_driver)
 void VENG_Destroy()
 {
 	if (!VENG_HasStarted()) return;
-	driver = (VENG_Driver){NULL, NULL};
-	rendering_screen = NULL;
+	if (VENG_IsRecording()) VENG_StopRecording();
+	current_window = 0; // Scale and raster state belong to the main window
+	VENG_DestroyText();
+	VENG_DestroyPaint();
+	VENG_DestroyRaster();
+	VENG_DestroyTrace();
+	VENG_DestroyLatency();
+	VENG_DestroyStream();
+	VENG_DestroyScale();
+	VENG_DestroyGestures();
+	VENG_DestroyListeners();
+	VENG_Free(VENG_MEMORY_CHILDS, updates, updates_size, sizeof(VENG_Update));
+	updates = NULL;
+	updates_size = 0;
+	updates_count = 0;
+	update_depth = 0;
+	if (screens != NULL)
+	{
+		for (size_t i = 0; i < screen_slots_size; i++)
+		{
+			if (screens[i] != NULL)
+			{
+				VENG_FreePrewarm(screens[i]);
+				VENG_FreeShortcuts(screens[i]);
+				VENG_Free(VENG_MEMORY_CHILDS, screens[i]->layers, screens[i]->layers_size, sizeof(VENG_Layer*));
+				VENG_Free(VENG_MEMORY_SCREENS, screens[i], 1, sizeof(VENG_Screen));
+			}
+		}
+		VENG_Free(VENG_MEMORY_SCREENS, screens, screen_slots_size, sizeof(VENG_Screen*));
+	}
+	if (layers != NULL)
+	{
+		for (size_t i = 0; i < layer_slots_size; i++)
+		{
+			if (layers[i] != NULL)
+			{
+				VENG_FreeShortcuts(layers[i]);
+				VENG_FreeFocus(layers[i]);
+				VENG_FreeAnchors(&layers[i]->childs);
+				VENG_FreeGrid(&layers[i]->childs);
+				VENG_FreeHits(&layers[i]->childs);
+				VENG_Free(VENG_MEMORY_CHILDS, layers[i]->childs.sub_elements, layers[i]->childs.sub_elements_size, sizeof(VENG_Element*));
+				VENG_Free(VENG_MEMORY_LAYERS, layers[i], 1, sizeof(VENG_Layer));
+			}
+		}
+		VENG_Free(VENG_MEMORY_LAYERS, layers, layer_slots_size, sizeof(VENG_Layer*));
+	}
+	if (elements != NULL)
+	{
+		for (size_t i = 0; i < elements_slots_size; i++)
+		{
+			if (elements[i] != NULL)
+			{
+				VENG_FreeScroll(elements[i]);
+				VENG_FreeLazy(elements[i]);
+				VENG_FreeAnchor(elements[i]);
+				VENG_FreeAnchors(&elements[i]->childs);
+				VENG_FreeGrid(&elements[i]->childs);
+				VENG_FreeHits(&elements[i]->childs);
+				VENG_Free(VENG_MEMORY_CHILDS, elements[i]->childs.sub_elements, elements[i]->childs.sub_elements_size, sizeof(VENG_Element*));
+				VENG_Free(VENG_MEMORY_ELEMENTS, elements[i], 1, sizeof(VENG_Element));
+			}
+		}
+		VENG_Free(VENG_MEMORY_ELEMENTS, elements, elements_slots_size, sizeof(VENG_Element*));
+	}
+	VENG_DestroyLazy();
+	screens = NULL;
+	screen_slots_size = ALLOCATED_SCREENS_START;
+	screen_slots_count = 0;
+	layers = NULL;
+	layer_slots_size = ALLOCATED_LAYERS_START;
+	layer_slots_count = 0;
+	elements = NULL;
+	elements_slots_size = ALLOCATED_ELEMENTS_START;
+	elements_slots_count = 0;
+
+	memset(windows, 0, sizeof(windows));
+	current_window = 0;
 	started = false;
 }
 
@@ -90,8 +216,14 @@ VENG_Screen* VENG_CreateScreen(char* title, SDL_Surface* icon, size_t max_layers
 
 	if (screen_slots_count >= screen_slots_size)
 	{
+		VENG_Screen** new_screens = VENG_Realloc(VENG_MEMORY_SCREENS, screens, screen_slots_size, screen_slots_size + ALLOCATED_SCREENS_START, sizeof(VENG_Screen*));
+		if (new_screens == NULL)
+		{
+			printf("Couldn't allocate Screen slots\n");
+			return NULL;
+		}
+		screens = new_screens;
 		screen_slots_size += ALLOCATED_SCREENS_START;
-		screens = (VENG_Screen**)IS_NULL(realloc(screens, screen_slots_size * sizeof(VENG_Screen*)));
 		// As realloc does not clear the new heap, it needs to be manually cleared
 		for (size_t i = screen_slots_size - ALLOCATED_SCREENS_START; i < screen_slots_size; i++)
 		{
@@ -99,16 +231,25 @@ VENG_Screen* VENG_CreateScreen(char* title, SDL_Surface* icon, size_t max_layers
 		}
 	}
 
-	VENG_Screen* return_adress;
+	VENG_Screen* return_adress = NULL;
 	for (size_t i = 0; i < screen_slots_size; i++)
 	{
 		if (screens[i] == NULL)
 		{
-			screens[i] = IS_NULL(calloc(1, sizeof(VENG_Screen)));
+			VENG_Screen* screen = VENG_Alloc(VENG_MEMORY_SCREENS, 1, sizeof(VENG_Screen));
+			VENG_Layer** screen_layers = VENG_Alloc(VENG_MEMORY_CHILDS, max_layers, sizeof(VENG_Layer*));
+			if (screen == NULL || screen_layers == NULL)
+			{
+				printf("Couldn't allocate Screen\n");
+				VENG_Free(VENG_MEMORY_CHILDS, screen_layers, max_layers, sizeof(VENG_Layer*));
+				VENG_Free(VENG_MEMORY_SCREENS, screen, 1, sizeof(VENG_Screen));
+				return NULL;
+			}
+			screens[i] = screen;
 			screens[i]->type = VENG_TYPE_SCREEN;
 			screens[i]->title = title;
 			screens[i]->icon = icon;
-			screens[i]->layers = IS_NULL(calloc(max_layers, sizeof(VENG_Layer*)));
+			screens[i]->layers = screen_layers;
 			screens[i]->layers_size = max_layers;
 			screens[i]->layers_count = 0;
 			return_adress = screens[i];
@@ -135,8 +276,14 @@ VENG_Layer* VENG_CreateLayer(VENG_Layout layout, size_t max_elements)
 
 	if (layer_slots_count >= layer_slots_size)
 	{
+		VENG_Layer** new_layers = VENG_Realloc(VENG_MEMORY_LAYERS, layers, layer_slots_size, layer_slots_size + ALLOCATED_LAYERS_START, sizeof(VENG_Layer*));
+		if (new_layers == NULL)
+		{
+			printf("Couldn't allocate Layer slots\n");
+			return NULL;
+		}
+		layers = new_layers;
 		layer_slots_size += ALLOCATED_LAYERS_START;
-		layers = (VENG_Layer**)IS_NULL(realloc(layers, layer_slots_size * sizeof(VENG_Layer*)));
 		// As realloc does not clear the new heap, it needs to be manually cleared
 		for (size_t i = layer_slots_size - ALLOCATED_LAYERS_START; i < layer_slots_size; i++)
 		{
@@ -144,15 +291,24 @@ VENG_Layer* VENG_CreateLayer(VENG_Layout layout, size_t max_elements)
 		}
 	}
 
-	VENG_Layer* return_adress;
+	VENG_Layer* return_adress = NULL;
 	for (size_t i = 0; i < layer_slots_size; i++)
 	{
 		if (layers[i] == NULL)
 		{
-			layers[i] = (VENG_Layer*)IS_NULL(calloc(1, sizeof(VENG_Layer)));
+			VENG_Layer* layer = VENG_Alloc(VENG_MEMORY_LAYERS, 1, sizeof(VENG_Layer));
+			VENG_Element** sub_elements = VENG_Alloc(VENG_MEMORY_CHILDS, max_elements, sizeof(VENG_Element*));
+			if (layer == NULL || sub_elements == NULL)
+			{
+				printf("Couldn't allocate Layer\n");
+				VENG_Free(VENG_MEMORY_CHILDS, sub_elements, max_elements, sizeof(VENG_Element*));
+				VENG_Free(VENG_MEMORY_LAYERS, layer, 1, sizeof(VENG_Layer));
+				return NULL;
+			}
+			layers[i] = layer;
 			layers[i]->type = VENG_TYPE_LAYER;
 			layers[i]->layout = layout;
-			layers[i]->childs.sub_elements = IS_NULL(calloc(max_elements, sizeof(VENG_Element*)));
+			layers[i]->childs.sub_elements = sub_elements;
 			layers[i]->childs.sub_elements_size = max_elements;
 			layers[i]->childs.sub_elements_count = 0;
 			return_adress = layers[i];
@@ -174,22 +330,41 @@ VENG_Element* VENG_CreateElement(float w, float h, bool stretch_size, bool visib
 	{
 		printf("W and H cannot be negative\n");
 	}
-	else if (elements_slots_count >= elements_slots_size)
+	if (elements_slots_count >= elements_slots_size)
 	{
+		VENG_Element** new_elements = VENG_Realloc(VENG_MEMORY_ELEMENTS, elements, elements_slots_size, elements_slots_size + ALLOCATED_ELEMENTS_START, sizeof(VENG_Element*));
+		if (new_elements == NULL)
+		{
+			printf("Couldn't allocate Element slots\n");
+			return NULL;
+		}
+		elements = new_elements;
 		elements_slots_size += ALLOCATED_ELEMENTS_START;
-		elements = (VENG_Element**)IS_NULL(realloc(elements, elements_slots_size * sizeof(VENG_Element*)));
 		for (size_t i = elements_slots_size - ALLOCATED_ELEMENTS_START; i < elements_slots_size; i++)
 		{
 			elements[i] = NULL;
 		}
 	}
 
-	VENG_Element* return_adress;
+	VENG_Element* return_adress = NULL;
 	for (size_t i = 0; i < elements_slots_size; i++)
 	{
 		if (elements[i] == NULL)
 		{
-			elements[i] = IS_NULL(calloc(1, sizeof(VENG_Element)));
+			VENG_Element* element = VENG_Alloc(VENG_MEMORY_ELEMENTS, 1, sizeof(VENG_Element));
+			VENG_Element** sub_elements = NULL;
+			if (max_sub_elements != 0)
+			{
+				sub_elements = VENG_Alloc(VENG_MEMORY_CHILDS, max_sub_elements, sizeof(VENG_Element*));
+			}
+			if (element == NULL || (max_sub_elements != 0 && sub_elements == NULL))
+			{
+				printf("Couldn't allocate Element\n");
+				VENG_Free(VENG_MEMORY_CHILDS, sub_elements, max_sub_elements, sizeof(VENG_Element*));
+				VENG_Free(VENG_MEMORY_ELEMENTS, element, 1, sizeof(VENG_Element));
+				return NULL;
+			}
+			elements[i] = element;
 			elements[i]->type = VENG_TYPE_ELEMENT;
 			elements[i]->w = w;
 			elements[i]->h = h;
@@ -197,16 +372,10 @@ VENG_Element* VENG_CreateElement(float w, float h, bool stretch_size, bool visib
 			elements[i]->visible = visible;
 			elements[i]->layout = layout;
 			elements[i]->childs.sub_elements_size = max_sub_elements;
-			if (max_sub_elements == 0)
-			{
-				elements[i]->childs.sub_elements = NULL;	
-			}
-			else
-			{
-				elements[i]->childs.sub_elements = IS_NULL(calloc(max_sub_elements, sizeof(VENG_Element*)));
-			}
+			elements[i]->childs.sub_elements = sub_elements;
 			elements[i]->childs.sub_elements_count = 0;
 			elements[i]->dirty = true;
+			elements[i]->table_slot = i;
 			return_adress = elements[i];
 			break;
 		}
@@ -239,484 +408,1952 @@ VENG_Driver VENG_CreateDriver(SDL_Window* window, SDL_Renderer* renderer)
 }
 
 /*==========================================================================*\
- *                   				Add
+ *                   				Destroy
 \*==========================================================================*/
-int VENG_AddLayerToScreen(VENG_Layer* layer, VENG_Screen* screen)
+// Layers and elements don't share their layout, the childs must be reached through the type
+static VENG_Childs* __ContainerChilds(void* container)
 {
-	if (!VENG_HasStarted())
+	if (((VENG_Layer*)container)->type == VENG_TYPE_LAYER)
 	{
-		printf("VENG is not initialized yet\n");
-		return 1;
+		return &((VENG_Layer*)container)->childs;
 	}
-	if (layer == NULL || screen == NULL)
+	return &((VENG_Element*)container)->childs;
+}
+
+static bool __InSubtree(void* node, VENG_Element* root)
+{
+	while (node != NULL && ((VENG_Element*)node)->type == VENG_TYPE_ELEMENT)
 	{
-		printf("Layer or screen cannot be NULL\n");
-		return 1;
+		if (node == root)
+		{
+			return true;
+		}
+		node = ((VENG_Element*)node)->parent;
 	}
-	if (screen->layers == NULL)
+	return false;
+}
+
+static void __FreeElement(VENG_Element* element)
+{
+	for (size_t i = 0; element->childs.sub_elements != NULL && i < element->childs.sub_elements_size; i++)
 	{
-		screen->layers = IS_NULL(calloc(screen->layers_size, sizeof(VENG_Layer*)));
-		screen->layers_count = 0;
+		if (element->childs.sub_elements[i] != NULL)
+		{
+			__FreeElement(element->childs.sub_elements[i]);
+		}
 	}
-	if (screen->layers_count >= screen->layers_size)
+	if (element->hover != NULL)
 	{
-		printf("Couldn't add Layer: max size reached\n");
-		return 1;
+		VENG_SetHoverCallback(element, NULL);
 	}
-	for (size_t i = 0; i < screen->layers_size; i++)
+	VENG_FreeScroll(element);
+	VENG_FreeLazy(element);
+	VENG_FreeAnchor(element);
+	VENG_FreeAnchors(&element->childs);
+	VENG_FreeGrid(&element->childs);
+	VENG_FreeHits(&element->childs);
+	VENG_Free(VENG_MEMORY_CHILDS, element->childs.sub_elements, element->childs.sub_elements_size, sizeof(VENG_Element*));
+	elements[element->table_slot] = NULL;
+	elements_slots_count--;
+	VENG_Free(VENG_MEMORY_ELEMENTS, element, 1, sizeof(VENG_Element));
+}
+
+// Keeps the queued count of the elements an update refers to
+static void __CountUpdate(VENG_Update* update, int change)
+{
+	if (update->element != NULL)
 	{
-		if (screen->layers[i] == NULL)
+		update->element->queued += change;
+	}
+	if (update->target != NULL && update->target != (void*)update->element && ((VENG_Element*)update->target)->type == VENG_TYPE_ELEMENT)
+	{
+		((VENG_Element*)update->target)->queued += change;
+	}
+}
+
+// Drops an update that won't be applied, an element it was adding stays unparented
+static void __DropUpdate(VENG_Update* update)
+{
+	if (update->type == VENG_UPDATE_ADD)
+	{
+		update->element->adding = false;
+	}
+	__CountUpdate(update, -1);
+}
+
+static bool __HasQueued(VENG_Element* element)
+{
+	if (element->queued > 0)
+	{
+		return true;
+	}
+	for (size_t i = 0; element->childs.sub_elements != NULL && i < element->childs.sub_elements_size; i++)
+	{
+		if (element->childs.sub_elements[i] != NULL && __HasQueued(element->childs.sub_elements[i]))
 		{
-			screen->layers[i] = layer;
-			screen->layers_count += 1;
-			break;
+			return true;
 		}
 	}
-	return 0;
+	return false;
 }
 
-int VENG_AddElementToLayer(VENG_Element* element, VENG_Layer* layer)
+static int __SubmitUpdate(VENG_Update update);
+static int __DestroyElement(VENG_Element* element, bool arrange)
 {
-	if (!VENG_HasStarted())
+	// Queued updates of the subtree are dropped, subtrees without any skip the lists
+	if ((updates_count > 0 || batch_count > 0) && __HasQueued(element))
 	{
-		printf("VENG is not initialized yet\n");
-		return 1;
+		size_t kept = 0;
+		for (size_t i = 0; i < updates_count; i++)
+		{
+			VENG_Update* update = &updates[i];
+			if (!__InSubtree(update->element, element) && !__InSubtree(update->target, element))
+			{
+				updates[kept++] = *update;
+				continue;
+			}
+			if (update->type == VENG_UPDATE_ADD && !__InSubtree(update->target, element))
+			{
+				VENG_Childs* childs = __ContainerChilds(update->target);
+				childs->sub_elements_queued--;
+			}
+			__DropUpdate(update);
+		}
+		updates_count = kept;
+		// The batch being laid out is walked by VENG_EndUpdate, its entries are only neutralized
+		for (size_t i = 0; i < batch_count; i++)
+		{
+			if (__InSubtree(batch[i].element, element) || __InSubtree(batch[i].target, element))
+			{
+				__DropUpdate(&batch[i]);
+				batch[i] = (VENG_Update){.type = VENG_UPDATE_ARRANGE, .target = NULL};
+			}
+		}
 	}
-	if (element == NULL || layer == NULL)
+
+	VENG_ForgetElement(element);
+	VENG_StreamDamage(&element->rect);
+	void* parent = element->parent;
+	if (parent != NULL)
 	{
-		printf("Element or layer cannot be NULL\n");
-		return 1;
+		VENG_DetachAnchor(element);
+		VENG_Childs* childs = __ContainerChilds(parent);
+		childs->sub_elements[element->slot] = NULL;
+		childs->sub_elements_count--;
+	}
+	__FreeElement(element);
+	if (parent != NULL && ((VENG_Layer*)parent)->type == VENG_TYPE_ELEMENT)
+	{
+		VENG_InvalidateElement(parent);
 	}
-	if (layer->childs.sub_elements == NULL)
+	else
 	{
-		layer->childs.sub_elements = IS_NULL(calloc(layer->childs.sub_elements_size, sizeof(VENG_Element*)));
-		layer->childs.sub_elements_count = 0;
+		VENG_TouchContainer(parent);
 	}
-	if (layer->childs.sub_elements_count >= layer->childs.sub_elements_size)
+	// The siblings close the hole like after any other change
+	if (parent != NULL && arrange)
 	{
-		printf("Couldn't add Element: max size reached\n");
+		return __SubmitUpdate((VENG_Update){.type = VENG_UPDATE_ARRANGE, .target = parent});
+	}
+	return 0;
+}
+
+
+int VENG_DestroyElement(VENG_Element* element)
+{
+	if (!VENG_HasStarted())
+	{
+		printf("VENG is not initialized yet\n");
 		return 1;
 	}
-	for (size_t i = 0; i < layer->childs.sub_elements_size; i++)
+	if (element == NULL)
+	{
+		printf("Element is NULL\n");
+		return 1;
+	}
+	return __DestroyElement(element, true);
+}
+
+// Empties a container without laying it out again, for the ones that are rebuilt right after
+void VENG_DestroyChilds(void* container)
+{
+	VENG_Childs* childs = __ContainerChilds(container);
+	for (size_t i = 0; childs->sub_elements != NULL && i < childs->sub_elements_size; i++)
 	{
-		if (layer->childs.sub_elements[i] == NULL)
+		if (childs->sub_elements[i] != NULL)
 		{
-			layer->childs.sub_elements[i] = element;
-			layer->childs.sub_elements_count += 1;
-			break;
+			__DestroyElement(childs->sub_elements[i], false);
 		}
 	}
-	return 0;
 }
 
-int VENG_AddSubElementToElement(VENG_Element* sub_element, VENG_Element* element)
+int VENG_DestroyLayer(VENG_Layer* layer)
 {
 	if (!VENG_HasStarted())
 	{
 		printf("VENG is not initialized yet\n");
 		return 1;
 	}
-	else if (sub_element == NULL || element == NULL)
+	if (layer == NULL)
 	{
-		printf("Sub_element or Element cannot be NULL\n");
+		printf("Layer is NULL\n");
 		return 1;
 	}
-	if (element->childs.sub_elements == NULL)
+	VENG_DestroyChilds(layer);
+	// What's still queued for it is dropped, elements about to be added stay unparented
+	size_t kept = 0;
+	for (size_t i = 0; i < updates_count; i++)
 	{
-		element->childs.sub_elements = IS_NULL(calloc(element->childs.sub_elements_size, sizeof(VENG_Element*)));
-		element->childs.sub_elements_count = 0;
+		if (updates[i].target != (void*)layer)
+		{
+			updates[kept++] = updates[i];
+			continue;
+		}
+		__DropUpdate(&updates[i]);
 	}
-	if (element->childs.sub_elements_count >= element->childs.sub_elements_size)
+	updates_count = kept;
+	for (size_t i = 0; i < batch_count; i++)
 	{
-		printf("Couldn't add Element: max size reached\n");
-		return 1;
+		if (batch[i].target == (void*)layer)
+		{
+			__DropUpdate(&batch[i]);
+			batch[i] = (VENG_Update){.type = VENG_UPDATE_ARRANGE, .target = NULL};
+		}
 	}
-	for (size_t i = 0; i < element->childs.sub_elements_size; i++)
+
+	for (size_t i = 0; screens != NULL && i < screen_slots_size; i++)
 	{
-		if (element->childs.sub_elements[i] == NULL)
+		VENG_Screen* screen = screens[i];
+		for (size_t k = 0; screen != NULL && screen->layers != NULL && k < screen->layers_size; k++)
 		{
-			element->childs.sub_elements[i] = sub_element;
-			element->childs.sub_elements_count += 1;
-			break;
+			if (screen->layers[k] == layer)
+			{
+				screen->layers[k] = NULL;
+				screen->layers_count--;
+				screen->generation += layer->generation + 1; // Its generation leaves the screen sum
+			}
+		}
+	}
+	VENG_FreeShortcuts(layer);
+	VENG_FreeFocus(layer);
+	VENG_FreeLayerListeners(layer);
+	VENG_FreeAnchors(&layer->childs);
+	VENG_FreeGrid(&layer->childs);
+	VENG_FreeHits(&layer->childs);
+	VENG_Free(VENG_MEMORY_CHILDS, layer->childs.sub_elements, layer->childs.sub_elements_size, sizeof(VENG_Element*));
+	for (size_t i = 0; i < layer_slots_size; i++)
+	{
+		if (layers[i] == layer)
+		{
+			layers[i] = NULL;
+			layer_slots_count--;
 		}
 	}
+	VENG_Free(VENG_MEMORY_LAYERS, layer, 1, sizeof(VENG_Layer));
+	VENG_StreamDamage(NULL);
 	return 0;
 }
 
 /*==========================================================================*\
- *                   				 Set
+ *                   				Add
 \*==========================================================================*/
-int VENG_SetScreen(VENG_Screen* screen)
+int VENG_AddLayerToScreen(VENG_Layer* layer, VENG_Screen* screen)
 {
 	if (!VENG_HasStarted())
 	{
 		printf("VENG is not initialized yet\n");
 		return 1;
 	}
-	if (screen == NULL)
+	if (layer == NULL || screen == NULL)
 	{
-		SDL_SetWindowTitle(driver.window, "VENG");
-		SDL_SetWindowIcon(driver.window, NULL);
-		return 0;
+		printf("Layer or screen cannot be NULL\n");
+		return 1;
 	}
-	rendering_screen = screen;
-	if (screen->icon != NULL)
+	if (screen->layers == NULL)
+	{
+		screen->layers = VENG_Alloc(VENG_MEMORY_CHILDS, screen->layers_size, sizeof(VENG_Layer*));
+		screen->layers_count = 0;
+		if (screen->layers == NULL)
+		{
+			printf("Couldn't allocate Layer slots\n");
+			return 1;
+		}
+	}
+	if (screen->layers_count >= screen->layers_size)
+	{
+		printf("Couldn't add Layer: max size reached\n");
+		return 1;
+	}
+	for (size_t i = 0; i < screen->layers_size; i++)
 	{
-		SDL_SetWindowIcon(driver.window, screen->icon);
+		if (screen->layers[i] == NULL)
+		{
+			screen->layers[i] = layer;
+			screen->layers_count += 1;
+			break;
+		}
 	}
-	SDL_SetWindowTitle(driver.window, screen->title);
+	screen->generation++;
 	return 0;
 }
 
-int VENG_SetDriver(VENG_Driver new_driver)
+// Lazily allocates the slots of a layer or element, then checks there is room for one more
+static int __ReserveChild(VENG_Childs* childs)
 {
-	if (!VENG_HasStarted())
+	if (childs->sub_elements == NULL)
 	{
-		printf("VENG is not initialized yet\n");
-		return 1;
+		childs->sub_elements = VENG_Alloc(VENG_MEMORY_CHILDS, childs->sub_elements_size, sizeof(VENG_Element*));
+		childs->sub_elements_count = 0;
+		if (childs->sub_elements == NULL)
+		{
+			printf("Couldn't allocate Element slots\n");
+			return 1;
+		}
 	}
-	if (new_driver.window == NULL || new_driver.renderer == NULL)
+	if (childs->sub_elements_count + childs->sub_elements_queued >= childs->sub_elements_size)
 	{
+		printf("Couldn't add Element: max size reached\n");
 		return 1;
 	}
-	driver = new_driver;
 	return 0;
 }
 
-/*==========================================================================*\
- *                   				 Get
-\*==========================================================================*/
-VENG_Screen* VENG_GetScreen()
+static void __AddChild(VENG_Childs* childs, VENG_Element* element, void* container)
 {
-	if (!VENG_HasStarted())
+	for (size_t i = 0; i < childs->sub_elements_size; i++)
 	{
-		printf("VENG is not initialized yet\n");
-		return NULL;
+		if (childs->sub_elements[i] == NULL)
+		{
+			childs->sub_elements[i] = element;
+			childs->sub_elements_count += 1;
+			element->parent = container;
+			element->slot = i;
+			break;
+		}
 	}
-	return rendering_screen;
+	VENG_TouchContainer(container);
 }
 
-VENG_Driver VENG_GetDriver()
+static int __QueueUpdate(VENG_Update update);
+static int __AddElement(VENG_Element* element, void* container, VENG_Childs* childs)
 {
-	if (!VENG_HasStarted())
+	// An element queued for an add already has its parent
+	if (element->parent != NULL || element->adding || element == container)
 	{
-		printf("VENG is not initialized yet\n");
-		return (VENG_Driver){0};
+		printf("Element already has a parent\n");
+		return 1;
 	}
-	return driver;
+	if (__ReserveChild(childs) != 0)
+	{
+		return 1;
+	}
+	if (update_depth > 0)
+	{
+		if (__QueueUpdate((VENG_Update){.type = VENG_UPDATE_ADD, .target = container, .element = element}) != 0)
+		{
+			return 1;
+		}
+		childs->sub_elements_queued++;
+		element->adding = true;
+		return 0;
+	}
+	__AddChild(childs, element, container);
+	return 0;
 }
 
-SDL_Rect VENG_GetElementRect(VENG_Element* element)
+int VENG_AddElementToLayer(VENG_Element* element, VENG_Layer* layer)
 {
 	if (!VENG_HasStarted())
 	{
 		printf("VENG is not initialized yet\n");
-		return (SDL_Rect){0};
+		return 1;
 	}
-	else if (element == NULL)
+	if (element == NULL || layer == NULL)
 	{
-		printf("Element is NULL\n");
-		return (SDL_Rect){0};
+		printf("Element or layer cannot be NULL\n");
+		return 1;
 	}
-	return element->rect;
+	return __AddElement(element, layer, &layer->childs);
 }
 
-SDL_Rect* VENG_GetElementRectPtr(VENG_Element* element)
+int VENG_AddSubElementToElement(VENG_Element* sub_element, VENG_Element* element)
 {
 	if (!VENG_HasStarted())
 	{
 		printf("VENG is not initialized yet\n");
-		return NULL;
+		return 1;
 	}
-	else if (element == NULL)
+	else if (sub_element == NULL || element == NULL)
 	{
-		printf("Element is NULL\n");
-		return NULL;
+		printf("Sub_element or Element cannot be NULL\n");
+		return 1;
 	}
-	return &element->rect;
+	return __AddElement(sub_element, element, &element->childs);
 }
 
-
 /*==========================================================================*\
- *                   			   Prepare
+ *                   				Update
 \*==========================================================================*/
-int VENG_PrepareScreen(VENG_Screen* screen)
+// Changes made between VENG_BeginUpdate and VENG_EndUpdate are validated and queued.
+// The outermost VENG_EndUpdate applies them in order, then lays out each affected
+// container once, skipping the ones whose ancestor is laid out anyway.
+int VENG_BeginUpdate()
 {
 	if (!VENG_HasStarted())
 	{
 		printf("VENG is not initialized yet\n");
 		return 1;
 	}
-	if (screen == NULL)
+	update_depth++;
+	return 0;
+}
+
+static int __QueueUpdate(VENG_Update update)
+{
+	if (updates_count >= updates_size)
 	{
-		printf("Screen is NULL\n");
-		return 1;
-	}
+		VENG_Update* new_updates = VENG_Realloc(VENG_MEMORY_CHILDS, updates, updates_size, updates_size + ALLOCATED_UPDATES_START, sizeof(VENG_Update));
+		if (new_updates == NULL)
+		{
+			printf("Couldn't allocate Update slots\n");
+			return 1;
+		}
+		updates = new_updates;
+		updates_size += ALLOCATED_UPDATES_START;
+	}
+	updates[updates_count++] = update;
+	__CountUpdate(&update, 1);
+	return 0;
+}
+
+// Outside a bracket a change is a one-update bracket
+static int __SubmitUpdate(VENG_Update update)
+{
+	if (update_depth > 0)
+	{
+		return __QueueUpdate(update);
+	}
+	VENG_BeginUpdate();
+	int result = __QueueUpdate(update);
+	return VENG_EndUpdate() || result;
+}
+
+static Uint8* __LayoutState(void* container)
+{
+	if (((VENG_Layer*)container)->type == VENG_TYPE_LAYER)
+	{
+		return &((VENG_Layer*)container)->layout_state;
+	}
+	return &((VENG_Element*)container)->layout_state;
+}
+
+// Container that has to be laid out again after the update
+static void* __AffectedContainer(VENG_Update* update)
+{
+	if (update->type == VENG_UPDATE_SIZE || update->type == VENG_UPDATE_VISIBLE)
+	{
+		return update->element->parent;
+	}
+	return update->target;
+}
+
+// A container is laid out if it hangs from a layer, is visible and no ancestor is laid out
+static bool __NeedsLayout(void* container)
+{
+	while (((VENG_Layer*)container)->type == VENG_TYPE_ELEMENT)
+	{
+		VENG_Element* element = (VENG_Element*)container;
+		if (!element->visible || element->parent == NULL)
+		{
+			return false;
+		}
+		container = element->parent;
+		if (*__LayoutState(container) != VENG_LAYOUT_CLEAN)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+// Applies the batch, then lays out each affected container once
+static void __ApplyBatch()
+{
+	// Apply
+	for (size_t i = 0; i < batch_count; i++)
+	{
+		VENG_Update* update = &batch[i];
+		switch (update->type)
+		{
+			case VENG_UPDATE_ADD:
+			{
+				VENG_Childs* childs = __ContainerChilds(update->target);
+				childs->sub_elements_queued--;
+				update->element->adding = false;
+				__AddChild(childs, update->element, update->target);
+				break;
+			}
+			case VENG_UPDATE_SIZE:
+				update->element->w = update->w;
+				update->element->h = update->h;
+				break;
+			case VENG_UPDATE_VISIBLE:
+				update->element->visible = update->visible;
+				break;
+			case VENG_UPDATE_LAYOUT:
+				if (((VENG_Layer*)update->target)->type == VENG_TYPE_LAYER)
+				{
+					((VENG_Layer*)update->target)->layout = update->layout;
+				}
+				else
+				{
+					((VENG_Element*)update->target)->layout = update->layout;
+				}
+				break;
+			case VENG_UPDATE_ARRANGE:
+				break;
+		}
+	}
+	for (size_t i = 0; i < batch_count; i++)
+	{
+		void* container = __AffectedContainer(&batch[i]);
+		if (container != NULL)
+		{
+			*__LayoutState(container) = VENG_LAYOUT_QUEUED;
+			VENG_TouchContainer(container);
+		}
+	}
+
+	// Layout
+	Uint64 start = VENG_LatencyBegin();
+	int window_w, window_h;
+	VENG_GetLogicalSize(&window_w, &window_h);
+	for (size_t i = 0; i < batch_count; i++)
+	{
+		void* container = __AffectedContainer(&batch[i]);
+		if (container == NULL || *__LayoutState(container) != VENG_LAYOUT_QUEUED || !__NeedsLayout(container))
+		{
+			continue;
+		}
+		if (((VENG_Layer*)container)->type == VENG_TYPE_LAYER)
+		{
+			VENG_PrepareElements(container, (SDL_Rect){0, 0, window_w, window_h});
+		}
+		else
+		{
+			VENG_PrepareElements(container, ((VENG_Element*)container)->rect);
+		}
+		*__LayoutState(container) = VENG_LAYOUT_DONE;
+	}
+	VENG_LatencyEnd(VENG_LATENCY_LAYOUT, start);
+	for (size_t i = 0; i < batch_count; i++)
+	{
+		void* container = __AffectedContainer(&batch[i]);
+		if (container != NULL)
+		{
+			*__LayoutState(container) = VENG_LAYOUT_CLEAN;
+		}
+	}
+}
+
+int VENG_EndUpdate()
+{
+	if (!VENG_HasStarted())
+	{
+		printf("VENG is not initialized yet\n");
+		return 1;
+	}
+	if (update_depth == 0)
+	{
+		printf("There is no update to end\n");
+		return 1;
+	}
+	if (--update_depth > 0)
+	{
+		return 0;
+	}
+
+	// Layouts can run lazy builders. Bracketed by the raised depth, their changes are queued
+	// in a new list instead of applying the batch again, and applied as the next batch
+	while (updates_count > 0)
+	{
+		batch = updates;
+		batch_count = updates_count;
+		size_t batch_size = updates_size;
+		updates = NULL;
+		updates_count = 0;
+		updates_size = 0;
+		update_depth++;
+		__ApplyBatch();
+		update_depth--;
+		for (size_t i = 0; i < batch_count; i++)
+		{
+			__CountUpdate(&batch[i], -1);
+		}
+		if (updates == NULL)
+		{
+			// Nothing was queued, the storage is kept for the next bracket
+			updates = batch;
+			updates_size = batch_size;
+		}
+		else
+		{
+			VENG_Free(VENG_MEMORY_CHILDS, batch, batch_size, sizeof(VENG_Update));
+		}
+		batch = NULL;
+		batch_count = 0;
+	}
+	return 0;
+}
+
+bool VENG_IsUpdating()
+{
+	return update_depth > 0;
+}
+
+// Makes childs the sub-elements of the container, in that order. They must be its sub-elements
+// already or have no parent, the sub-elements left out must have been destroyed before.
+int VENG_SetChilds(void* container, VENG_Element** childs, size_t count)
+{
+	VENG_Childs* list = __ContainerChilds(container);
+	size_t kept = 0;
+	for (size_t i = 0; i < count; i++)
+	{
+		if (childs[i]->parent != NULL && childs[i]->parent != container)
+		{
+			printf("Element already has another parent\n");
+			return 1;
+		}
+		kept += childs[i]->parent == container;
+	}
+	if (list->sub_elements_queued > 0 || kept != list->sub_elements_count)
+	{
+		printf("Container has queued or unlisted sub-elements\n");
+		return 1;
+	}
+	if (count > list->sub_elements_size || (list->sub_elements == NULL && count > 0))
+	{
+		size_t size = SDL_max(count, list->sub_elements_size);
+		VENG_Element** sub_elements = VENG_Alloc(VENG_MEMORY_CHILDS, size, sizeof(VENG_Element*));
+		if (sub_elements == NULL)
+		{
+			printf("Couldn't allocate Element slots\n");
+			return 1;
+		}
+		if (list->sub_elements != NULL)
+		{
+			memcpy(sub_elements, list->sub_elements, list->sub_elements_size * sizeof(VENG_Element*));
+			VENG_Free(VENG_MEMORY_CHILDS, list->sub_elements, list->sub_elements_size, sizeof(VENG_Element*));
+		}
+		list->sub_elements = sub_elements;
+		list->sub_elements_size = size;
+	}
+	// Same elements in the same order only close the holes, nothing to lay out
+	bool arranged = count != list->sub_elements_count;
+	for (size_t i = 0, k = 0; !arranged && i < list->sub_elements_size; i++)
+	{
+		if (list->sub_elements[i] != NULL)
+		{
+			arranged = list->sub_elements[i] != childs[k++];
+		}
+	}
+	for (size_t i = 0; i < list->sub_elements_size; i++)
+	{
+		list->sub_elements[i] = i < count ? childs[i] : NULL;
+		if (i < count)
+		{
+			childs[i]->parent = container;
+			childs[i]->slot = i;
+		}
+	}
+	list->sub_elements_count = count;
+	if (!arranged)
+	{
+		return 0;
+	}
+	return __SubmitUpdate((VENG_Update){.type = VENG_UPDATE_ARRANGE, .target = container});
+}
+
+int VENG_SetElementSize(VENG_Element* element, float w, float h)
+{
+	if (!VENG_HasStarted())
+	{
+		printf("VENG is not initialized yet\n");
+		return 1;
+	}
+	if (element == NULL)
+	{
+		printf("Element is NULL\n");
+		return 1;
+	}
+	if (w < 0 || h < 0)
+	{
+		printf("W and H cannot be negative\n");
+		return 1;
+	}
+	return __SubmitUpdate((VENG_Update){.type = VENG_UPDATE_SIZE, .target = element, .element = element, .w = w, .h = h});
+}
+
+int VENG_SetElementVisible(VENG_Element* element, bool visible)
+{
+	if (!VENG_HasStarted())
+	{
+		printf("VENG is not initialized yet\n");
+		return 1;
+	}
+	if (element == NULL)
+	{
+		printf("Element is NULL\n");
+		return 1;
+	}
+	return __SubmitUpdate((VENG_Update){.type = VENG_UPDATE_VISIBLE, .target = element, .element = element, .visible = visible});
+}
+
+int VENG_SetElementLayout(VENG_Element* element, VENG_Layout layout)
+{
+	if (!VENG_HasStarted())
+	{
+		printf("VENG is not initialized yet\n");
+		return 1;
+	}
+	if (element == NULL)
+	{
+		printf("Element is NULL\n");
+		return 1;
+	}
+	return __SubmitUpdate((VENG_Update){.type = VENG_UPDATE_LAYOUT, .target = element, .layout = layout});
+}
+
+int VENG_SetLayerLayout(VENG_Layer* layer, VENG_Layout layout)
+{
+	if (!VENG_HasStarted())
+	{
+		printf("VENG is not initialized yet\n");
+		return 1;
+	}
+	if (layer == NULL)
+	{
+		printf("Layer is NULL\n");
+		return 1;
+	}
+	return __SubmitUpdate((VENG_Update){.type = VENG_UPDATE_LAYOUT, .target = layer, .layout = layout});
+}
+
+/*==========================================================================*\
+ *                   				 Set
+\*==========================================================================*/
+int VENG_SetScreen(VENG_Screen* screen)
+{
+	if (!VENG_HasStarted())
+	{
+		printf("VENG is not initialized yet\n");
+		return 1;
+	}
+	if (screen == NULL)
+	{
+		SDL_SetWindowTitle(windows[current_window].driver.window, "VENG");
+		SDL_SetWindowIcon(windows[current_window].driver.window, NULL);
+		return 0;
+	}
+	VENG_UseScreenWindow(screen);
+	SDL_Window* window = windows[current_window].driver.window;
+	windows[current_window].rendering_screen = screen;
+	if (screen->icon != NULL)
+	{
+		SDL_SetWindowIcon(window, screen->icon);
+	}
+	SDL_SetWindowTitle(window, screen->title);
+	// The layout is kept while the screen is hidden, it's only computed again if something changed
+	if (!VENG_IsScreenPrepared(screen))
+	{
+		VENG_PrepareScreen(screen);
+	}
+	VENG_ShowSnapshot(screen);
+	return 0;
+}
+
+int VENG_SetLayerMode(VENG_Layer* layer, VENG_LayerMode mode)
+{
+	if (!VENG_HasStarted())
+	{
+		printf("VENG is not initialized yet\n");
+		return 1;
+	}
+	if (layer == NULL)
+	{
+		printf("Layer is NULL\n");
+		return 1;
+	}
+	layer->mode = mode;
+	layer->generation++;
+	VENG_StreamDamage(NULL);
+	return 0;
+}
+
+int VENG_SetDriver(VENG_Driver new_driver)
+{
+	if (!VENG_HasStarted())
+	{
+		printf("VENG is not initialized yet\n");
+		return 1;
+	}
+	if (new_driver.window == NULL || new_driver.renderer == NULL)
+	{
+		return 1;
+	}
+	windows[0].driver = new_driver;
+	return 0;
+}
+
+/*==========================================================================*\
+ *                   				 Get
+\*==========================================================================*/
+VENG_Screen* VENG_GetScreen()
+{
+	if (!VENG_HasStarted())
+	{
+		printf("VENG is not initialized yet\n");
+		return NULL;
+	}
+	return windows[current_window].rendering_screen;
+}
+
+VENG_Driver VENG_GetDriver()
+{
+	if (!VENG_HasStarted())
+	{
+		printf("VENG is not initialized yet\n");
+		return (VENG_Driver){0};
+	}
+	return windows[current_window].driver;
+}
+
+// Layers are stacked by index, the last one is on top
+static size_t __GetLowestLayer(VENG_Screen* screen, VENG_LayerMode covering_mode)
+{
+	if (screen->layers == NULL)
+	{
+		return 0;
+	}
+	for (size_t i = screen->layers_size; i > 0; i--)
+	{
+		if (screen->layers[i - 1] != NULL && screen->layers[i - 1]->mode >= covering_mode)
+		{
+			return i - 1;
+		}
+	}
+	return 0;
+}
+
+size_t VENG_GetLowestVisibleLayer(VENG_Screen* screen)
+{
+	if (!VENG_HasStarted())
+	{
+		printf("VENG is not initialized yet\n");
+		return 0;
+	}
+	if (screen == NULL)
+	{
+		printf("Screen is NULL\n");
+		return 0;
+	}
+	return __GetLowestLayer(screen, VENG_LAYER_OPAQUE);
+}
+
+size_t VENG_GetLowestListeningLayer(VENG_Screen* screen)
+{
+	if (!VENG_HasStarted())
+	{
+		printf("VENG is not initialized yet\n");
+		return 0;
+	}
+	if (screen == NULL)
+	{
+		printf("Screen is NULL\n");
+		return 0;
+	}
+	return __GetLowestLayer(screen, VENG_LAYER_MODAL);
+}
+
+SDL_Rect VENG_GetElementRect(VENG_Element* element)
+{
+	if (!VENG_HasStarted())
+	{
+		printf("VENG is not initialized yet\n");
+		return (SDL_Rect){0};
+	}
+	else if (element == NULL)
+	{
+		printf("Element is NULL\n");
+		return (SDL_Rect){0};
+	}
+	return element->rect;
+}
+
+SDL_Rect* VENG_GetElementRectPtr(VENG_Element* element)
+{
+	if (!VENG_HasStarted())
+	{
+		printf("VENG is not initialized yet\n");
+		return NULL;
+	}
+	else if (element == NULL)
+	{
+		printf("Element is NULL\n");
+		return NULL;
+	}
+	return &element->rect;
+}
+
+
+/*==========================================================================*\
+ *                   			   Prepare
+\*==========================================================================*/
+int VENG_PrepareScreen(VENG_Screen* screen)
+{
+	if (!VENG_HasStarted())
+	{
+		printf("VENG is not initialized yet\n");
+		return 1;
+	}
+	if (screen == NULL)
+	{
+		printf("Screen is NULL\n");
+		return 1;
+	}
 	if (screen->layers == NULL || screen->layers_count == 0)
 	{
 		return 0;
 	}
-	for (size_t i = 0; i < screen->layers_size; i++)
+	VENG_StartScaleFrame();
+	size_t previous = current_window;
+	VENG_UseScreenWindow(screen); // Laid out in the size of its window
+	// Layers under an opaque one are fully covered, they don't need a layout
+	for (size_t i = VENG_GetLowestVisibleLayer(screen); i < screen->layers_size; i++)
+	{
+		if (screen->layers[i] != NULL)
+		{
+			VENG_PrepareLayer(screen->layers[i]);
+		}
+	}
+	VENG_SetScreenPrepared(screen);
+	VENG_UseWindowSlot(previous);
+	return 0;
+}
+
+int VENG_PrepareLayer(VENG_Layer* layer)
+{
+	if (!VENG_HasStarted())
+	{
+		printf("VENG is not initialized yet\n");
+		return 1;
+	}
+	if (layer == NULL)
+	{
+		printf("Layer is NULL");
+		return 1;
+	}
+	VENG_StartScaleFrame();
+	int window_w, window_h;
+	VENG_GetLogicalSize(&window_w, &window_h);
+	Uint64 start = VENG_LatencyBegin();
+	VENG_TraceBegin("PrepareLayer", layer);
+	VENG_PrepareElements(layer, (SDL_Rect){0, 0, window_w, window_h});
+	VENG_TraceEnd();
+	VENG_LatencyEnd(VENG_LATENCY_LAYOUT, start);
+	layer->generation++;
+	return 0;
+}
+
+static void __PrepareElements(void* parent_container, SDL_Rect drawing_rect);
+void VENG_PrepareElements(void* parent_container, SDL_Rect drawing_rect)
+{
+	if (!VENG_HasStarted())
+	{
+		printf("VENG is not initialized yet\n");
+		return;
+	}
+	if (parent_container != NULL)
+	{
+		// Whatever the childs were, they are drawn in the container
+		bool layer = ((VENG_Layer*)parent_container)->type == VENG_TYPE_LAYER;
+		VENG_StreamDamage(layer ? &drawing_rect : &((VENG_Element*)parent_container)->rect);
+	}
+	if (VENG_IsTracing() && parent_container != NULL && __ContainerChilds(parent_container)->sub_elements_count >= VENG_GetTracePrepareThreshold())
+	{
+		VENG_TraceBegin("PrepareElements", parent_container);
+		__PrepareElements(parent_container, drawing_rect);
+		VENG_TraceEnd();
+		return;
+	}
+	__PrepareElements(parent_container, drawing_rect);
+}
+
+// Size of an element from its w and h: stretched elements follow both sides of the drawing rect,
+// the rest keep their ratio and follow the shortest side. The result is kept in the element and
+// reused while the drawing size, w, h and stretch_size stay the same. A zeroed cache is valid,
+// zero inputs measure zero.
+static VENG_Measure* __Measure(VENG_Element* element, SDL_Rect drawing_rect)
+{
+	VENG_Measure* measure = &element->measure;
+	if (measure->drawing_w == drawing_rect.w && measure->drawing_h == drawing_rect.h && measure->w == element->w && measure->h == element->h && measure->stretch_size == element->stretch_size)
+	{
+		return measure;
+	}
+	float base_w = drawing_rect.w, base_h = drawing_rect.h;
+	if (!element->stretch_size)
+	{
+		base_w = base_h = drawing_rect.w >= drawing_rect.h ? drawing_rect.h : drawing_rect.w;
+	}
+	*measure = (VENG_Measure){drawing_rect.w, drawing_rect.h, element->w, element->h, element->stretch_size, element->w * base_w, element->h * base_h};
+	return measure;
+}
+
+SDL_Point VENG_GetElementSize(VENG_Element* element, SDL_Rect drawing_rect)
+{
+	VENG_Measure* measure = __Measure(element, drawing_rect);
+	return (SDL_Point){round(measure->size_w), round(measure->size_h)};
+}
+
+typedef enum VENG_AlignSide
+{
+	VENG_SIDE_START,
+	VENG_SIDE_CENTER,
+	VENG_SIDE_END,
+	VENG_SIDE_INVALID
+} VENG_AlignSide;
+
+static VENG_AlignSide __AlignSide(VENG_Align align, VENG_Align start, VENG_Align end)
+{
+	if (align == start) return VENG_SIDE_START;
+	if (align == VENG_CENTER) return VENG_SIDE_CENTER;
+	if (align == end) return VENG_SIDE_END;
+	return VENG_SIDE_INVALID;
+}
+
+// Places a measured child at the cursor along the arrangement axis. Edges are rounded instead
+// of sizes, so consecutive childs share their edges and never leave a gap or overlap
+static void __Arrange(VENG_Element* child, SDL_Rect drawing_rect, bool horizontal, VENG_AlignSide main_side, VENG_AlignSide cross_side, float* cursor)
+{
+	float size_main = horizontal ? child->measure.size_w : child->measure.size_h;
+	int main_length = horizontal ? drawing_rect.w : drawing_rect.h;
+	int cross_length = horizontal ? drawing_rect.h : drawing_rect.w;
+	int start = round(*cursor);
+	*cursor += size_main;
+	int end = round(*cursor);
+	int cross = round(horizontal ? child->measure.size_h : child->measure.size_w);
+
+	// End aligned childs are stacked from the end, the first one against it
+	int main_position = main_side == VENG_SIDE_END ? main_length - end : start;
+	int cross_position = cross_side == VENG_SIDE_START ? 0 : cross_side == VENG_SIDE_CENTER ? (cross_length - cross) / 2 : cross_length - cross;
+	if (horizontal)
+	{
+		child->rect = (SDL_Rect){drawing_rect.x + main_position, drawing_rect.y + cross_position, end - start, cross};
+	}
+	else
+	{
+		child->rect = (SDL_Rect){drawing_rect.x + cross_position, drawing_rect.y + main_position, cross, end - start};
+	}
+}
+
+static void __PrepareElements(void* parent_container, SDL_Rect drawing_rect)
+{
+	// (I) Measure every child's size (cached in the child, see __Measure)
+	// (II) Arrange every child, in the same pass unless they are centered
+	// (III) Check if the childs have more childs
+	
+	// void* parent_container -----> layout & childs
+
+	if (parent_container == NULL)
+	{
+		return;
+	}
+
+	VENG_Layout* layout = NULL;
+	VENG_Childs* childs = NULL;
+	{
+		VENG_Layer* data = (VENG_Layer*)parent_container;
+		VENG_ParentType type = data->type;
+		if (type == VENG_TYPE_LAYER)
+		{
+			layout = &data->layout;
+			childs = &data->childs;
+		}
+		else if (type == VENG_TYPE_ELEMENT)
+		{
+			VENG_Element* element = (VENG_Element*)parent_container;
+			layout = &element->layout;
+			childs = &element->childs;
+			if (element->lazy != NULL)
+			{
+				VENG_BuildSubtree(element);
+			}
+			if (element->scroll != NULL)
+			{
+				// Childs are laid out in the scrolled content rect
+				drawing_rect = VENG_PrepareScroll(element);
+			}
+		}
+		else
+		{
+			printf("Invalid Parent_Container\n");
+			return;
+		}
+	}
+
+	if (layout == NULL || childs == NULL)
+	{
+		return;
+	}
+	VENG_InvalidateHits(childs);
+	VENG_InvalidateFocus(parent_container);
+
+	if (childs->sub_elements == NULL || childs->sub_elements_size == 0 || childs->sub_elements_count == 0)
+	{
+		return;
+	}
+
+	if (layout->arrangement == VENG_ANCHORED || layout->arrangement == VENG_GRID)
+	{
+		// Rects come from the constraints or the cells, then every child lays its own childs out
+		// Without a solution the old rects would be recursed into, the childs wait for the next layout
+		int solved = layout->arrangement == VENG_ANCHORED ? VENG_SolveAnchors(childs, drawing_rect) : VENG_SolveGrid(childs, layout, drawing_rect);
+		if (solved != 0)
+		{
+			return;
+		}
+		for (size_t i = 0; i < childs->sub_elements_size; i++)
+		{
+			if (childs->sub_elements[i] != NULL && childs->sub_elements[i]->visible)
+			{
+				VENG_PrepareElements(childs->sub_elements[i], childs->sub_elements[i]->rect);
+			}
+			else if (childs->sub_elements[i] != NULL && childs->sub_elements[i]->lazy != NULL)
+			{
+				VENG_HideSubtree(childs->sub_elements[i]);
+			}
+		}
+		return;
+	}
+
+	bool horizontal = layout->arrangement == VENG_HORIZONTAL;
+	VENG_AlignSide side_h = __AlignSide(layout->align_horizontal, VENG_LEFT, VENG_RIGHT);
+	VENG_AlignSide side_v = __AlignSide(layout->align_vertical, VENG_TOP, VENG_BOTTOM);
+	if (side_h == VENG_SIDE_INVALID)
+	{
+		printf("Invalid align_h argument.\n");
+		return;
+	}
+	if (side_v == VENG_SIDE_INVALID)
+	{
+		printf("Invalid align_v argument.\n");
+		return;
+	}
+	VENG_AlignSide main_side = horizontal ? side_h : side_v;
+	VENG_AlignSide cross_side = horizontal ? side_v : side_h;
+
+	// (I) Measure every visible child. Unless they are centered, they are arranged in the same
+	// pass, otherwise their sizes are summed and they are arranged in a second one
+	float cursor = 0;
+	float total = 0;
+	for (size_t i = 0; i < childs->sub_elements_size; i++)
+	{
+		VENG_Element* child = childs->sub_elements[i];
+		if (child == NULL)
+		{
+			continue;
+		}
+		if (!child->visible)
+		{
+			// The hidden child's rect is reset, its subtree is left unlaid-out until it's shown
+			child->rect = (SDL_Rect){-1, -1, -1, -1};
+			if (child->lazy != NULL)
+			{
+				VENG_HideSubtree(child);
+			}
+			continue;
+		}
+		VENG_Measure* measure = __Measure(child, drawing_rect);
+		if (main_side == VENG_SIDE_CENTER)
+		{
+			total += horizontal ? measure->size_w : measure->size_h;
+			continue;
+		}
+		// (II)
+		__Arrange(child, drawing_rect, horizontal, main_side, cross_side, &cursor);
+		// (III)
+		VENG_PrepareElements(child, child->rect);
+	}
+	if (main_side != VENG_SIDE_CENTER)
+	{
+		return;
+	}
+
+	// (II) Centered childs, only the visible ones were summed
+	cursor = ((horizontal ? drawing_rect.w : drawing_rect.h) - total) / 2;
+	for (size_t i = 0; i < childs->sub_elements_size; i++)
+	{
+		VENG_Element* child = childs->sub_elements[i];
+		if (child != NULL && child->visible)
+		{
+			__Arrange(child, drawing_rect, horizontal, main_side, cross_side, &cursor);
+			// (III)
+			VENG_PrepareElements(child, child->rect);
+		}
+	}
+}
+
+/*==========================================================================*\
+ *                   				Windows
+\*==========================================================================*/
+// 0 for events that don't belong to a window
+static Uint32* __EventWindowField(SDL_Event* event)
+{
+	switch (event->type)
+	{
+		case SDL_WINDOWEVENT:
+			return &event->window.windowID;
+		case SDL_KEYDOWN:
+		case SDL_KEYUP:
+			return &event->key.windowID;
+		case SDL_TEXTEDITING:
+			return &event->edit.windowID;
+		case SDL_TEXTINPUT:
+			return &event->text.windowID;
+		case SDL_MOUSEMOTION:
+			return &event->motion.windowID;
+		case SDL_MOUSEBUTTONDOWN:
+		case SDL_MOUSEBUTTONUP:
+			return &event->button.windowID;
+		case SDL_MOUSEWHEEL:
+			return &event->wheel.windowID;
+		default:
+			return NULL;
+	}
+}
+
+static Uint32 __EventWindowID(SDL_Event* event)
+{
+	Uint32* id = __EventWindowField(event);
+	return id != NULL ? *id : 0;
+}
+
+// Screens of the main window have screen->window = NULL
+static size_t __FindWindow(SDL_Window* window)
+{
+	if (window == NULL)
+	{
+		return 0;
+	}
+	for (size_t i = 0; i < VENG_MAX_WINDOWS; i++)
+	{
+		if (windows[i].driver.window == window)
+		{
+			return i;
+		}
+	}
+	return VENG_MAX_WINDOWS;
+}
+
+static void __UseWindow(size_t slot)
+{
+	if (slot == current_window || slot >= VENG_MAX_WINDOWS)
+	{
+		return;
+	}
+	VENG_PaintFlush(); // Batched primitives belong to the renderer they were painted for
+	current_window = slot;
+}
+
+// Its snapshot and layout belonged to the window it leaves
+static void __UnbindScreen(VENG_Screen* screen)
+{
+	size_t slot = __FindWindow(screen->window);
+	if (slot < VENG_MAX_WINDOWS && windows[slot].rendering_screen == screen)
+	{
+		windows[slot].rendering_screen = NULL;
+	}
+	VENG_FreePrewarm(screen);
+	screen->window = NULL;
+	screen->prepared_w = 0;
+	screen->prepared_h = 0;
+}
+
+int VENG_BindScreen(VENG_Screen* screen, VENG_Driver driver)
+{
+	if (!VENG_HasStarted())
+	{
+		printf("VENG is not initialized yet\n");
+		return 1;
+	}
+	if (screen == NULL || (driver.window == NULL) != (driver.renderer == NULL))
+	{
+		printf("Screen is NULL or driver is half empty\n");
+		return 1;
+	}
+	size_t slot = driver.window == NULL ? 0 : __FindWindow(driver.window);
+	if (slot == VENG_MAX_WINDOWS)
+	{
+		for (slot = 1; slot < VENG_MAX_WINDOWS && windows[slot].driver.window != NULL; slot++);
+		if (slot == VENG_MAX_WINDOWS)
+		{
+			printf("Too many windows, the maximum is %d\n", VENG_MAX_WINDOWS);
+			return 1;
+		}
+		windows[slot].driver = driver;
+		windows[slot].rendering_screen = NULL;
+	}
+	else if (driver.renderer != NULL && windows[slot].driver.renderer != driver.renderer)
+	{
+		printf("The window has another renderer\n");
+		return 1;
+	}
+	if (slot == __FindWindow(screen->window))
+	{
+		return 0;
+	}
+	__UnbindScreen(screen);
+	screen->window = slot == 0 ? NULL : driver.window;
+	return 0;
+}
+
+int VENG_RemoveWindow(SDL_Window* window)
+{
+	if (!VENG_HasStarted())
+	{
+		printf("VENG is not initialized yet\n");
+		return 1;
+	}
+	size_t slot = window != NULL ? __FindWindow(window) : 0;
+	if (slot == 0 || slot == VENG_MAX_WINDOWS)
+	{
+		printf("Window is the main one or isn't bound to any screen\n");
+		return 1;
+	}
+	__UseWindow(slot); // Flushes what was painted for it
+	for (size_t i = 0; i < screen_slots_size; i++)
+	{
+		if (screens[i] != NULL && screens[i]->window == window)
+		{
+			__UnbindScreen(screens[i]);
+		}
+	}
+	VENG_ForgetWindowText(slot);
+	__UseWindow(0);
+	windows[slot] = (VENG_Window){0};
+	return 0;
+}
+
+VENG_Screen* VENG_GetEventScreen(SDL_Event* event)
+{
+	if (!VENG_HasStarted())
+	{
+		printf("VENG is not initialized yet\n");
+		return NULL;
+	}
+	if (event == NULL)
+	{
+		printf("Event is NULL\n");
+		return NULL;
+	}
+	Uint32 id = __EventWindowID(event);
+	if (id == 0)
+	{
+		return windows[current_window].rendering_screen;
+	}
+	for (size_t i = 0; i < VENG_MAX_WINDOWS; i++)
+	{
+		if (windows[i].driver.window != NULL && SDL_GetWindowID(windows[i].driver.window) == id)
+		{
+			return windows[i].rendering_screen;
+		}
+	}
+	return NULL;
+}
+
+bool VENG_UseScreenWindow(VENG_Screen* screen)
+{
+	size_t slot = __FindWindow(screen->window);
+	__UseWindow(slot);
+	return slot < VENG_MAX_WINDOWS;
+}
+
+bool VENG_IsEventForScreen(SDL_Event* event, VENG_Screen* screen)
+{
+	Uint32 id = __EventWindowID(event);
+	size_t slot = __FindWindow(screen->window);
+	return id == 0 || slot == VENG_MAX_WINDOWS || SDL_GetWindowID(windows[slot].driver.window) == id;
+}
+
+bool VENG_IsMainWindow()
+{
+	return current_window == 0;
+}
+
+size_t VENG_GetWindowSlot()
+{
+	return current_window;
+}
+
+void VENG_UseWindowSlot(size_t slot)
+{
+	__UseWindow(slot);
+}
+
+// Recorded events carry the window ID and the ticks of the process that recorded them
+void VENG_AdoptEvent(SDL_Event* event, VENG_Screen* screen)
+{
+	Uint32* id = __EventWindowField(event);
+	size_t slot = __FindWindow(screen->window);
+	if (id != NULL && slot < VENG_MAX_WINDOWS)
+	{
+		*id = SDL_GetWindowID(windows[slot].driver.window);
+	}
+	event->common.timestamp = SDL_GetTicks();
+}
+
+/*==========================================================================*\
+ *                   				Drawing
+\*==========================================================================*/
+void VENG_Present()
+{
+	if (!VENG_HasStarted())
+	{
+		printf("VENG is not initialized yet\n");
+		return;
+	}
+	Uint64 start = VENG_LatencyBegin();
+	VENG_PaintFlush();
+	VENG_ResolveRaster();
+	VENG_StreamFrame();
+	VENG_ResolveScale();
+	SDL_RenderPresent(windows[current_window].driver.renderer);
+	VENG_LatencyPresent(start);
+	VENG_TraceFrame();
+	VENG_AdaptScale();
+	VENG_CollectSubtrees();
+}
+
+SDL_Rect VENG_StartDrawing(VENG_Element* element)
+{
+	if (!VENG_HasStarted())
+	{
+		printf("VENG is not initialized yet\n");
+		return (SDL_Rect){0};
+	}
+	if (element == NULL)
+	{
+		printf("Element is NULL\n");
+		return (SDL_Rect){-1, -1, -1, -1};
+	}
+	if (VENG_IsTracing())
+	{
+		// A paint span lasts until VENG_StopDrawing
+		if (drawing_element != NULL) VENG_TraceEnd();
+		VENG_TraceBegin("Paint", element);
+		drawing_element = element;
+	}
+	SDL_Rect clip = element->rect;
+	if (drawing_bounds != NULL && !SDL_IntersectRect(&element->rect, drawing_bounds, &clip))
+	{
+		clip = (SDL_Rect){drawing_bounds->x, drawing_bounds->y, 0, 0};
+	}
+	SDL_RenderSetClipRect(windows[current_window].driver.renderer, &clip);
+	return element->rect;
+}
+
+void VENG_StopDrawing(SDL_Rect* target)
+{
+	if (!VENG_HasStarted())
+	{
+		printf("VENG is not initialized yet\n");
+		return;
+	}
+	SDL_RenderSetClipRect(windows[current_window].driver.renderer, target == NULL ? drawing_bounds : target);
+	if (drawing_element != NULL)
+	{
+		VENG_TraceEnd();
+		drawing_element = NULL;
+	}
+}
+
+int VENG_SetPaintCallback(VENG_Element* element, VENG_PaintCallback paint)
+{
+	if (!VENG_HasStarted())
+	{
+		printf("VENG is not initialized yet\n");
+		return 1;
+	}
+	if (element == NULL)
+	{
+		printf("Element is NULL\n");
+		return 1;
+	}
+	element->paint = paint;
+	VENG_TouchContainer(element);
+	return 0;
+}
+
+static void __DrawElement(VENG_Element* element)
+{
+	if (element->paint != NULL)
+	{
+		VENG_StartDrawing(element);
+		element->paint(element, windows[current_window].driver.renderer);
+		VENG_StopDrawing(NULL);
+	}
+}
+
+static void __DrawChilds(VENG_Childs* childs)
+{
+	if (childs->sub_elements == NULL)
+	{
+		return;
+	}
+	for (size_t i = 0; i < childs->sub_elements_size; i++)
+	{
+		if (childs->sub_elements[i] != NULL)
+		{
+			VENG_DrawElement(childs->sub_elements[i]);
+		}
+	}
+}
+
+// Paints an element and its sub-elements
+void VENG_DrawElement(VENG_Element* element)
+{
+	if (!element->visible)
+	{
+		return;
+	}
+	if (drawing_bounds != NULL && !SDL_HasIntersection(&element->rect, drawing_bounds))
+	{
+		return;
+	}
+	if (element->scroll != NULL)
+	{
+		VENG_DrawScroll(element);
+		return;
+	}
+	__DrawElement(element);
+	// Sub-elements are painted over their parent
+	__DrawChilds(&element->childs);
+}
+
+// Paints an element and its sub-elements again, clipped to a region
+void VENG_DrawRegion(VENG_Element* element, SDL_Rect region)
+{
+	SDL_Rect* previous = drawing_bounds;
+	drawing_bounds = &region;
+	SDL_RenderSetClipRect(windows[current_window].driver.renderer, drawing_bounds);
+	__DrawElement(element);
+	__DrawChilds(&element->childs);
+	drawing_bounds = previous;
+	SDL_RenderSetClipRect(windows[current_window].driver.renderer, drawing_bounds);
+}
+
+int VENG_DrawLayer(VENG_Layer* layer)
+{
+	if (!VENG_HasStarted())
+	{
+		printf("VENG is not initialized yet\n");
+		return 1;
+	}
+	if (layer == NULL)
+	{
+		printf("Layer is NULL\n");
+		return 1;
+	}
+	VENG_StartScaleFrame();
+	Uint64 start = VENG_LatencyBegin();
+	__DrawChilds(&layer->childs);
+	VENG_PaintFlush();
+	VENG_LatencyEnd(VENG_LATENCY_PAINT, start);
+	return 0;
+}
+
+int VENG_DrawScreen(VENG_Screen* screen)
+{
+	if (!VENG_HasStarted())
+	{
+		printf("VENG is not initialized yet\n");
+		return 1;
+	}
+	if (screen == NULL)
+	{
+		printf("Screen is NULL\n");
+		return 1;
+	}
+	if (screen->layers == NULL)
+	{
+		return 0;
+	}
+	VENG_StartScaleFrame();
+	VENG_UseScreenWindow(screen);
+	if (VENG_DrawSnapshot(screen))
+	{
+		// First frame after VENG_SetScreen, painted ahead by VENG_PrewarmScreen
+		return 0;
+	}
+	Uint64 start = VENG_LatencyBegin();
+	for (size_t i = __GetLowestLayer(screen, VENG_LAYER_OPAQUE); i < screen->layers_size; i++)
 	{
 		if (screen->layers[i] != NULL)
 		{
-			VENG_PrepareLayer(screen->layers[i]);
+			__DrawChilds(&screen->layers[i]->childs);
 		}
 	}
+	VENG_PaintFlush();
+	VENG_LatencyEnd(VENG_LATENCY_PAINT, start);
 	return 0;
 }
 
-int VENG_PrepareLayer(VENG_Layer* layer)
+/*==========================================================================*\
+ *                   			 Optimization
+\*==========================================================================*/
+// An Element should be flagged as dirty if:
+//	- The screen dimentions got modified
+//	- The element 
+//	-
+
+// Every layer has a generation, bumped whenever its layout or look may have changed.
+// A screen generation (its own plus the sum of its layers', which only grow) tells if
+// the layout and the snapshot of a hidden screen are still valid.
+void VENG_TouchContainer(void* container)
 {
-	if (!VENG_HasStarted())
+	VENG_LatencyEffect();
+	while (container != NULL && ((VENG_Layer*)container)->type == VENG_TYPE_ELEMENT)
 	{
-		printf("VENG is not initialized yet\n");
+		container = ((VENG_Element*)container)->parent;
+	}
+	if (container != NULL)
+	{
+		((VENG_Layer*)container)->generation++;
+	}
+}
+
+Uint32 VENG_GetScreenGeneration(VENG_Screen* screen)
+{
+	Uint32 generation = screen->generation;
+	for (size_t i = 0; screen->layers != NULL && i < screen->layers_size; i++)
+	{
+		if (screen->layers[i] != NULL)
+		{
+			generation += screen->layers[i]->generation;
+		}
+	}
+	return generation;
+}
+
+void VENG_SetScreenPrepared(VENG_Screen* screen)
+{
+	VENG_GetLogicalSize(&screen->prepared_w, &screen->prepared_h);
+	screen->prepared_generation = VENG_GetScreenGeneration(screen);
+}
+
+bool VENG_IsScreenPrepared(VENG_Screen* screen)
+{
+	if (screen == NULL || screen->prepared_w == 0)
+	{
+		return false;
+	}
+	int w, h;
+	VENG_GetLogicalSize(&w, &h);
+	return w == screen->prepared_w && h == screen->prepared_h && screen->prepared_generation == VENG_GetScreenGeneration(screen);
+}
+
+/*==========================================================================*\
+ *                   				Memory
+\*==========================================================================*/
+// Every VENG allocation goes through VENG_Alloc/VENG_Realloc/VENG_Free, which
+// forward to the user allocator and keep the memory stats up to date.
+#define VENG_ALIGNMENT _Alignof(max_align_t)
+
+static void* __DefaultAlloc(size_t size, size_t alignment, void* context)
+{
+	if (alignment <= VENG_ALIGNMENT)
+	{
+		return malloc(size);
+	}
+	return aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+}
+
+static void* __DefaultRealloc(void* ptr, size_t old_size, size_t new_size, size_t alignment, void* context)
+{
+	if (alignment <= VENG_ALIGNMENT)
+	{
+		return realloc(ptr, new_size);
+	}
+	void* new_ptr = __DefaultAlloc(new_size, alignment, context);
+	if (new_ptr != NULL && ptr != NULL)
+	{
+		memcpy(new_ptr, ptr, old_size < new_size ? old_size : new_size);
+		free(ptr);
+	}
+	return new_ptr;
+}
+
+static void __DefaultFree(void* ptr, size_t size, void* context)
+{
+	free(ptr);
+}
+
+int VENG_SetAllocator(VENG_Allocator new_allocator)
+{
+	if (VENG_HasStarted())
+	{
+		printf("The allocator must be set before VENG_Init\n");
 		return 1;
 	}
-	if (layer == NULL)
+	if (new_allocator.alloc == NULL && new_allocator.realloc == NULL && new_allocator.free == NULL)
 	{
-		printf("Layer is NULL");
+		allocator = (VENG_Allocator){__DefaultAlloc, __DefaultRealloc, __DefaultFree, NULL};
+		return 0;
+	}
+	if (new_allocator.alloc == NULL || new_allocator.realloc == NULL || new_allocator.free == NULL)
+	{
+		printf("Allocator callbacks cannot be NULL\n");
 		return 1;
 	}
-	int window_w, window_h;
-	SDL_GetRendererOutputSize(driver.renderer, &window_w, &window_h);
-	VENG_PrepareElements(layer, (SDL_Rect){0, 0, window_w, window_h});
+	allocator = new_allocator;
 	return 0;
 }
 
-void VENG_PrepareElements(void* parent_container, SDL_Rect drawing_rect)
+void* VENG_Alloc(VENG_MemoryCategory category, size_t count, size_t size)
 {
-	if (!VENG_HasStarted())
+	if (count == 0 || size == 0 || count > SIZE_MAX / size)
 	{
-		printf("VENG is not initialized yet\n");
-		return;
+		return NULL;
 	}
-	// (I) Compute every child's size
-	// (II) Once computed, align every child
-	// (III) Check if the childs have more childs
-	
-	// void* parent_container -----> layout & childs
-
-	if (parent_container == NULL)
+	void* ptr = allocator.alloc(count * size, VENG_ALIGNMENT, allocator.context);
+	if (ptr == NULL)
 	{
-		return;
+		return NULL;
 	}
+	memset(ptr, 0, count * size);
+	VENG_TrackMemory(category, count * size, 1);
+	return ptr;
+}
 
-	VENG_Layout* layout = NULL;
-	VENG_Childs* childs = NULL;
+void* VENG_Realloc(VENG_MemoryCategory category, void* ptr, size_t old_count, size_t new_count, size_t size)
+{
+	if (ptr == NULL)
 	{
-		VENG_Layer* data = (VENG_Layer*)parent_container;
-		VENG_ParentType type = data->type;
-		if (type == VENG_TYPE_LAYER)
-		{
-			layout = &data->layout;
-			childs = &data->childs;
-		}
-		else if (type == VENG_TYPE_ELEMENT)
-		{
-			VENG_Element* element = (VENG_Element*)parent_container;
-			layout = &element->layout;
-			childs = &element->childs;
-		}
-		else
-		{
-			printf("Invalid Parent_Container\n");
-			return;
-		}
+		return VENG_Alloc(category, new_count, size);
+	}
+	if (new_count == 0 || size == 0 || new_count > SIZE_MAX / size)
+	{
+		return NULL;
+	}
+	void* new_ptr = allocator.realloc(ptr, old_count * size, new_count * size, VENG_ALIGNMENT, allocator.context);
+	if (new_ptr == NULL)
+	{
+		return NULL;
 	}
+	VENG_TrackMemory(category, (long)(new_count * size) - (long)(old_count * size), 0);
+	return new_ptr;
+}
 
-	if (layout == NULL || childs == NULL)
+void VENG_Free(VENG_MemoryCategory category, void* ptr, size_t count, size_t size)
+{
+	if (ptr == NULL)
 	{
 		return;
 	}
+	allocator.free(ptr, count * size, allocator.context);
+	VENG_TrackMemory(category, -(long)(count * size), -1);
+}
 
-	if (childs->sub_elements == NULL || childs->sub_elements_size == 0 || childs->sub_elements_count == 0)
+// Byte and object counters are kept up to date at every allocation site, so
+// the global stats and high-water marks are O(1) to read. Slack is computed on
+// demand by walking the slot tables, and per screen/layer stats by walking
+// their hierarchy.
+void VENG_TrackMemory(VENG_MemoryCategory category, long bytes, long objects)
+{
+	if (category >= VENG_MEMORY_CATEGORIES)
 	{
 		return;
 	}
+	VENG_MemoryUsage* usage = &memory_stats.categories[category];
+	usage->bytes += bytes;
+	usage->objects += objects;
+	memory_stats.total_bytes += bytes;
+	if (usage->bytes > usage->peak_bytes)
+	{
+		usage->peak_bytes = usage->bytes;
+	}
+	if (memory_stats.total_bytes > memory_stats.peak_total_bytes)
+	{
+		memory_stats.peak_total_bytes = memory_stats.total_bytes;
+	}
+}
 
-	// (I)
-	float screen_ratio = (float)drawing_rect.w / drawing_rect.h;
-	for (size_t i = 0; i < childs->sub_elements_size; i++)
+static size_t __ChildsSlack(VENG_Childs* childs)
+{
+	if (childs->sub_elements == NULL)
 	{
-		if (childs->sub_elements[i] != NULL)
+		return 0;
+	}
+	return (childs->sub_elements_size - childs->sub_elements_count) * sizeof(VENG_Element*);
+}
+
+int VENG_GetMemoryStats(VENG_MemoryStats* stats)
+{
+	if (!VENG_HasStarted())
+	{
+		printf("VENG is not initialized yet\n");
+		return 1;
+	}
+	if (stats == NULL)
+	{
+		printf("Stats is NULL\n");
+		return 1;
+	}
+	*stats = memory_stats;
+	for (size_t i = 0; i < VENG_MEMORY_CATEGORIES; i++)
+	{
+		stats->categories[i].slack_bytes = 0;
+	}
+
+	stats->categories[VENG_MEMORY_SCREENS].slack_bytes = (screen_slots_size - screen_slots_count) * sizeof(VENG_Screen*);
+	stats->categories[VENG_MEMORY_LAYERS].slack_bytes = (layer_slots_size - layer_slots_count) * sizeof(VENG_Layer*);
+	stats->categories[VENG_MEMORY_ELEMENTS].slack_bytes = (elements_slots_size - elements_slots_count) * sizeof(VENG_Element*);
+	for (size_t i = 0; i < screen_slots_size; i++)
+	{
+		if (screens[i] != NULL && screens[i]->layers != NULL)
 		{
-			if (!childs->sub_elements[i]->visible)
-			{
-				childs->sub_elements[i]->rect = (SDL_Rect){-1, -1, -1, -1};
-				continue;
-			}
-			if (childs->sub_elements[i]->stretch_size)
-			{
-				childs->sub_elements[i]->rect.w = round(childs->sub_elements[i]->w * drawing_rect.w);
-				childs->sub_elements[i]->rect.h = round(childs->sub_elements[i]->h * drawing_rect.h);
-			}
-			else
-			{
-				if (screen_ratio >= 1.0f)	
-				{
-					childs->sub_elements[i]->rect.w = round(childs->sub_elements[i]->w * drawing_rect.h);
-					childs->sub_elements[i]->rect.h = round(childs->sub_elements[i]->h * drawing_rect.h);
-				}
-				else
-				{
-					childs->sub_elements[i]->rect.w = round(childs->sub_elements[i]->w * drawing_rect.w);
-					childs->sub_elements[i]->rect.h = round(childs->sub_elements[i]->h * drawing_rect.w);
-				}
-			}
+			stats->categories[VENG_MEMORY_CHILDS].slack_bytes += (screens[i]->layers_size - screens[i]->layers_count) * sizeof(VENG_Layer*);
 		}
-	} 
-
-	// (II)
-	SDL_Point offset = (SDL_Point){0, 0};
-	SDL_Point current_center = (SDL_Point){0, 0};
-	if (layout->align_horizontal == VENG_CENTER)
+	}
+	for (size_t i = 0; i < layer_slots_size; i++)
 	{
-		for (size_t i = 0; i < childs->sub_elements_size; i++)
+		if (layers[i] != NULL)
 		{
-			if (childs->sub_elements[i] != NULL)
-			{
-				current_center.x += childs->sub_elements[i]->rect.w;
-			}
+			stats->categories[VENG_MEMORY_CHILDS].slack_bytes += __ChildsSlack(&layers[i]->childs);
 		}
-		current_center.x = round((drawing_rect.w - current_center.x) / 2);
 	}
-	if (layout->align_vertical == VENG_CENTER)
+	for (size_t i = 0; i < elements_slots_size; i++)
 	{
-		for (size_t i = 0; i < childs->sub_elements_size; i++)
+		if (elements[i] != NULL)
 		{
-			if (childs->sub_elements[i] != NULL)
-			{
-				current_center.y += childs->sub_elements[i]->rect.h;
-			}
+			stats->categories[VENG_MEMORY_CHILDS].slack_bytes += __ChildsSlack(&elements[i]->childs);
 		}
-		current_center.y = round((drawing_rect.h - current_center.y) / 2);
 	}
-	if (layout->arrangement == VENG_HORIZONTAL)
+	stats->categories[VENG_MEMORY_LISTENERS].slack_bytes = VENG_GetListenersSlack();
+
+	stats->total_slack_bytes = 0;
+	for (size_t i = 0; i < VENG_MEMORY_CATEGORIES; i++)
 	{
-		for (size_t i = 0; i < childs->sub_elements_size; i++)
+		stats->total_slack_bytes += stats->categories[i].slack_bytes;
+	}
+	return 0;
+}
+
+static void __AddUsage(VENG_MemoryStats* stats, VENG_MemoryCategory category, size_t bytes, size_t slack_bytes)
+{
+	stats->categories[category].bytes += bytes;
+	stats->categories[category].peak_bytes += bytes;
+	stats->categories[category].objects++;
+	stats->categories[category].slack_bytes += slack_bytes;
+	stats->total_bytes += bytes;
+	stats->peak_total_bytes += bytes;
+	stats->total_slack_bytes += slack_bytes;
+}
+
+static void __AddElementUsage(VENG_MemoryStats* stats, VENG_Element* element)
+{
+	__AddUsage(stats, VENG_MEMORY_ELEMENTS, sizeof(VENG_Element), 0);
+	if (element->childs.sub_elements == NULL)
+	{
+		return;
+	}
+	__AddUsage(stats, VENG_MEMORY_CHILDS, element->childs.sub_elements_size * sizeof(VENG_Element*), __ChildsSlack(&element->childs));
+	for (size_t i = 0; i < element->childs.sub_elements_size; i++)
+	{
+		if (element->childs.sub_elements[i] != NULL)
+		{
+			__AddElementUsage(stats, element->childs.sub_elements[i]);
+		}
+	}
+}
+
+static void __AddLayerUsage(VENG_MemoryStats* stats, VENG_Layer* layer)
+{
+	__AddUsage(stats, VENG_MEMORY_LAYERS, sizeof(VENG_Layer), 0);
+	if (layer->childs.sub_elements != NULL)
+	{
+		__AddUsage(stats, VENG_MEMORY_CHILDS, layer->childs.sub_elements_size * sizeof(VENG_Element*), __ChildsSlack(&layer->childs));
+		for (size_t i = 0; i < layer->childs.sub_elements_size; i++)
 		{
-			if (childs->sub_elements[i] != NULL)
+			if (layer->childs.sub_elements[i] != NULL)
 			{
-				switch (layout->align_horizontal)
-				{
-					case VENG_LEFT:
-						childs->sub_elements[i]->rect.x = drawing_rect.x + offset.x;
-						break;
-					case VENG_CENTER:
-						childs->sub_elements[i]->rect.x = drawing_rect.x + current_center.x;
-						current_center.x += childs->sub_elements[i]->rect.w;
-						break;
-					case VENG_RIGHT:
-						childs->sub_elements[i]->rect.x = drawing_rect.x + drawing_rect.w - childs->sub_elements[i]->rect.w - offset.x;
-						break;
-					default:
-						printf("Invalid align_h argument.\n");
-						return;
-				}
-				switch (layout->align_vertical)
-				{
-					case VENG_TOP:
-						childs->sub_elements[i]->rect.y = drawing_rect.y;
-						break;
-					case VENG_CENTER:
-						childs->sub_elements[i]->rect.y = drawing_rect.y + round((drawing_rect.h - childs->sub_elements[i]->rect.h)/2); 
-						break;
-					case VENG_BOTTOM:
-						childs->sub_elements[i]->rect.y = drawing_rect.y + drawing_rect.h - childs->sub_elements[i]->rect.h;
-						break;
-					default:
-						printf("Invalid align_v argument.\n");
-						return;
-				}
-				offset.x += childs->sub_elements[i]->rect.w;
-				// (III)
-				VENG_PrepareElements(childs->sub_elements[i], childs->sub_elements[i]->rect);
+				__AddElementUsage(stats, layer->childs.sub_elements[i]);
 			}
 		}
 	}
-	else if (layout->arrangement == VENG_VERTICAL)
+	if (layer->listeners != NULL)
 	{
-		for (size_t i = 0; i < childs->sub_elements_size; i++)
+		__AddUsage(stats, VENG_MEMORY_LISTENERS, sizeof(VENG_Listeners), 0);
+		if (layer->listeners->listeners != NULL)
 		{
-			if (childs->sub_elements[i] != NULL)
+			__AddUsage(stats, VENG_MEMORY_LISTENERS, layer->listeners->listeners_size * sizeof(VENG_Listener*),
+					   (layer->listeners->listeners_size - layer->listeners->listeners_count) * sizeof(VENG_Listener*));
+			for (size_t i = 0; i < layer->listeners->listeners_count; i++)
 			{
-				switch (layout->align_horizontal)
-				{
-					case VENG_LEFT:
-						childs->sub_elements[i]->rect.x = drawing_rect.x;
-						break;
-					case VENG_CENTER:
-						childs->sub_elements[i]->rect.x = drawing_rect.x + round((drawing_rect.w - childs->sub_elements[i]->rect.w)/2);
-						break;
-					case VENG_RIGHT:
-						childs->sub_elements[i]->rect.x = drawing_rect.x + drawing_rect.w - childs->sub_elements[i]->rect.w;
-						break;
-					default:
-						printf("Invalid align_h argument.\n");
-						return;
-				}
-				switch (layout->align_vertical)
-				{
-					case VENG_TOP:
-						childs->sub_elements[i]->rect.y = drawing_rect.y + offset.y;
-						break;
-					case VENG_CENTER:
-						childs->sub_elements[i]->rect.y = drawing_rect.y + current_center.y;
-						current_center.y += childs->sub_elements[i]->rect.h;
-						break;
-					case VENG_BOTTOM:
-						childs->sub_elements[i]->rect.y = drawing_rect.y + drawing_rect.h - childs->sub_elements[i]->rect.h - offset.y;
-						break;
-					default:
-						printf("Invalid align_v argument.\n");
-						return;
-				}
-				offset.y += childs->sub_elements[i]->rect.h;
-				// (III)
-				VENG_PrepareElements(childs->sub_elements[i], childs->sub_elements[i]->rect);
+				__AddUsage(stats, VENG_MEMORY_LISTENERS, sizeof(VENG_Listener), 0);
 			}
 		}
 	}
 }
 
-/*==========================================================================*\
- *                   				Drawing
-\*==========================================================================*/
-SDL_Rect VENG_StartDrawing(VENG_Element* element)
+// Per layer stats: peak_bytes mirrors bytes, as a snapshot has no history.
+int VENG_GetLayerMemoryStats(VENG_Layer* layer, VENG_MemoryStats* stats)
 {
 	if (!VENG_HasStarted())
 	{
 		printf("VENG is not initialized yet\n");
-		return (SDL_Rect){0};
+		return 1;
 	}
-	if (element == NULL)
+	if (layer == NULL || stats == NULL)
 	{
-		printf("Element is NULL\n");
-		return (SDL_Rect){-1, -1, -1, -1};
+		printf("Layer or stats cannot be NULL\n");
+		return 1;
 	}
-	SDL_RenderSetClipRect(driver.renderer, &element->rect);
-	return element->rect;
+	*stats = (VENG_MemoryStats){0};
+	__AddLayerUsage(stats, layer);
+	return 0;
 }
 
-void VENG_StopDrawing(SDL_Rect* target)
+// Per screen stats: peak_bytes mirrors bytes, as a snapshot has no history.
+int VENG_GetScreenMemoryStats(VENG_Screen* screen, VENG_MemoryStats* stats)
 {
 	if (!VENG_HasStarted())
 	{
 		printf("VENG is not initialized yet\n");
-		return;
+		return 1;
+	}
+	if (screen == NULL || stats == NULL)
+	{
+		printf("Screen or stats cannot be NULL\n");
+		return 1;
+	}
+	*stats = (VENG_MemoryStats){0};
+	__AddUsage(stats, VENG_MEMORY_SCREENS, sizeof(VENG_Screen), 0);
+	if (screen->layers == NULL)
+	{
+		return 0;
+	}
+	__AddUsage(stats, VENG_MEMORY_CHILDS, screen->layers_size * sizeof(VENG_Layer*), (screen->layers_size - screen->layers_count) * sizeof(VENG_Layer*));
+	for (size_t i = 0; i < screen->layers_size; i++)
+	{
+		if (screen->layers[i] != NULL)
+		{
+			__AddLayerUsage(stats, screen->layers[i]);
+		}
 	}
-	SDL_RenderSetClipRect(driver.renderer, target);
+	return 0;
 }
 
-/*==========================================================================*\
- *                   			 Optimization
-\*==========================================================================*/
-// An Element should be flagged as dirty if:
-//	- The screen dimentions got modified
-//	- The element 
-//	-
-
 /*==========================================================================*\
  *                   				Debug
 \*==========================================================================*/
@@ -727,7 +2364,14 @@ bool VENG_HasStarted()
 
 void VENG_PrintInternalHierarchy()
 {
-	printf("VENG: started:%db ; Driver: {w:%p r:%p} ; RenderingScreen: %p\n", started, driver.window, driver.renderer, rendering_screen);
+	printf("VENG: started:%db ; Driver: {w:%p r:%p} ; RenderingScreen: %p\n", started, windows[0].driver.window, windows[0].driver.renderer, windows[0].rendering_screen);
+	for (size_t i = 1; i < VENG_MAX_WINDOWS; i++)
+	{
+		if (windows[i].driver.window != NULL)
+		{
+			printf("\tWindow %ld: {w:%p r:%p} ; RenderingScreen: %p\n", i, windows[i].driver.window, windows[i].driver.renderer, windows[i].rendering_screen);
+		}
+	}
 	printf("Screens: used: %ld ; total: %ld\n", screen_slots_count, screen_slots_size);
 	for (size_t i = 0; i < screen_slots_size; i++)
 	{
@@ -745,6 +2389,22 @@ void VENG_PrintInternalHierarchy()
 	}
 }
 
+void VENG_PrintMemoryStats(VENG_MemoryStats* stats)
+{
+	static const char* names[VENG_MEMORY_CATEGORIES] = {"Screens", "Layers", "Elements", "Childs", "Listeners", "Textures", "Diagnostics"};
+	if (stats == NULL)
+	{
+		printf("Stats is NULL\n");
+		return;
+	}
+	printf("Memory: total: %zu B ; peak: %zu B ; slack: %zu B\n", stats->total_bytes, stats->peak_total_bytes, stats->total_slack_bytes);
+	for (size_t i = 0; i < VENG_MEMORY_CATEGORIES; i++)
+	{
+		printf("\t%s: bytes: %zu ; objects: %zu ; peak: %zu ; slack: %zu\n", names[i], stats->categories[i].bytes,
+				stats->categories[i].objects, stats->categories[i].peak_bytes, stats->categories[i].slack_bytes);
+	}
+}
+
 static int __PrintElementHierarchy (VENG_Element* element, size_t tabs);
 int VENG_PrintScreenHierarchy(VENG_Screen* screen)
 {
@@ -808,16 +2468,6 @@ int __PrintElementHierarchy (VENG_Element* element, size_t tabs)
 	return 0;
 }
 
-static void* IS_NULL(void *ptr) 
-{
-    if (!ptr) 
-    {
-        printf("Pointer %p is NULL\n", ptr);
-        exit(EXIT_FAILURE);
-    }
-    return ptr;
-
-}
 
 
 
@@ -0,0 +1,493 @@
+#include <SDL2/SDL.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <math.h>
+
+#include "VENG/VENG.h"
+
+// Anchored layout:
+// (I)   A constraint sets an attribute of an element to (attribute of a sibling or of the
+//       container) * multiplier + constant. Every attribute has at most one constraint and
+//       cycles are refused, so the constraints of a container form a DAG.
+// (II)  The childs are kept in topological order, it's only sorted again when a constraint
+//       is added or removed or a child is added, never on a resize or a constant change.
+// (III) Solving walks that order and only computes the dirty childs: the ones whose
+//       constraint, w/h or visibility changed, the ones using the container when its rect
+//       changed, and the dependents of every child whose rect actually changed.
+
+#define DEPENDENTS_START 4
+
+typedef struct VENG_Constraint
+{
+	bool set;
+	VENG_Element* source; // NULL = the container
+	VENG_Attribute source_attribute;
+	float multiplier;
+	int constant;
+} VENG_Constraint;
+
+struct VENG_Anchor
+{
+	VENG_Constraint constraints[VENG_ATTRIBUTES];
+
+	VENG_Element** dependents; // One entry per constraint using this element as source
+	size_t dependents_size;
+	size_t dependents_count;
+
+	bool dirty;
+	bool uses_container; // A constraint or a default (size, position) depends on the container
+	size_t pending;      // Sources not sorted yet (topological sort)
+	Uint32 visit;        // Cycle search stamp
+
+	// Inputs of the last solve
+	float w, h;
+	bool stretch_size;
+	bool visible;
+};
+
+struct VENG_Anchors
+{
+	VENG_Element** order; // Topological order of the childs
+	size_t order_size;
+	size_t order_count;
+	SDL_Rect rect; // Container rect of the last solve
+	bool sort;
+};
+
+static Uint32 visit_stamp = 0;
+
+static VENG_Anchor* __GetAnchor(VENG_Element* element)
+{
+	if (element->anchor == NULL)
+	{
+		element->anchor = VENG_Alloc(VENG_MEMORY_ELEMENTS, 1, sizeof(VENG_Anchor));
+		if (element->anchor == NULL)
+		{
+			printf("Couldn't allocate Anchor\n");
+			return NULL;
+		}
+		element->anchor->dirty = true;
+		element->anchor->uses_container = true;
+	}
+	return element->anchor;
+}
+
+static VENG_Childs* __ParentChilds(VENG_Element* element)
+{
+	if (element->parent == NULL)
+	{
+		return NULL;
+	}
+	if (((VENG_Layer*)element->parent)->type == VENG_TYPE_LAYER)
+	{
+		return &((VENG_Layer*)element->parent)->childs;
+	}
+	return &((VENG_Element*)element->parent)->childs;
+}
+
+// The order of the container has to be sorted again
+static void __Resort(VENG_Element* element)
+{
+	VENG_Childs* childs = __ParentChilds(element);
+	if (childs != NULL && childs->anchors != NULL)
+	{
+		childs->anchors->sort = true;
+	}
+}
+
+static void __UpdateUsesContainer(VENG_Anchor* anchor)
+{
+	VENG_Constraint* c = anchor->constraints;
+	anchor->uses_container = false;
+	for (int i = 0; i < VENG_ATTRIBUTES; i++)
+	{
+		if (c[i].set && c[i].source == NULL)
+		{
+			anchor->uses_container = true;
+		}
+	}
+	// Defaults: the size follows the container unless the axis has the size or two of its
+	// edges/center, the position follows it unless the axis has an edge or the center
+	bool left = c[VENG_ATTRIBUTE_LEFT].set, right = c[VENG_ATTRIBUTE_RIGHT].set, center_x = c[VENG_ATTRIBUTE_CENTER_X].set;
+	bool top = c[VENG_ATTRIBUTE_TOP].set, bottom = c[VENG_ATTRIBUTE_BOTTOM].set, center_y = c[VENG_ATTRIBUTE_CENTER_Y].set;
+	if ((!c[VENG_ATTRIBUTE_WIDTH].set && left + right + center_x < 2) || (!c[VENG_ATTRIBUTE_HEIGHT].set && top + bottom + center_y < 2) ||
+		!(left || right || center_x) || !(top || bottom || center_y))
+	{
+		anchor->uses_container = true;
+	}
+}
+
+static int __AddDependent(VENG_Anchor* anchor, VENG_Element* dependent)
+{
+	if (anchor->dependents_count >= anchor->dependents_size)
+	{
+		size_t size = anchor->dependents_size == 0 ? DEPENDENTS_START : anchor->dependents_size * 2;
+		VENG_Element** dependents = VENG_Realloc(VENG_MEMORY_ELEMENTS, anchor->dependents, anchor->dependents_size, size, sizeof(VENG_Element*));
+		if (dependents == NULL)
+		{
+			printf("Couldn't allocate Anchor dependents\n");
+			return 1;
+		}
+		anchor->dependents = dependents;
+		anchor->dependents_size = size;
+	}
+	anchor->dependents[anchor->dependents_count++] = dependent;
+	return 0;
+}
+
+static void __RemoveDependent(VENG_Anchor* anchor, VENG_Element* dependent)
+{
+	for (size_t i = 0; i < anchor->dependents_count; i++)
+	{
+		if (anchor->dependents[i] == dependent)
+		{
+			anchor->dependents[i] = anchor->dependents[--anchor->dependents_count];
+			return;
+		}
+	}
+}
+
+// Whether target can be reached from element following the dependents
+static bool __Reaches(VENG_Element* element, VENG_Element* target)
+{
+	if (element == target)
+	{
+		return true;
+	}
+	if (element->anchor == NULL || element->anchor->visit == visit_stamp)
+	{
+		return false;
+	}
+	element->anchor->visit = visit_stamp;
+	for (size_t i = 0; i < element->anchor->dependents_count; i++)
+	{
+		if (__Reaches(element->anchor->dependents[i], target))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+static int __Value(SDL_Rect rect, VENG_Attribute attribute)
+{
+	switch (attribute)
+	{
+		case VENG_ATTRIBUTE_LEFT: return rect.x;
+		case VENG_ATTRIBUTE_TOP: return rect.y;
+		case VENG_ATTRIBUTE_RIGHT: return rect.x + rect.w;
+		case VENG_ATTRIBUTE_BOTTOM: return rect.y + rect.h;
+		case VENG_ATTRIBUTE_WIDTH: return rect.w;
+		case VENG_ATTRIBUTE_HEIGHT: return rect.h;
+		case VENG_ATTRIBUTE_CENTER_X: return rect.x + rect.w / 2;
+		case VENG_ATTRIBUTE_CENTER_Y: return rect.y + rect.h / 2;
+		default: return 0;
+	}
+}
+
+/*==========================================================================*\
+ *                   			 Constraints
+\*==========================================================================*/
+int VENG_AddConstraint(VENG_Element* element, VENG_Attribute attribute, VENG_Element* source, VENG_Attribute source_attribute, float multiplier, int constant)
+{
+	if (!VENG_HasStarted())
+	{
+		printf("VENG is not initialized yet\n");
+		return 1;
+	}
+	if (element == NULL)
+	{
+		printf("Element is NULL\n");
+		return 1;
+	}
+	if (attribute < 0 || attribute >= VENG_ATTRIBUTES || source_attribute < 0 || source_attribute >= VENG_ATTRIBUTES)
+	{
+		printf("Invalid attribute\n");
+		return 1;
+	}
+	if (element->parent == NULL || (source != NULL && source->parent != element->parent) || source == element)
+	{
+		printf("Constraints can only use a sibling or the container\n");
+		return 1;
+	}
+	VENG_Anchor* anchor = __GetAnchor(element);
+	if (anchor == NULL || (source != NULL && __GetAnchor(source) == NULL))
+	{
+		return 1;
+	}
+	VENG_Constraint* constraint = &anchor->constraints[attribute];
+	if (source != NULL && (!constraint->set || constraint->source != source))
+	{
+		visit_stamp++;
+		if (__Reaches(element, source))
+		{
+			printf("Constraint would make a cycle\n");
+			return 1;
+		}
+		if (__AddDependent(source->anchor, element) != 0)
+		{
+			return 1;
+		}
+	}
+	if (constraint->set && constraint->source != NULL && constraint->source != source)
+	{
+		__RemoveDependent(constraint->source->anchor, element);
+	}
+	*constraint = (VENG_Constraint){true, source, source_attribute, multiplier, constant};
+	__UpdateUsesContainer(anchor);
+	anchor->dirty = true;
+	__Resort(element);
+	VENG_TouchContainer(element);
+	return 0;
+}
+
+int VENG_SetConstraintConstant(VENG_Element* element, VENG_Attribute attribute, int constant)
+{
+	if (!VENG_HasStarted())
+	{
+		printf("VENG is not initialized yet\n");
+		return 1;
+	}
+	if (element == NULL || element->anchor == NULL || attribute < 0 || attribute >= VENG_ATTRIBUTES || !element->anchor->constraints[attribute].set)
+	{
+		printf("Element has no such constraint\n");
+		return 1;
+	}
+	// Same graph, only this element and what depends on it is solved again
+	element->anchor->constraints[attribute].constant = constant;
+	element->anchor->dirty = true;
+	VENG_TouchContainer(element);
+	return 0;
+}
+
+int VENG_RemoveConstraint(VENG_Element* element, VENG_Attribute attribute)
+{
+	if (!VENG_HasStarted())
+	{
+		printf("VENG is not initialized yet\n");
+		return 1;
+	}
+	if (element == NULL || element->anchor == NULL || attribute < 0 || attribute >= VENG_ATTRIBUTES || !element->anchor->constraints[attribute].set)
+	{
+		printf("Element has no such constraint\n");
+		return 1;
+	}
+	VENG_Constraint* constraint = &element->anchor->constraints[attribute];
+	if (constraint->source != NULL)
+	{
+		__RemoveDependent(constraint->source->anchor, element);
+	}
+	constraint->set = false;
+	__UpdateUsesContainer(element->anchor);
+	element->anchor->dirty = true;
+	__Resort(element);
+	VENG_TouchContainer(element);
+	return 0;
+}
+
+/*==========================================================================*\
+ *                   			Internal usage
+\*==========================================================================*/
+// Kahn's algorithm over the childs, sources before their dependents
+static int __Sort(VENG_Childs* childs, VENG_Anchors* anchors)
+{
+	if (anchors->order_size < childs->sub_elements_size)
+	{
+		VENG_Element** order = VENG_Realloc(VENG_MEMORY_CHILDS, anchors->order, anchors->order_size, childs->sub_elements_size, sizeof(VENG_Element*));
+		if (order == NULL)
+		{
+			printf("Couldn't allocate Anchor order\n");
+			return 1;
+		}
+		anchors->order = order;
+		anchors->order_size = childs->sub_elements_size;
+	}
+	size_t count = 0;
+	for (size_t i = 0; i < childs->sub_elements_size; i++)
+	{
+		VENG_Element* element = childs->sub_elements[i];
+		if (element == NULL)
+		{
+			continue;
+		}
+		if (__GetAnchor(element) == NULL)
+		{
+			return 1;
+		}
+		element->anchor->pending = 0;
+		for (int k = 0; k < VENG_ATTRIBUTES; k++)
+		{
+			if (element->anchor->constraints[k].set && element->anchor->constraints[k].source != NULL)
+			{
+				element->anchor->pending++;
+			}
+		}
+		if (element->anchor->pending == 0)
+		{
+			anchors->order[count++] = element;
+		}
+	}
+	for (size_t i = 0; i < count; i++)
+	{
+		VENG_Anchor* anchor = anchors->order[i]->anchor;
+		for (size_t k = 0; k < anchor->dependents_count; k++)
+		{
+			if (--anchor->dependents[k]->anchor->pending == 0)
+			{
+				anchors->order[count++] = anchor->dependents[k];
+			}
+		}
+	}
+	anchors->order_count = count;
+	anchors->sort = false;
+	return 0;
+}
+
+static SDL_Rect __Solve(VENG_Element* element, SDL_Rect container)
+{
+	VENG_Constraint* c = element->anchor->constraints;
+	int values[VENG_ATTRIBUTES];
+	for (int i = 0; i < VENG_ATTRIBUTES; i++)
+	{
+		if (c[i].set)
+		{
+			SDL_Rect source = c[i].source == NULL ? container : c[i].source->rect;
+			values[i] = round(__Value(source, c[i].source_attribute) * c[i].multiplier + c[i].constant);
+		}
+	}
+	SDL_Point size = VENG_GetElementSize(element, container);
+	SDL_Rect rect;
+
+	// Horizontal axis
+	bool left = c[VENG_ATTRIBUTE_LEFT].set, right = c[VENG_ATTRIBUTE_RIGHT].set, center = c[VENG_ATTRIBUTE_CENTER_X].set;
+	if (c[VENG_ATTRIBUTE_WIDTH].set) rect.w = values[VENG_ATTRIBUTE_WIDTH];
+	else if (left && right) rect.w = values[VENG_ATTRIBUTE_RIGHT] - values[VENG_ATTRIBUTE_LEFT];
+	else if (left && center) rect.w = 2 * (values[VENG_ATTRIBUTE_CENTER_X] - values[VENG_ATTRIBUTE_LEFT]);
+	else if (right && center) rect.w = 2 * (values[VENG_ATTRIBUTE_RIGHT] - values[VENG_ATTRIBUTE_CENTER_X]);
+	else rect.w = size.x;
+	rect.w = SDL_max(rect.w, 0);
+	if (left) rect.x = values[VENG_ATTRIBUTE_LEFT];
+	else if (right) rect.x = values[VENG_ATTRIBUTE_RIGHT] - rect.w;
+	else if (center) rect.x = values[VENG_ATTRIBUTE_CENTER_X] - rect.w / 2;
+	else rect.x = container.x;
+
+	// Vertical axis
+	bool top = c[VENG_ATTRIBUTE_TOP].set, bottom = c[VENG_ATTRIBUTE_BOTTOM].set;
+	center = c[VENG_ATTRIBUTE_CENTER_Y].set;
+	if (c[VENG_ATTRIBUTE_HEIGHT].set) rect.h = values[VENG_ATTRIBUTE_HEIGHT];
+	else if (top && bottom) rect.h = values[VENG_ATTRIBUTE_BOTTOM] - values[VENG_ATTRIBUTE_TOP];
+	else if (top && center) rect.h = 2 * (values[VENG_ATTRIBUTE_CENTER_Y] - values[VENG_ATTRIBUTE_TOP]);
+	else if (bottom && center) rect.h = 2 * (values[VENG_ATTRIBUTE_BOTTOM] - values[VENG_ATTRIBUTE_CENTER_Y]);
+	else rect.h = size.y;
+	rect.h = SDL_max(rect.h, 0);
+	if (top) rect.y = values[VENG_ATTRIBUTE_TOP];
+	else if (bottom) rect.y = values[VENG_ATTRIBUTE_BOTTOM] - rect.h;
+	else if (center) rect.y = values[VENG_ATTRIBUTE_CENTER_Y] - rect.h / 2;
+	else rect.y = container.y;
+	return rect;
+}
+
+int VENG_SolveAnchors(VENG_Childs* childs, SDL_Rect drawing_rect)
+{
+	if (childs->anchors == NULL)
+	{
+		childs->anchors = VENG_Alloc(VENG_MEMORY_CHILDS, 1, sizeof(VENG_Anchors));
+		if (childs->anchors == NULL)
+		{
+			printf("Couldn't allocate Anchors\n");
+			return 1;
+		}
+		childs->anchors->sort = true;
+	}
+	VENG_Anchors* anchors = childs->anchors;
+	if ((anchors->sort || anchors->order_count != childs->sub_elements_count) && __Sort(childs, anchors) != 0)
+	{
+		return 1;
+	}
+	bool resized = !SDL_RectEquals(&anchors->rect, &drawing_rect);
+	anchors->rect = drawing_rect;
+	for (size_t i = 0; i < anchors->order_count; i++)
+	{
+		VENG_Element* element = anchors->order[i];
+		VENG_Anchor* anchor = element->anchor;
+		if (element->w != anchor->w || element->h != anchor->h || element->stretch_size != anchor->stretch_size || element->visible != anchor->visible)
+		{
+			anchor->w = element->w;
+			anchor->h = element->h;
+			anchor->stretch_size = element->stretch_size;
+			anchor->visible = element->visible;
+			anchor->dirty = true;
+		}
+		if (!anchor->dirty && !(resized && anchor->uses_container))
+		{
+			continue;
+		}
+		anchor->dirty = false;
+		SDL_Rect rect = element->visible ? __Solve(element, drawing_rect) : (SDL_Rect){-1, -1, -1, -1};
+		if (!SDL_RectEquals(&rect, &element->rect))
+		{
+			element->rect = rect;
+			for (size_t k = 0; k < anchor->dependents_count; k++)
+			{
+				anchor->dependents[k]->anchor->dirty = true;
+			}
+		}
+	}
+	return 0;
+}
+
+// Before destroying an element: its constraints and the constraints of its dependents
+// that use it are dropped
+void VENG_DetachAnchor(VENG_Element* element)
+{
+	__Resort(element);
+	VENG_Anchor* anchor = element->anchor;
+	if (anchor == NULL)
+	{
+		return;
+	}
+	for (int i = 0; i < VENG_ATTRIBUTES; i++)
+	{
+		if (anchor->constraints[i].set && anchor->constraints[i].source != NULL)
+		{
+			__RemoveDependent(anchor->constraints[i].source->anchor, element);
+		}
+		anchor->constraints[i].set = false;
+	}
+	for (size_t i = 0; i < anchor->dependents_count; i++)
+	{
+		VENG_Anchor* dependent = anchor->dependents[i]->anchor;
+		for (int k = 0; k < VENG_ATTRIBUTES; k++)
+		{
+			if (dependent->constraints[k].set && dependent->constraints[k].source == element)
+			{
+				dependent->constraints[k].set = false;
+			}
+		}
+		__UpdateUsesContainer(dependent);
+		dependent->dirty = true;
+	}
+	anchor->dependents_count = 0;
+}
+
+void VENG_FreeAnchor(VENG_Element* element)
+{
+	if (element->anchor == NULL)
+	{
+		return;
+	}
+	VENG_Free(VENG_MEMORY_ELEMENTS, element->anchor->dependents, element->anchor->dependents_size, sizeof(VENG_Element*));
+	VENG_Free(VENG_MEMORY_ELEMENTS, element->anchor, 1, sizeof(VENG_Anchor));
+	element->anchor = NULL;
+}
+
+void VENG_FreeAnchors(VENG_Childs* childs)
+{
+	if (childs->anchors == NULL)
+	{
+		return;
+	}
+	VENG_Free(VENG_MEMORY_CHILDS, childs->anchors->order, childs->anchors->order_size, sizeof(VENG_Element*));
+	VENG_Free(VENG_MEMORY_CHILDS, childs->anchors, 1, sizeof(VENG_Anchors));
+	childs->anchors = NULL;
+}
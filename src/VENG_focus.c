@@ -0,0 +1,846 @@
+#include <SDL2/SDL.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "VENG/VENG.h"
+
+// Focus navigation:
+// (I)   Every layer keeps its visible focusable elements as nodes with the rects they had when
+//       last checked, in buckets by the (doubled) centers of those rects.
+// (II)  Layouts and scrolls record the containers they moved. On use, only the sub-elements of
+//       those are checked again, and only the nodes whose rects changed move between buckets.
+//       Destroyed elements leave their buckets right away.
+// (III) Every node keeps its nearest neighbor per direction, found again on use once a node was
+//       added, moved or removed. The search goes through the buckets around the node, nearest
+//       first, and stops once the buckets left can't hold anything nearer.
+// A neighbor must lie on the side of the direction, and the nearest is the one with the
+// smallest 13 * major^2 + minor^2 (major: gap along the direction, minor: offset across it).
+
+#define FOCUS_START 16
+#define FOCUS_NONE SIZE_MAX
+#define FOCUS_FAR ((Sint64)1 << 28) // Past any doubled coordinate, its square still fits
+
+typedef struct VENG_FocusNode
+{
+	VENG_Element* element; // NULL for a free node
+	SDL_Rect rect;         // As of the last check
+	size_t neighbors[4];   // By VENG_FocusDirection
+	Uint64 found[4];       // Changes count the neighbors were found at
+	size_t bucket;
+	size_t next, previous; // In the bucket, next also chains the free nodes
+} VENG_FocusNode;
+
+typedef struct VENG_FocusBucket
+{
+	size_t first;
+	Sint64 x_min, x_max, y_min, y_max; // Doubled centers of the nodes it held since it was built
+} VENG_FocusBucket;
+
+struct VENG_Focus
+{
+	VENG_FocusNode* nodes;
+	size_t nodes_size;
+	size_t nodes_used; // Handed out at least once
+	size_t count;
+	size_t free;       // First free node
+	Uint64 changes;    // Bumped when a node is added, moved or removed
+	int max_w, max_h;  // Largest rects since the buckets were built
+
+	VENG_FocusBucket* buckets;
+	size_t buckets_size;
+	int columns, rows;
+	Sint64 origin_x, origin_y; // Doubled centers
+	Sint64 bucket_w, bucket_h;
+	size_t bucketed; // Nodes when the buckets were built
+
+	VENG_Element** moved; // Containers laid out or scrolled since the last refresh
+	size_t moved_size;
+	size_t moved_count;
+	bool whole;           // The layer was laid out, every element is checked
+
+	VENG_Element* focused;
+	VENG_FocusCallback callback;
+};
+
+static size_t graphs = 0; // Layers with a focus, layouts don't record anything without one
+
+static VENG_Layer* __GetLayer(void* container)
+{
+	while (container != NULL && ((VENG_Element*)container)->type == VENG_TYPE_ELEMENT)
+	{
+		container = ((VENG_Element*)container)->parent;
+	}
+	return container;
+}
+
+static VENG_Focus* __GetFocus(VENG_Layer* layer)
+{
+	if (layer->focus == NULL)
+	{
+		layer->focus = VENG_Alloc(VENG_MEMORY_LISTENERS, 1, sizeof(VENG_Focus));
+		if (layer->focus == NULL)
+		{
+			printf("Couldn't allocate Focus\n");
+			return NULL;
+		}
+		layer->focus->free = FOCUS_NONE;
+		layer->focus->changes = 1;
+		layer->focus->whole = true;
+		graphs++;
+	}
+	return layer->focus;
+}
+
+// The element and its containers are visible
+static bool __Shown(VENG_Element* element)
+{
+	for (void* container = element; container != NULL && ((VENG_Element*)container)->type == VENG_TYPE_ELEMENT; container = ((VENG_Element*)container)->parent)
+	{
+		if (!((VENG_Element*)container)->visible)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+/*==========================================================================*\
+ *                   				Buckets
+\*==========================================================================*/
+static Sint64 __CenterX(SDL_Rect rect)
+{
+	return (Sint64)rect.x * 2 + rect.w;
+}
+
+static Sint64 __CenterY(SDL_Rect rect)
+{
+	return (Sint64)rect.y * 2 + rect.h;
+}
+
+// What moved past the edges goes to the edge buckets, they reach out without bounds
+static size_t __BucketOf(VENG_Focus* focus, SDL_Rect rect)
+{
+	Sint64 column = (__CenterX(rect) - focus->origin_x) / focus->bucket_w;
+	Sint64 row = (__CenterY(rect) - focus->origin_y) / focus->bucket_h;
+	column = SDL_max(0, SDL_min(column, focus->columns - 1));
+	row = SDL_max(0, SDL_min(row, focus->rows - 1));
+	return (size_t)row * focus->columns + column;
+}
+
+static void __EmptyBucket(VENG_FocusBucket* bucket)
+{
+	*bucket = (VENG_FocusBucket){FOCUS_NONE, FOCUS_FAR, -FOCUS_FAR, FOCUS_FAR, -FOCUS_FAR};
+}
+
+static void __Bucket(VENG_Focus* focus, size_t node)
+{
+	VENG_FocusNode* entry = &focus->nodes[node];
+	focus->max_w = SDL_max(focus->max_w, entry->rect.w);
+	focus->max_h = SDL_max(focus->max_h, entry->rect.h);
+	entry->bucket = FOCUS_NONE;
+	if (focus->buckets == NULL)
+	{
+		return;
+	}
+	entry->bucket = __BucketOf(focus, entry->rect);
+	VENG_FocusBucket* bucket = &focus->buckets[entry->bucket];
+	entry->previous = FOCUS_NONE;
+	entry->next = bucket->first;
+	if (bucket->first != FOCUS_NONE)
+	{
+		focus->nodes[bucket->first].previous = node;
+	}
+	bucket->first = node;
+	bucket->x_min = SDL_min(bucket->x_min, __CenterX(entry->rect));
+	bucket->x_max = SDL_max(bucket->x_max, __CenterX(entry->rect));
+	bucket->y_min = SDL_min(bucket->y_min, __CenterY(entry->rect));
+	bucket->y_max = SDL_max(bucket->y_max, __CenterY(entry->rect));
+}
+
+static void __Unbucket(VENG_Focus* focus, size_t node)
+{
+	VENG_FocusNode* entry = &focus->nodes[node];
+	if (entry->bucket == FOCUS_NONE)
+	{
+		return;
+	}
+	VENG_FocusBucket* bucket = &focus->buckets[entry->bucket];
+	if (entry->previous != FOCUS_NONE)
+	{
+		focus->nodes[entry->previous].next = entry->next;
+	}
+	else
+	{
+		bucket->first = entry->next;
+	}
+	if (entry->next != FOCUS_NONE)
+	{
+		focus->nodes[entry->next].previous = entry->previous;
+	}
+	if (bucket->first == FOCUS_NONE)
+	{
+		__EmptyBucket(bucket);
+	}
+	entry->bucket = FOCUS_NONE;
+}
+
+// Splits the bounds of the centers in about 2 nodes per bucket, shaped like those bounds
+static int __BuildBuckets(VENG_Focus* focus)
+{
+	Sint64 x_min = 0, x_max = 0, y_min = 0, y_max = 0;
+	bool first = true;
+	focus->max_w = 0;
+	focus->max_h = 0;
+	for (size_t i = 0; i < focus->nodes_used; i++)
+	{
+		if (focus->nodes[i].element == NULL)
+		{
+			continue;
+		}
+		Sint64 x = __CenterX(focus->nodes[i].rect);
+		Sint64 y = __CenterY(focus->nodes[i].rect);
+		x_min = first ? x : SDL_min(x_min, x);
+		x_max = first ? x : SDL_max(x_max, x);
+		y_min = first ? y : SDL_min(y_min, y);
+		y_max = first ? y : SDL_max(y_max, y);
+		first = false;
+	}
+	Sint64 span_w = x_max - x_min + 1;
+	Sint64 span_h = y_max - y_min + 1;
+	size_t wanted = SDL_max(focus->count / 2, 1);
+	int columns = (int)SDL_max(1, SDL_min((Sint64)wanted, (Sint64)round(sqrt((double)wanted * span_w / span_h))));
+	int rows = (int)SDL_max(1, wanted / columns);
+	size_t size = (size_t)columns * rows;
+	if (size > focus->buckets_size)
+	{
+		VENG_FocusBucket* buckets = VENG_Alloc(VENG_MEMORY_LISTENERS, size, sizeof(VENG_FocusBucket));
+		if (buckets == NULL)
+		{
+			printf("Couldn't allocate Focus buckets\n");
+			return 1;
+		}
+		VENG_Free(VENG_MEMORY_LISTENERS, focus->buckets, focus->buckets_size, sizeof(VENG_FocusBucket));
+		focus->buckets = buckets;
+		focus->buckets_size = size;
+	}
+	for (size_t i = 0; i < size; i++)
+	{
+		__EmptyBucket(&focus->buckets[i]);
+	}
+	focus->columns = columns;
+	focus->rows = rows;
+	focus->origin_x = x_min;
+	focus->origin_y = y_min;
+	focus->bucket_w = (span_w + columns - 1) / columns;
+	focus->bucket_h = (span_h + rows - 1) / rows;
+	for (size_t i = 0; i < focus->nodes_used; i++)
+	{
+		if (focus->nodes[i].element != NULL)
+		{
+			__Bucket(focus, i);
+		}
+	}
+	focus->bucketed = focus->count;
+	return 0;
+}
+
+/*==========================================================================*\
+ *                   				Nodes
+\*==========================================================================*/
+static size_t __NewNode(VENG_Focus* focus)
+{
+	if (focus->free != FOCUS_NONE)
+	{
+		size_t node = focus->free;
+		focus->free = focus->nodes[node].next;
+		return node;
+	}
+	if (focus->nodes_used == focus->nodes_size)
+	{
+		size_t size = focus->nodes_size == 0 ? FOCUS_START : focus->nodes_size * 2;
+		VENG_FocusNode* nodes = VENG_Realloc(VENG_MEMORY_LISTENERS, focus->nodes, focus->nodes_size, size, sizeof(VENG_FocusNode));
+		if (nodes == NULL)
+		{
+			printf("Couldn't allocate Focus nodes\n");
+			return FOCUS_NONE;
+		}
+		focus->nodes = nodes;
+		focus->nodes_size = size;
+	}
+	return focus->nodes_used++;
+}
+
+static void __Remove(VENG_Focus* focus, VENG_Element* element)
+{
+	size_t node = element->focus_slot - 1;
+	__Unbucket(focus, node);
+	focus->nodes[node] = (VENG_FocusNode){.element = NULL, .next = focus->free, .bucket = FOCUS_NONE};
+	focus->free = node;
+	element->focus_slot = 0;
+	focus->count--;
+	focus->changes++;
+}
+
+// Adds, moves or removes the node of the element for its current rect
+static int __Place(VENG_Focus* focus, VENG_Element* element, bool shown)
+{
+	bool focusable = shown && element->focusable && element->rect.w > 0 && element->rect.h > 0;
+	if (!focusable)
+	{
+		if (element->focus_slot != 0)
+		{
+			__Remove(focus, element);
+		}
+		return 0;
+	}
+	size_t node = element->focus_slot - 1;
+	if (element->focus_slot != 0)
+	{
+		if (memcmp(&focus->nodes[node].rect, &element->rect, sizeof(SDL_Rect)) == 0)
+		{
+			return 0;
+		}
+		__Unbucket(focus, node);
+	}
+	else
+	{
+		node = __NewNode(focus);
+		if (node == FOCUS_NONE)
+		{
+			return 1;
+		}
+		focus->nodes[node] = (VENG_FocusNode){.element = element};
+		element->focus_slot = node + 1;
+		focus->count++;
+	}
+	focus->nodes[node].rect = element->rect;
+	__Bucket(focus, node);
+	focus->changes++;
+	return 0;
+}
+
+// Checks the sub-elements, those of hidden ones leave the graph
+static int __Check(VENG_Focus* focus, VENG_Childs* childs, bool shown)
+{
+	for (size_t i = 0; childs->sub_elements != NULL && i < childs->sub_elements_size; i++)
+	{
+		VENG_Element* element = childs->sub_elements[i];
+		if (element == NULL)
+		{
+			continue;
+		}
+		bool visible = shown && element->visible;
+		if (__Place(focus, element, visible) != 0)
+		{
+			return 1;
+		}
+		// Hidden subtrees are only walked while there are nodes they may hold
+		if ((visible || focus->count > 0) && __Check(focus, &element->childs, visible) != 0)
+		{
+			return 1;
+		}
+	}
+	return 0;
+}
+
+// A recorded container inside another one is checked with it
+static bool __Covered(VENG_Element* element)
+{
+	for (void* container = element->parent; container != NULL && ((VENG_Element*)container)->type == VENG_TYPE_ELEMENT; container = ((VENG_Element*)container)->parent)
+	{
+		if (((VENG_Element*)container)->focus_moved)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+/*==========================================================================*\
+ *                   				Search
+\*==========================================================================*/
+// Returns false if b isn't on that side of a
+static bool __Score(SDL_Rect a, SDL_Rect b, VENG_FocusDirection direction, Uint64* score)
+{
+	Sint64 major, minor;
+	switch (direction)
+	{
+		case VENG_FOCUS_LEFT:
+			if (b.x * 2 + b.w >= a.x * 2 + a.w || b.x + b.w > a.x + a.w) return false;
+			major = a.x - (b.x + b.w);
+			minor = (Sint64)(b.y * 2 + b.h) - (a.y * 2 + a.h);
+			break;
+		case VENG_FOCUS_RIGHT:
+			if (b.x * 2 + b.w <= a.x * 2 + a.w || b.x < a.x) return false;
+			major = b.x - (a.x + a.w);
+			minor = (Sint64)(b.y * 2 + b.h) - (a.y * 2 + a.h);
+			break;
+		case VENG_FOCUS_UP:
+			if (b.y * 2 + b.h >= a.y * 2 + a.h || b.y + b.h > a.y + a.h) return false;
+			major = a.y - (b.y + b.h);
+			minor = (Sint64)(b.x * 2 + b.w) - (a.x * 2 + a.w);
+			break;
+		default:
+			if (b.y * 2 + b.h <= a.y * 2 + a.h || b.y < a.y) return false;
+			major = b.y - (a.y + a.h);
+			minor = (Sint64)(b.x * 2 + b.w) - (a.x * 2 + a.w);
+			break;
+	}
+	major = SDL_max(major, 0) * 2; // Same units as the doubled centers
+	*score = (Uint64)(13 * major * major + minor * minor);
+	return true;
+}
+
+// Lowest score of anything centered in the box, false if nothing there can be on that side.
+// Twice the gap along the direction is the centers' distance minus both sizes on that axis.
+static bool __Bound(VENG_Focus* focus, SDL_Rect a, VENG_FocusDirection direction, Sint64 x_min, Sint64 x_max, Sint64 y_min, Sint64 y_max, Uint64* bound)
+{
+	Sint64 x = __CenterX(a);
+	Sint64 y = __CenterY(a);
+	Sint64 along_min, along_max, offset, sizes;
+	if (direction == VENG_FOCUS_LEFT || direction == VENG_FOCUS_RIGHT)
+	{
+		along_min = direction == VENG_FOCUS_LEFT ? x - x_max : x_min - x;
+		along_max = direction == VENG_FOCUS_LEFT ? x - x_min : x_max - x;
+		offset = y < y_min ? y_min - y : y > y_max ? y - y_max : 0;
+		sizes = a.w + focus->max_w;
+	}
+	else
+	{
+		along_min = direction == VENG_FOCUS_UP ? y - y_max : y_min - y;
+		along_max = direction == VENG_FOCUS_UP ? y - y_min : y_max - y;
+		offset = x < x_min ? x_min - x : x > x_max ? x - x_max : 0;
+		sizes = a.h + focus->max_h;
+	}
+	if (x_min > x_max || along_max < 0)
+	{
+		return false;
+	}
+	Sint64 major = SDL_min(SDL_max(along_min - sizes, 0), FOCUS_FAR);
+	offset = SDL_min(offset, FOCUS_FAR);
+	*bound = (Uint64)(13 * major * major + offset * offset);
+	return true;
+}
+
+// Keeps the current neighbor on a tie with a later node, so the result doesn't depend on the bucket order
+static bool __Better(VENG_Focus* focus, size_t node, VENG_FocusDirection direction, size_t candidate, size_t current)
+{
+	Uint64 score, current_score;
+	if (candidate == node || !__Score(focus->nodes[node].rect, focus->nodes[candidate].rect, direction, &score))
+	{
+		return false;
+	}
+	if (current == FOCUS_NONE)
+	{
+		return true;
+	}
+	__Score(focus->nodes[node].rect, focus->nodes[current].rect, direction, &current_score);
+	return score < current_score || (score == current_score && candidate < current);
+}
+
+// Rings of buckets around the node's one. The bounds of a bucket only grow moving out, so
+// a ring where none can beat the nearest found ends the search
+static size_t __Nearest(VENG_Focus* focus, size_t node, VENG_FocusDirection direction)
+{
+	SDL_Rect a = focus->nodes[node].rect;
+	size_t nearest = FOCUS_NONE;
+	Uint64 best = 0;
+	int column = (int)(focus->nodes[node].bucket % focus->columns);
+	int row = (int)(focus->nodes[node].bucket / focus->columns);
+	int rings = SDL_max(SDL_max(column, focus->columns - 1 - column), SDL_max(row, focus->rows - 1 - row));
+	for (int ring = 0; ring <= rings; ring++)
+	{
+		bool open = false;
+		for (int r = SDL_max(row - ring, 0); r <= SDL_min(row + ring, focus->rows - 1); r++)
+		{
+			// Rows inside the ring only have its two edge buckets
+			int step = r == row - ring || r == row + ring ? 1 : 2 * ring;
+			for (int c = column - ring; c <= column + ring; c += step)
+			{
+				if (c < 0 || c >= focus->columns)
+				{
+					continue;
+				}
+				Uint64 bound;
+				Sint64 x_min = c == 0 ? -FOCUS_FAR : focus->origin_x + c * focus->bucket_w;
+				Sint64 x_max = c == focus->columns - 1 ? FOCUS_FAR : focus->origin_x + (c + 1) * focus->bucket_w - 1;
+				Sint64 y_min = r == 0 ? -FOCUS_FAR : focus->origin_y + r * focus->bucket_h;
+				Sint64 y_max = r == focus->rows - 1 ? FOCUS_FAR : focus->origin_y + (r + 1) * focus->bucket_h - 1;
+				if (!__Bound(focus, a, direction, x_min, x_max, y_min, y_max, &bound) || (nearest != FOCUS_NONE && bound > best))
+				{
+					continue;
+				}
+				open = true;
+				// Its nodes may sit in a smaller part of it
+				VENG_FocusBucket* bucket = &focus->buckets[(size_t)r * focus->columns + c];
+				if (!__Bound(focus, a, direction, bucket->x_min, bucket->x_max, bucket->y_min, bucket->y_max, &bound) || (nearest != FOCUS_NONE && bound > best))
+				{
+					continue;
+				}
+				for (size_t i = bucket->first; i != FOCUS_NONE; i = focus->nodes[i].next)
+				{
+					if (__Better(focus, node, direction, i, nearest))
+					{
+						nearest = i;
+						__Score(a, focus->nodes[i].rect, direction, &best);
+					}
+				}
+			}
+		}
+		if (!open)
+		{
+			break;
+		}
+	}
+	return nearest;
+}
+
+/*==========================================================================*\
+ *                   				Refresh
+\*==========================================================================*/
+static void __SetFocused(VENG_Focus* focus, VENG_Element* element)
+{
+	VENG_Element* previous = focus->focused;
+	if (element == previous)
+	{
+		return;
+	}
+	focus->focused = element;
+	if (previous != NULL) VENG_InvalidateElement(previous);
+	if (element != NULL) VENG_InvalidateElement(element);
+	if (focus->callback != NULL)
+	{
+		focus->callback(previous, element);
+	}
+}
+
+static int __Refresh(VENG_Focus* focus, VENG_Layer* layer)
+{
+	if (!focus->whole && focus->moved_count == 0)
+	{
+		return 0;
+	}
+	int result = 0;
+	if (focus->whole)
+	{
+		result = __Check(focus, &layer->childs, true);
+	}
+	for (size_t i = 0; !focus->whole && result == 0 && i < focus->moved_count; i++)
+	{
+		VENG_Element* container = focus->moved[i];
+		if (!__Covered(container))
+		{
+			result = __Check(focus, &container->childs, __Shown(container));
+		}
+	}
+	for (size_t i = 0; i < focus->moved_count; i++)
+	{
+		focus->moved[i]->focus_moved = false;
+	}
+	focus->moved_count = 0;
+	bool whole = focus->whole;
+	// Whatever went unchecked is checked again on the next use
+	focus->whole = result != 0;
+	if (result != 0)
+	{
+		return 1;
+	}
+	// The buckets are split again for a new layout, or once the count drifted away from theirs
+	if (whole || focus->buckets == NULL || focus->count > focus->bucketed * 2 || focus->count * 4 < focus->bucketed)
+	{
+		if (__BuildBuckets(focus) != 0)
+		{
+			focus->whole = true;
+			return 1;
+		}
+	}
+	// Hidden or no longer focusable
+	if (focus->focused != NULL && focus->focused->focus_slot == 0)
+	{
+		__SetFocused(focus, NULL);
+	}
+	return 0;
+}
+
+// First visible focusable element in tree order
+static VENG_Element* __First(VENG_Childs* childs)
+{
+	for (size_t i = 0; childs->sub_elements != NULL && i < childs->sub_elements_size; i++)
+	{
+		VENG_Element* element = childs->sub_elements[i];
+		if (element == NULL || !element->visible)
+		{
+			continue;
+		}
+		if (element->focus_slot != 0)
+		{
+			return element;
+		}
+		VENG_Element* first = __First(&element->childs);
+		if (first != NULL)
+		{
+			return first;
+		}
+	}
+	return NULL;
+}
+
+/*==========================================================================*\
+ *                   				 Focus
+\*==========================================================================*/
+int VENG_SetElementFocusable(VENG_Element* element, bool focusable)
+{
+	if (!VENG_HasStarted())
+	{
+		printf("VENG is not initialized yet\n");
+		return 1;
+	}
+	if (element == NULL)
+	{
+		printf("Element is NULL\n");
+		return 1;
+	}
+	if (element->focusable == focusable)
+	{
+		return 0;
+	}
+	element->focusable = focusable;
+	VENG_Layer* layer = __GetLayer(element->parent);
+	if (layer != NULL && layer->focus != NULL)
+	{
+		// Only its own node changes, a pending layout checks its rect again
+		if (__Place(layer->focus, element, __Shown(element)) != 0)
+		{
+			return 1;
+		}
+		if (!focusable && layer->focus->focused == element)
+		{
+			__SetFocused(layer->focus, NULL);
+		}
+	}
+	return 0;
+}
+
+int VENG_SetFocus(VENG_Layer* layer, VENG_Element* element)
+{
+	if (!VENG_HasStarted())
+	{
+		printf("VENG is not initialized yet\n");
+		return 1;
+	}
+	if (layer == NULL)
+	{
+		printf("Layer is NULL\n");
+		return 1;
+	}
+	VENG_Focus* focus = __GetFocus(layer);
+	if (focus == NULL || __Refresh(focus, layer) != 0)
+	{
+		return 1;
+	}
+	if (element == NULL)
+	{
+		__SetFocused(focus, NULL);
+		return 0;
+	}
+	size_t node = element->focus_slot - 1;
+	if (element->focus_slot == 0 || node >= focus->nodes_used || focus->nodes[node].element != element)
+	{
+		printf("Element isn't a visible focusable element of the layer\n");
+		return 1;
+	}
+	__SetFocused(focus, element);
+	return 0;
+}
+
+VENG_Element* VENG_GetFocus(VENG_Layer* layer)
+{
+	if (!VENG_HasStarted())
+	{
+		printf("VENG is not initialized yet\n");
+		return NULL;
+	}
+	if (layer == NULL || layer->focus == NULL)
+	{
+		return NULL;
+	}
+	__Refresh(layer->focus, layer);
+	return layer->focus->focused;
+}
+
+int VENG_MoveFocus(VENG_Layer* layer, VENG_FocusDirection direction)
+{
+	if (!VENG_HasStarted())
+	{
+		printf("VENG is not initialized yet\n");
+		return 1;
+	}
+	if (layer == NULL || direction < VENG_FOCUS_LEFT || direction > VENG_FOCUS_DOWN)
+	{
+		printf("Layer is NULL or invalid direction\n");
+		return 1;
+	}
+	VENG_Focus* focus = __GetFocus(layer);
+	if (focus == NULL || __Refresh(focus, layer) != 0)
+	{
+		return 1;
+	}
+	if (focus->focused == NULL)
+	{
+		// Nothing focused yet: the first one
+		VENG_Element* first = focus->count > 0 ? __First(&layer->childs) : NULL;
+		if (first != NULL)
+		{
+			__SetFocused(focus, first);
+		}
+		return 0;
+	}
+	VENG_FocusNode* node = &focus->nodes[focus->focused->focus_slot - 1];
+	if (node->found[direction] != focus->changes)
+	{
+		node->neighbors[direction] = __Nearest(focus, focus->focused->focus_slot - 1, direction);
+		node->found[direction] = focus->changes;
+	}
+	if (node->neighbors[direction] != FOCUS_NONE)
+	{
+		__SetFocused(focus, focus->nodes[node->neighbors[direction]].element);
+	}
+	return 0;
+}
+
+int VENG_SetFocusCallback(VENG_Layer* layer, VENG_FocusCallback callback)
+{
+	if (!VENG_HasStarted())
+	{
+		printf("VENG is not initialized yet\n");
+		return 1;
+	}
+	if (layer == NULL)
+	{
+		printf("Layer is NULL\n");
+		return 1;
+	}
+	VENG_Focus* focus = __GetFocus(layer);
+	if (focus == NULL)
+	{
+		return 1;
+	}
+	focus->callback = callback;
+	return 0;
+}
+
+/*==========================================================================*\
+ *                   			Internal usage
+\*==========================================================================*/
+void VENG_InvalidateFocus(void* container)
+{
+	if (graphs == 0)
+	{
+		return;
+	}
+	VENG_Layer* layer = __GetLayer(container);
+	if (layer == NULL || layer->focus == NULL)
+	{
+		return;
+	}
+	VENG_Focus* focus = layer->focus;
+	if (container == (void*)layer)
+	{
+		focus->whole = true;
+		return;
+	}
+	VENG_Element* element = container;
+	if (focus->whole || element->focus_moved)
+	{
+		return;
+	}
+	if (focus->moved_count >= focus->moved_size)
+	{
+		size_t size = focus->moved_size == 0 ? FOCUS_START : focus->moved_size * 2;
+		VENG_Element** moved = VENG_Realloc(VENG_MEMORY_LISTENERS, focus->moved, focus->moved_size, size, sizeof(VENG_Element*));
+		if (moved == NULL)
+		{
+			// Everything is checked instead
+			focus->whole = true;
+			return;
+		}
+		focus->moved = moved;
+		focus->moved_size = size;
+	}
+	focus->moved[focus->moved_count++] = element;
+	element->focus_moved = true;
+}
+
+static void __Forget(VENG_Focus* focus, VENG_Element* element)
+{
+	if (element->focus_slot != 0)
+	{
+		__Remove(focus, element);
+	}
+	if (element->focus_moved)
+	{
+		for (size_t i = 0; i < focus->moved_count; i++)
+		{
+			if (focus->moved[i] == element)
+			{
+				focus->moved[i] = focus->moved[--focus->moved_count];
+				break;
+			}
+		}
+		element->focus_moved = false;
+	}
+	if (focus->focused == element)
+	{
+		focus->focused = NULL;
+	}
+	for (size_t i = 0; element->childs.sub_elements != NULL && i < element->childs.sub_elements_size; i++)
+	{
+		if (element->childs.sub_elements[i] != NULL)
+		{
+			__Forget(focus, element->childs.sub_elements[i]);
+		}
+	}
+}
+
+void VENG_ForgetFocus(VENG_Element* element)
+{
+	VENG_Layer* layer = __GetLayer(element->parent);
+	if (layer == NULL || layer->focus == NULL)
+	{
+		return;
+	}
+	// The nodes of the subtree leave their buckets, neighbors found with them are found again on use
+	VENG_Focus* focus = layer->focus;
+	if (focus->count > 0 || focus->moved_count > 0)
+	{
+		__Forget(focus, element);
+	}
+}
+
+void VENG_FreeFocus(VENG_Layer* layer)
+{
+	VENG_Focus* focus = layer->focus;
+	if (focus == NULL)
+	{
+		return;
+	}
+	for (size_t i = 0; i < focus->nodes_used; i++)
+	{
+		if (focus->nodes[i].element != NULL)
+		{
+			focus->nodes[i].element->focus_slot = 0;
+		}
+	}
+	for (size_t i = 0; i < focus->moved_count; i++)
+	{
+		focus->moved[i]->focus_moved = false;
+	}
+	VENG_Free(VENG_MEMORY_LISTENERS, focus->nodes, focus->nodes_size, sizeof(VENG_FocusNode));
+	VENG_Free(VENG_MEMORY_LISTENERS, focus->buckets, focus->buckets_size, sizeof(VENG_FocusBucket));
+	VENG_Free(VENG_MEMORY_LISTENERS, focus->moved, focus->moved_size, sizeof(VENG_Element*));
+	VENG_Free(VENG_MEMORY_LISTENERS, focus, 1, sizeof(VENG_Focus));
+	layer->focus = NULL;
+	graphs--;
+}
@@ -0,0 +1,367 @@
+#include <SDL2/SDL.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "VENG/VENG.h"
+
+// Touch gestures:
+// (I)   Once VENG_ProcessGestures has been called, VENG_ListenScreen appends SDL_FINGER*
+//       events to a queue, listeners still get them as usual.
+// (II)  VENG_ProcessGestures runs one state machine per finger over the queue, once per
+//       frame: pressed -> (long pressed) -> dragging -> released. Drags are coalesced into
+//       one VENG_GESTURE_DRAG per finger and frame, whatever the touch rate is.
+// (III) Recognized gestures go through VENG_ListenScreen as a registered SDL user event,
+//       so listeners are added like any other (see VENG_GetGestureEventType).
+// The velocity is a least-squares fit of the last samples, and drags carry the position
+// extrapolated prediction_ms ahead to hide the display latency.
+
+#define MAX_FINGERS 10
+#define FINGER_SAMPLES 8     // Power of 2
+#define VELOCITY_WINDOW_MS 80 // Older samples don't count for the velocity
+#define ALLOCATED_TOUCHES_START 32
+
+typedef enum VENG_FingerState
+{
+	VENG_FINGER_PRESSED,
+	VENG_FINGER_LONG_PRESSED,
+	VENG_FINGER_DRAGGING
+} VENG_FingerState;
+
+typedef struct VENG_Touch // Queued SDL_FINGER* event
+{
+	Uint32 type;
+	Uint32 timestamp;
+	SDL_FingerID id;
+	float x, y; // Normalized
+} VENG_Touch;
+
+typedef struct VENG_Finger
+{
+	bool active;
+	SDL_FingerID id;
+	VENG_FingerState state;
+	Uint32 down_time;
+	SDL_Point start;
+	SDL_Point position;
+	SDL_Point reported; // Position of its last gesture
+	bool moved;         // Since its last gesture
+
+	SDL_FPoint samples[FINGER_SAMPLES];
+	Uint32 times[FINGER_SAMPLES];
+	size_t samples_count; // Total, the last FINGER_SAMPLES are kept
+} VENG_Finger;
+
+static Uint32 gesture_event = (Uint32)-1;
+static VENG_GestureConfig config = {10, 250, 500, 800.0f, 16};
+static VENG_Finger fingers[MAX_FINGERS];
+
+static VENG_Touch* touches = NULL;
+static size_t touches_size = 0;
+static size_t touches_count = 0;
+static bool collecting = false; // Apps that never process gestures don't queue touches
+
+static VENG_Finger* __GetFinger(SDL_FingerID id, bool create)
+{
+	VENG_Finger* free_finger = NULL;
+	for (size_t i = 0; i < MAX_FINGERS; i++)
+	{
+		if (fingers[i].active && fingers[i].id == id)
+		{
+			return &fingers[i];
+		}
+		if (!fingers[i].active && free_finger == NULL)
+		{
+			free_finger = &fingers[i];
+		}
+	}
+	return create ? free_finger : NULL;
+}
+
+static void __AddSample(VENG_Finger* finger, SDL_Point point, Uint32 timestamp)
+{
+	size_t slot = finger->samples_count++ & (FINGER_SAMPLES - 1);
+	finger->samples[slot] = (SDL_FPoint){point.x, point.y};
+	finger->times[slot] = timestamp;
+	finger->position = point;
+}
+
+// Px per second, least squares over the samples of the last VELOCITY_WINDOW_MS
+static SDL_FPoint __Velocity(VENG_Finger* finger)
+{
+	size_t count = SDL_min(finger->samples_count, FINGER_SAMPLES);
+	if (count < 2)
+	{
+		return (SDL_FPoint){0, 0};
+	}
+	size_t last = (finger->samples_count - 1) & (FINGER_SAMPLES - 1);
+	double t_mean = 0, x_mean = 0, y_mean = 0;
+	size_t used = 0;
+	for (size_t i = 0; i < count; i++)
+	{
+		size_t slot = (finger->samples_count - 1 - i) & (FINGER_SAMPLES - 1);
+		Uint32 age = finger->times[last] - finger->times[slot];
+		if (age > VELOCITY_WINDOW_MS)
+		{
+			break;
+		}
+		t_mean -= age;
+		x_mean += finger->samples[slot].x;
+		y_mean += finger->samples[slot].y;
+		used++;
+	}
+	if (used < 2)
+	{
+		return (SDL_FPoint){0, 0};
+	}
+	t_mean /= used;
+	x_mean /= used;
+	y_mean /= used;
+	double t_var = 0, tx = 0, ty = 0;
+	for (size_t i = 0; i < used; i++)
+	{
+		size_t slot = (finger->samples_count - 1 - i) & (FINGER_SAMPLES - 1);
+		double t = -(double)(finger->times[last] - finger->times[slot]) - t_mean;
+		t_var += t * t;
+		tx += t * (finger->samples[slot].x - x_mean);
+		ty += t * (finger->samples[slot].y - y_mean);
+	}
+	if (t_var <= 0)
+	{
+		return (SDL_FPoint){0, 0}; // Every sample in the same ms
+	}
+	return (SDL_FPoint){tx / t_var * 1000.0, ty / t_var * 1000.0};
+}
+
+static SDL_Point __Predict(VENG_Finger* finger, SDL_FPoint velocity, Uint32 ahead_ms)
+{
+	return (SDL_Point){finger->position.x + round(velocity.x * ahead_ms / 1000.0), finger->position.y + round(velocity.y * ahead_ms / 1000.0)};
+}
+
+static void __Emit(VENG_Screen* screen, VENG_Finger* finger, VENG_GestureType type, Uint32 timestamp)
+{
+	SDL_FPoint velocity = __Velocity(finger);
+	VENG_Gesture gesture;
+	gesture.type = type;
+	gesture.finger = finger->id;
+	gesture.position = finger->position;
+	gesture.start = finger->start;
+	gesture.delta = (SDL_Point){finger->position.x - finger->reported.x, finger->position.y - finger->reported.y};
+	gesture.velocity = velocity;
+	gesture.predicted = __Predict(finger, velocity, config.prediction_ms);
+	gesture.duration = timestamp - finger->down_time;
+	finger->reported = finger->position;
+	finger->moved = false;
+
+	SDL_Event event;
+	SDL_zero(event);
+	event.type = gesture_event;
+	event.user.timestamp = timestamp;
+	event.user.code = type;
+	event.user.data1 = &gesture;
+	VENG_ListenScreen(&event, screen);
+}
+
+static bool __BeyondSlop(VENG_Finger* finger)
+{
+	int dx = finger->position.x - finger->start.x;
+	int dy = finger->position.y - finger->start.y;
+	return dx * dx + dy * dy > config.slop * config.slop;
+}
+
+/*==========================================================================*\
+ *                   				Gestures
+\*==========================================================================*/
+Uint32 VENG_GetGestureEventType()
+{
+	if (gesture_event == (Uint32)-1)
+	{
+		gesture_event = SDL_RegisterEvents(1);
+		if (gesture_event == (Uint32)-1)
+		{
+			printf("Couldn't register the gesture event\n");
+		}
+	}
+	return gesture_event;
+}
+
+const VENG_Gesture* VENG_GetGesture(SDL_Event* event)
+{
+	if (event == NULL || gesture_event == (Uint32)-1 || event->type != gesture_event)
+	{
+		return NULL;
+	}
+	return event->user.data1;
+}
+
+int VENG_ProcessGestures(VENG_Screen* screen)
+{
+	if (!VENG_HasStarted())
+	{
+		printf("VENG is not initialized yet\n");
+		return 1;
+	}
+	if (screen == NULL)
+	{
+		printf("Screen is NULL\n");
+		return 1;
+	}
+	if (VENG_GetGestureEventType() == (Uint32)-1)
+	{
+		return 1;
+	}
+	collecting = true;
+	int w, h;
+	VENG_GetLogicalSize(&w, &h);
+	// Callbacks may queue more touches, they are processed in the same pass
+	for (size_t i = 0; i < touches_count; i++)
+	{
+		VENG_Touch touch = touches[i];
+		SDL_Point point = {round(touch.x * w), round(touch.y * h)};
+		VENG_Finger* finger = __GetFinger(touch.id, touch.type == SDL_FINGERDOWN);
+		if (finger == NULL)
+		{
+			continue; // Too many fingers, or it went down before VENG saw it
+		}
+		if (touch.type == SDL_FINGERDOWN)
+		{
+			memset(finger, 0, sizeof(VENG_Finger));
+			finger->active = true;
+			finger->id = touch.id;
+			finger->state = VENG_FINGER_PRESSED;
+			finger->down_time = touch.timestamp;
+			finger->start = point;
+			finger->reported = point;
+			__AddSample(finger, point, touch.timestamp);
+			continue;
+		}
+		__AddSample(finger, point, touch.timestamp);
+		finger->moved = finger->moved || point.x != finger->reported.x || point.y != finger->reported.y;
+		if (finger->state != VENG_FINGER_DRAGGING && __BeyondSlop(finger))
+		{
+			finger->state = VENG_FINGER_DRAGGING;
+			__Emit(screen, finger, VENG_GESTURE_DRAG_BEGIN, touch.timestamp);
+		}
+		if (touch.type != SDL_FINGERUP)
+		{
+			continue;
+		}
+		if (finger->state == VENG_FINGER_DRAGGING)
+		{
+			if (finger->moved)
+			{
+				__Emit(screen, finger, VENG_GESTURE_DRAG, touch.timestamp);
+			}
+			__Emit(screen, finger, VENG_GESTURE_DRAG_END, touch.timestamp);
+			SDL_FPoint velocity = __Velocity(finger);
+			if (velocity.x * velocity.x + velocity.y * velocity.y >= config.swipe_velocity * config.swipe_velocity)
+			{
+				__Emit(screen, finger, VENG_GESTURE_SWIPE, touch.timestamp);
+			}
+		}
+		else if (finger->state == VENG_FINGER_PRESSED && touch.timestamp - finger->down_time <= config.tap_ms)
+		{
+			__Emit(screen, finger, VENG_GESTURE_TAP, touch.timestamp);
+		}
+		finger->active = false;
+	}
+	touches_count = 0;
+
+	Uint32 now = SDL_GetTicks();
+	for (size_t i = 0; i < MAX_FINGERS; i++)
+	{
+		VENG_Finger* finger = &fingers[i];
+		if (!finger->active)
+		{
+			continue;
+		}
+		if (finger->state == VENG_FINGER_DRAGGING && finger->moved)
+		{
+			__Emit(screen, finger, VENG_GESTURE_DRAG, finger->times[(finger->samples_count - 1) & (FINGER_SAMPLES - 1)]);
+		}
+		else if (finger->state == VENG_FINGER_PRESSED && now - finger->down_time >= config.long_press_ms)
+		{
+			finger->state = VENG_FINGER_LONG_PRESSED;
+			__Emit(screen, finger, VENG_GESTURE_LONG_PRESS, now);
+		}
+	}
+	return 0;
+}
+
+int VENG_PredictFinger(SDL_FingerID finger_id, Uint32 ahead_ms, SDL_Point* point)
+{
+	if (!VENG_HasStarted())
+	{
+		printf("VENG is not initialized yet\n");
+		return 1;
+	}
+	if (point == NULL)
+	{
+		printf("Point is NULL\n");
+		return 1;
+	}
+	VENG_Finger* finger = __GetFinger(finger_id, false);
+	if (finger == NULL)
+	{
+		printf("Finger isn't down\n");
+		return 1;
+	}
+	*point = __Predict(finger, __Velocity(finger), ahead_ms);
+	return 0;
+}
+
+int VENG_SetGestureConfig(VENG_GestureConfig new_config)
+{
+	if (!VENG_HasStarted())
+	{
+		printf("VENG is not initialized yet\n");
+		return 1;
+	}
+	if (new_config.slop < 0 || new_config.swipe_velocity <= 0)
+	{
+		printf("Slop can't be negative and swipe velocity must be positive\n");
+		return 1;
+	}
+	config = new_config;
+	return 0;
+}
+
+VENG_GestureConfig VENG_GetGestureConfig()
+{
+	return config;
+}
+
+/*==========================================================================*\
+ *                   			Internal usage
+\*==========================================================================*/
+void VENG_CollectTouch(SDL_Event* event)
+{
+	if (!collecting)
+	{
+		return;
+	}
+	if (touches_count >= touches_size)
+	{
+		size_t size = touches_size == 0 ? ALLOCATED_TOUCHES_START : touches_size * 2;
+		VENG_Touch* new_touches = VENG_Realloc(VENG_MEMORY_LISTENERS, touches, touches_size, size, sizeof(VENG_Touch));
+		if (new_touches == NULL)
+		{
+			printf("Couldn't allocate Touch slots\n");
+			return;
+		}
+		touches = new_touches;
+		touches_size = size;
+	}
+	touches[touches_count++] = (VENG_Touch){event->type, event->tfinger.timestamp, event->tfinger.fingerId, event->tfinger.x, event->tfinger.y};
+}
+
+void VENG_DestroyGestures()
+{
+	VENG_Free(VENG_MEMORY_LISTENERS, touches, touches_size, sizeof(VENG_Touch));
+	touches = NULL;
+	touches_size = 0;
+	touches_count = 0;
+	collecting = false;
+	memset(fingers, 0, sizeof(fingers));
+}
@@ -0,0 +1,345 @@
+#include <SDL2/SDL.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "VENG/VENG.h"
+
+// Grid layout:
+// (I)   The visible childs fill the cells in row-major order, so the cell of a child is
+//       only its index among them. One pass measures them and sizes the auto tracks.
+// (II)  Fixed and auto tracks take their size, fractions share what's left exactly (the
+//       rounding is carried over, so the tracks always add up to the drawing rect).
+// (III) A second pass sizes every child against its cell and aligns it in there.
+// Rows past the ones given repeat the last row track, so one track is enough for a table.
+
+#define GRID_ROWS_START 16
+
+struct VENG_Grid
+{
+	VENG_Track* columns;
+	size_t columns_count;
+	VENG_Track* rows;
+	size_t rows_count;
+
+	// Scratch of the last solve: track positions, one more than the tracks
+	int* column_starts;
+	size_t column_starts_size;
+	int* row_starts;
+	size_t row_starts_size;
+
+	// Kept for VENG_GridCellAt
+	size_t columns_solved, rows_solved;
+	SDL_Point origin;       // Drawing rect of the last solve
+	size_t reference;       // Slot of the first visible child
+	SDL_Point reference_at; // Its position right after the solve
+};
+
+static const VENG_Track default_column = {VENG_TRACK_FRACTION, 1.0f};
+static const VENG_Track default_row = {VENG_TRACK_AUTO, 0.0f};
+
+static VENG_Childs* __ContainerChilds(void* container)
+{
+	if (((VENG_Layer*)container)->type == VENG_TYPE_LAYER)
+	{
+		return &((VENG_Layer*)container)->childs;
+	}
+	return &((VENG_Element*)container)->childs;
+}
+
+static VENG_Track __Column(VENG_Grid* grid, size_t column)
+{
+	return grid->columns_count == 0 ? default_column : grid->columns[column];
+}
+
+static VENG_Track __Row(VENG_Grid* grid, size_t row)
+{
+	if (grid->rows_count == 0)
+	{
+		return default_row;
+	}
+	return grid->rows[SDL_min(row, grid->rows_count - 1)];
+}
+
+// starts holds the auto track sizes on entry, the track positions on return
+static void __ResolveTracks(int* starts, size_t count, VENG_Track (*track_at)(VENG_Grid*, size_t), VENG_Grid* grid, int space)
+{
+	int used = 0;
+	double fractions = 0;
+	for (size_t i = 0; i < count; i++)
+	{
+		VENG_Track track = track_at(grid, i);
+		if (track.type == VENG_TRACK_FIXED)
+		{
+			starts[i] = track.value;
+		}
+		else if (track.type == VENG_TRACK_FRACTION)
+		{
+			starts[i] = 0;
+			fractions += track.value;
+		}
+		used += starts[i];
+	}
+	int left = SDL_max(space - used, 0);
+	double fraction_sum = 0;
+	int given = 0, position = 0;
+	for (size_t i = 0; i < count; i++)
+	{
+		VENG_Track track = track_at(grid, i);
+		int size = starts[i];
+		if (track.type == VENG_TRACK_FRACTION && fractions > 0)
+		{
+			fraction_sum += track.value;
+			int share = floor(left * (fraction_sum / fractions) + 0.5);
+			size = share - given;
+			given = share;
+		}
+		starts[i] = position;
+		position += size;
+	}
+	starts[count] = position;
+}
+
+static int __AlignIn(VENG_Align align, int start, int space, int size)
+{
+	switch (align)
+	{
+		case VENG_CENTER:
+			return start + (space - size) / 2;
+		case VENG_RIGHT:
+		case VENG_BOTTOM:
+			return start + space - size;
+		default:
+			return start;
+	}
+}
+
+// Track that holds the position, (size_t)-1 outside of them
+static size_t __FindTrack(const int* starts, size_t count, int position)
+{
+	if (count == 0 || position < starts[0] || position >= starts[count])
+	{
+		return (size_t)-1;
+	}
+	size_t low = 0, high = count; // starts[low] <= position < starts[high]
+	while (high - low > 1)
+	{
+		size_t middle = low + (high - low) / 2;
+		if (starts[middle] <= position)
+		{
+			low = middle;
+		}
+		else
+		{
+			high = middle;
+		}
+	}
+	return low;
+}
+
+static int __Reserve(int** starts, size_t* size, size_t needed)
+{
+	if (needed <= *size)
+	{
+		return 0;
+	}
+	needed = SDL_max(needed, GRID_ROWS_START);
+	int* new_starts = VENG_Realloc(VENG_MEMORY_CHILDS, *starts, *size, needed, sizeof(int));
+	if (new_starts == NULL)
+	{
+		printf("Couldn't allocate Grid tracks\n");
+		return 1;
+	}
+	*starts = new_starts;
+	*size = needed;
+	return 0;
+}
+
+/*==========================================================================*\
+ *                   				 Grid
+\*==========================================================================*/
+int VENG_SetGridTracks(void* container, const VENG_Track* columns, size_t columns_count, const VENG_Track* rows, size_t rows_count)
+{
+	if (!VENG_HasStarted())
+	{
+		printf("VENG is not initialized yet\n");
+		return 1;
+	}
+	if (container == NULL || columns == NULL || columns_count == 0 || (rows == NULL && rows_count != 0))
+	{
+		printf("Container is NULL or there are no columns\n");
+		return 1;
+	}
+	for (size_t i = 0; i < columns_count + rows_count; i++)
+	{
+		VENG_Track track = i < columns_count ? columns[i] : rows[i - columns_count];
+		if (track.value < 0 || track.type < VENG_TRACK_FIXED || track.type > VENG_TRACK_AUTO)
+		{
+			printf("Invalid track\n");
+			return 1;
+		}
+	}
+	VENG_Childs* childs = __ContainerChilds(container);
+	if (childs->grid == NULL)
+	{
+		childs->grid = VENG_Alloc(VENG_MEMORY_CHILDS, 1, sizeof(VENG_Grid));
+		if (childs->grid == NULL)
+		{
+			printf("Couldn't allocate Grid\n");
+			return 1;
+		}
+	}
+	VENG_Grid* grid = childs->grid;
+	VENG_Track* new_columns = VENG_Alloc(VENG_MEMORY_CHILDS, columns_count, sizeof(VENG_Track));
+	VENG_Track* new_rows = rows_count != 0 ? VENG_Alloc(VENG_MEMORY_CHILDS, rows_count, sizeof(VENG_Track)) : NULL;
+	if (new_columns == NULL || (rows_count != 0 && new_rows == NULL))
+	{
+		printf("Couldn't allocate Grid tracks\n");
+		VENG_Free(VENG_MEMORY_CHILDS, new_columns, columns_count, sizeof(VENG_Track));
+		VENG_Free(VENG_MEMORY_CHILDS, new_rows, rows_count, sizeof(VENG_Track));
+		return 1;
+	}
+	VENG_Free(VENG_MEMORY_CHILDS, grid->columns, grid->columns_count, sizeof(VENG_Track));
+	VENG_Free(VENG_MEMORY_CHILDS, grid->rows, grid->rows_count, sizeof(VENG_Track));
+	memcpy(new_columns, columns, columns_count * sizeof(VENG_Track));
+	if (rows_count != 0)
+	{
+		memcpy(new_rows, rows, rows_count * sizeof(VENG_Track));
+	}
+	grid->columns = new_columns;
+	grid->columns_count = columns_count;
+	grid->rows = new_rows;
+	grid->rows_count = rows_count;
+	VENG_TouchContainer(container);
+	return 0;
+}
+
+/*==========================================================================*\
+ *                   			Internal usage
+\*==========================================================================*/
+int VENG_SolveGrid(VENG_Childs* childs, VENG_Layout* layout, SDL_Rect drawing_rect)
+{
+	if (childs->grid == NULL)
+	{
+		childs->grid = VENG_Alloc(VENG_MEMORY_CHILDS, 1, sizeof(VENG_Grid));
+		if (childs->grid == NULL)
+		{
+			printf("Couldn't allocate Grid\n");
+			return 1;
+		}
+	}
+	VENG_Grid* grid = childs->grid;
+	size_t columns = SDL_max(grid->columns_count, 1); // Without tracks, a single fraction column
+	size_t rows = (childs->sub_elements_count + columns - 1) / columns;
+	if (__Reserve(&grid->column_starts, &grid->column_starts_size, columns + 1) != 0 || __Reserve(&grid->row_starts, &grid->row_starts_size, rows + 1) != 0)
+	{
+		return 1;
+	}
+	int* column_starts = grid->column_starts;
+	int* row_starts = grid->row_starts;
+	memset(column_starts, 0, (columns + 1) * sizeof(int));
+	memset(row_starts, 0, (rows + 1) * sizeof(int));
+
+	// (I) Sizes against the container, kept by the childs in auto tracks
+	size_t cell = 0;
+	for (size_t i = 0; i < childs->sub_elements_size; i++)
+	{
+		VENG_Element* child = childs->sub_elements[i];
+		if (child == NULL)
+		{
+			continue;
+		}
+		if (!child->visible)
+		{
+			child->rect = (SDL_Rect){-1, -1, -1, -1};
+			continue;
+		}
+		SDL_Point size = VENG_GetElementSize(child, drawing_rect);
+		child->rect.w = size.x;
+		child->rect.h = size.y;
+		size_t column = cell % columns, row = cell / columns;
+		if (__Column(grid, column).type == VENG_TRACK_AUTO)
+		{
+			column_starts[column] = SDL_max(column_starts[column], size.x);
+		}
+		if (__Row(grid, row).type == VENG_TRACK_AUTO)
+		{
+			row_starts[row] = SDL_max(row_starts[row], size.y);
+		}
+		cell++;
+	}
+	rows = (cell + columns - 1) / columns; // Visible ones only
+
+	// (II)
+	__ResolveTracks(column_starts, columns, __Column, grid, drawing_rect.w);
+	__ResolveTracks(row_starts, rows, __Row, grid, drawing_rect.h);
+
+	// (III)
+	grid->columns_solved = columns;
+	grid->rows_solved = rows;
+	grid->origin = (SDL_Point){drawing_rect.x, drawing_rect.y};
+	cell = 0;
+	for (size_t i = 0; i < childs->sub_elements_size; i++)
+	{
+		VENG_Element* child = childs->sub_elements[i];
+		if (child == NULL || !child->visible)
+		{
+			continue;
+		}
+		size_t column = cell % columns, row = cell / columns;
+		SDL_Rect cell_rect = {drawing_rect.x + column_starts[column], drawing_rect.y + row_starts[row],
+							  column_starts[column + 1] - column_starts[column], row_starts[row + 1] - row_starts[row]};
+		SDL_Point size = VENG_GetElementSize(child, cell_rect);
+		if (__Column(grid, column).type != VENG_TRACK_AUTO)
+		{
+			child->rect.w = size.x;
+		}
+		if (__Row(grid, row).type != VENG_TRACK_AUTO)
+		{
+			child->rect.h = size.y;
+		}
+		child->rect.x = __AlignIn(layout->align_horizontal, cell_rect.x, cell_rect.w, child->rect.w);
+		child->rect.y = __AlignIn(layout->align_vertical, cell_rect.y, cell_rect.h, child->rect.h);
+		if (cell == 0)
+		{
+			grid->reference = i;
+			grid->reference_at = (SDL_Point){child->rect.x, child->rect.y};
+		}
+		cell++;
+	}
+	return 0;
+}
+
+// Scrolling moves the childs without solving again, the first one tells by how much
+size_t VENG_GridCellAt(VENG_Childs* childs, SDL_Point point)
+{
+	VENG_Grid* grid = childs->grid;
+	if (grid == NULL || grid->rows_solved == 0 || grid->reference >= childs->sub_elements_size || childs->sub_elements[grid->reference] == NULL)
+	{
+		return (size_t)-1;
+	}
+	SDL_Rect reference = childs->sub_elements[grid->reference]->rect;
+	size_t column = __FindTrack(grid->column_starts, grid->columns_solved, point.x - grid->origin.x - (reference.x - grid->reference_at.x));
+	size_t row = __FindTrack(grid->row_starts, grid->rows_solved, point.y - grid->origin.y - (reference.y - grid->reference_at.y));
+	if (column == (size_t)-1 || row == (size_t)-1)
+	{
+		return (size_t)-1;
+	}
+	return row * grid->columns_solved + column;
+}
+
+void VENG_FreeGrid(VENG_Childs* childs)
+{
+	if (childs->grid == NULL)
+	{
+		return;
+	}
+	VENG_Grid* grid = childs->grid;
+	VENG_Free(VENG_MEMORY_CHILDS, grid->columns, grid->columns_count, sizeof(VENG_Track));
+	VENG_Free(VENG_MEMORY_CHILDS, grid->rows, grid->rows_count, sizeof(VENG_Track));
+	VENG_Free(VENG_MEMORY_CHILDS, grid->column_starts, grid->column_starts_size, sizeof(int));
+	VENG_Free(VENG_MEMORY_CHILDS, grid->row_starts, grid->row_starts_size, sizeof(int));
+	VENG_Free(VENG_MEMORY_CHILDS, grid, 1, sizeof(VENG_Grid));
+	childs->grid = NULL;
+}
@@ -0,0 +1,330 @@
+#include <SDL2/SDL.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "VENG/VENG.h"
+
+// Input latency:
+// (I)   VENG_ListenScreen tags the event being dispatched. If its callbacks invalidate
+//       anything (every change goes through VENG_TouchContainer), it waits for the next
+//       VENG_Present with the time already spent in dispatch.
+// (II)  Layout and paint time is summed per frame, so each event gets the part done
+//       between its dispatch and the present that shows it.
+// (III) At VENG_Present, from the event timestamp to the end of SDL_RenderPresent, every
+//       stage goes into a histogram of its event type. Buckets are logarithmic (4 per
+//       power of 2, so within 25%), which keeps a histogram small and its update O(1).
+
+#define LATENCY_BUCKETS 124 // Up to 2^32 us
+#define LATENCY_TYPES 32
+#define LATENCY_PENDING 64
+
+typedef struct VENG_LatencyHistogram
+{
+	Uint32 type;
+	Uint64 counts[VENG_LATENCY_STAGES][LATENCY_BUCKETS];
+	Uint64 totals[VENG_LATENCY_STAGES];
+	Uint32 max[VENG_LATENCY_STAGES];
+} VENG_LatencyHistogram;
+
+typedef struct VENG_LatencyInput
+{
+	Uint32 type;
+	Uint64 waited_us;  // From the event timestamp to its dispatch
+	Uint64 dispatched; // Performance counter when the dispatch started
+	Uint64 dispatch_us;
+	Uint64 layout_at, paint_at; // Frame sums when the dispatch started
+} VENG_LatencyInput;
+
+static bool tracking = false;
+static Uint64 frequency = 1;
+static VENG_LatencyHistogram* histograms[LATENCY_TYPES];
+static size_t histograms_count = 0;
+static Uint64 dropped = 0;
+
+static VENG_LatencyInput current;
+static bool dispatching = false;
+static bool current_effect = false;
+static VENG_LatencyInput pending[LATENCY_PENDING];
+static size_t pending_count = 0;
+
+static Uint64 frame_layout = 0; // Counter ticks, since the last present
+static Uint64 frame_paint = 0;
+
+static Uint64 __Microseconds(Uint64 ticks)
+{
+	return ticks * 1000000 / frequency;
+}
+
+static size_t __Bucket(Uint32 us)
+{
+	if (us < 4)
+	{
+		return us;
+	}
+	int exponent = 31 - __builtin_clz(us);
+	return 4 * (exponent - 1) + ((us >> (exponent - 2)) & 3);
+}
+
+// Highest value that falls in a bucket
+static Uint32 __BucketTop(size_t bucket)
+{
+	if (bucket < 4)
+	{
+		return bucket;
+	}
+	int exponent = bucket / 4 + 1;
+	return (Uint32)(((Uint64)(4 + bucket % 4 + 1) << (exponent - 2)) - 1);
+}
+
+static VENG_LatencyHistogram* __GetHistogram(Uint32 type, bool create)
+{
+	for (size_t i = 0; i < histograms_count; i++)
+	{
+		if (histograms[i]->type == type)
+		{
+			return histograms[i];
+		}
+	}
+	if (!create || histograms_count >= LATENCY_TYPES)
+	{
+		return NULL;
+	}
+	VENG_LatencyHistogram* histogram = VENG_Alloc(VENG_MEMORY_DIAGNOSTICS, 1, sizeof(VENG_LatencyHistogram));
+	if (histogram == NULL)
+	{
+		printf("Couldn't allocate Latency histogram\n");
+		return NULL;
+	}
+	histogram->type = type;
+	histograms[histograms_count++] = histogram;
+	return histogram;
+}
+
+static void __Record(VENG_LatencyHistogram* histogram, VENG_LatencyStage stage, Uint64 us)
+{
+	Uint32 value = us > UINT32_MAX ? UINT32_MAX : us;
+	histogram->counts[stage][__Bucket(value)]++;
+	histogram->totals[stage]++;
+	if (value > histogram->max[stage])
+	{
+		histogram->max[stage] = value;
+	}
+}
+
+static Uint32 __Percentile(VENG_LatencyHistogram* histogram, VENG_LatencyStage stage, double percentile)
+{
+	Uint64 rank = histogram->totals[stage] * percentile;
+	Uint64 seen = 0;
+	for (size_t i = 0; i < LATENCY_BUCKETS; i++)
+	{
+		seen += histogram->counts[stage][i];
+		if (seen > rank)
+		{
+			return SDL_min(__BucketTop(i), histogram->max[stage]);
+		}
+	}
+	return histogram->max[stage];
+}
+
+/*==========================================================================*\
+ *                   				Latency
+\*==========================================================================*/
+int VENG_SetLatencyTracking(bool enabled)
+{
+	if (!VENG_HasStarted())
+	{
+		printf("VENG is not initialized yet\n");
+		return 1;
+	}
+	tracking = enabled;
+	frequency = SDL_GetPerformanceFrequency();
+	pending_count = 0;
+	dispatching = false;
+	frame_layout = 0;
+	frame_paint = 0;
+	return 0;
+}
+
+bool VENG_IsTrackingLatency()
+{
+	return tracking;
+}
+
+int VENG_GetLatencyStats(Uint32 event_type, VENG_LatencyStage stage, VENG_LatencyStats* stats)
+{
+	if (!VENG_HasStarted())
+	{
+		printf("VENG is not initialized yet\n");
+		return 1;
+	}
+	if (stats == NULL || stage < 0 || stage >= VENG_LATENCY_STAGES)
+	{
+		printf("Stats is NULL or the stage is invalid\n");
+		return 1;
+	}
+	VENG_LatencyHistogram* histogram = __GetHistogram(event_type, false);
+	if (histogram == NULL || histogram->totals[stage] == 0)
+	{
+		*stats = (VENG_LatencyStats){0};
+		return 0;
+	}
+	stats->count = histogram->totals[stage];
+	stats->p50_us = __Percentile(histogram, stage, 0.50);
+	stats->p99_us = __Percentile(histogram, stage, 0.99);
+	stats->max_us = histogram->max[stage];
+	return 0;
+}
+
+void VENG_ResetLatencyStats()
+{
+	for (size_t i = 0; i < histograms_count; i++)
+	{
+		Uint32 type = histograms[i]->type;
+		memset(histograms[i], 0, sizeof(VENG_LatencyHistogram));
+		histograms[i]->type = type;
+	}
+	dropped = 0;
+}
+
+int VENG_PrintLatencyStats()
+{
+	if (!VENG_HasStarted())
+	{
+		printf("VENG is not initialized yet\n");
+		return 1;
+	}
+	const char* names[VENG_LATENCY_STAGES] = {"Total", "Dispatch", "Layout", "Paint", "Present"};
+	for (size_t i = 0; i < histograms_count; i++)
+	{
+		printf("Event 0x%x:\n", histograms[i]->type);
+		for (int stage = 0; stage < VENG_LATENCY_STAGES; stage++)
+		{
+			VENG_LatencyStats stats;
+			VENG_GetLatencyStats(histograms[i]->type, stage, &stats);
+			printf("\t%-8s count: %llu ; p50: %u us ; p99: %u us ; max: %u us\n", names[stage], (unsigned long long)stats.count, stats.p50_us, stats.p99_us, stats.max_us);
+		}
+	}
+	if (dropped > 0)
+	{
+		printf("%llu events waiting for a present were dropped\n", (unsigned long long)dropped);
+	}
+	return 0;
+}
+
+/*==========================================================================*\
+ *                   			Internal usage
+\*==========================================================================*/
+void VENG_LatencyDispatch(SDL_Event* event)
+{
+	if (!tracking || dispatching)
+	{
+		return; // Nested dispatches belong to the outer event
+	}
+	Uint32 now = SDL_GetTicks();
+	current.type = event->type;
+	current.waited_us = SDL_TICKS_PASSED(now, event->common.timestamp) ? (Uint64)(now - event->common.timestamp) * 1000 : 0;
+	current.dispatched = SDL_GetPerformanceCounter();
+	current.layout_at = frame_layout;
+	current.paint_at = frame_paint;
+	current_effect = false;
+	dispatching = true;
+}
+
+void VENG_LatencyDispatched()
+{
+	if (!dispatching)
+	{
+		return;
+	}
+	dispatching = false;
+	if (!current_effect)
+	{
+		return; // Nothing will show it
+	}
+	// Layouts run by the callbacks count as layout
+	Uint64 spent = SDL_GetPerformanceCounter() - current.dispatched;
+	Uint64 nested = (frame_layout - current.layout_at) + (frame_paint - current.paint_at);
+	current.dispatch_us = __Microseconds(spent > nested ? spent - nested : 0);
+	if (pending_count >= LATENCY_PENDING)
+	{
+		dropped++;
+		return;
+	}
+	pending[pending_count++] = current;
+}
+
+void VENG_LatencyEffect()
+{
+	if (dispatching)
+	{
+		current_effect = true;
+	}
+}
+
+Uint64 VENG_LatencyBegin()
+{
+	return tracking ? SDL_GetPerformanceCounter() : 0;
+}
+
+void VENG_LatencyEnd(VENG_LatencyStage stage, Uint64 start)
+{
+	if (!tracking || start == 0)
+	{
+		return;
+	}
+	Uint64 spent = SDL_GetPerformanceCounter() - start;
+	if (stage == VENG_LATENCY_LAYOUT)
+	{
+		frame_layout += spent;
+	}
+	else if (stage == VENG_LATENCY_PAINT)
+	{
+		frame_paint += spent;
+	}
+}
+
+// present_start: VENG_LatencyBegin() at the top of VENG_Present
+void VENG_LatencyPresent(Uint64 present_start)
+{
+	if (!tracking)
+	{
+		return;
+	}
+	Uint64 now = SDL_GetPerformanceCounter();
+	Uint64 present_us = present_start != 0 ? __Microseconds(now - present_start) : 0;
+	for (size_t i = 0; i < pending_count; i++)
+	{
+		VENG_LatencyInput* input = &pending[i];
+		VENG_LatencyHistogram* histogram = __GetHistogram(input->type, true);
+		if (histogram == NULL)
+		{
+			dropped++;
+			continue;
+		}
+		__Record(histogram, VENG_LATENCY_TOTAL, input->waited_us + __Microseconds(now - input->dispatched));
+		__Record(histogram, VENG_LATENCY_DISPATCH, input->dispatch_us);
+		__Record(histogram, VENG_LATENCY_LAYOUT, __Microseconds(frame_layout - input->layout_at));
+		__Record(histogram, VENG_LATENCY_PAINT, __Microseconds(frame_paint - input->paint_at));
+		__Record(histogram, VENG_LATENCY_PRESENT, present_us);
+	}
+	pending_count = 0;
+	frame_layout = 0;
+	frame_paint = 0;
+}
+
+void VENG_DestroyLatency()
+{
+	for (size_t i = 0; i < histograms_count; i++)
+	{
+		VENG_Free(VENG_MEMORY_DIAGNOSTICS, histograms[i], 1, sizeof(VENG_LatencyHistogram));
+		histograms[i] = NULL;
+	}
+	histograms_count = 0;
+	tracking = false;
+	dispatching = false;
+	pending_count = 0;
+	dropped = 0;
+	frame_layout = 0;
+	frame_paint = 0;
+}
@@ -0,0 +1,204 @@
+#include <SDL2/SDL.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "VENG/VENG.h"
+
+// Lazy subtrees:
+// (I)   A lazy element starts without sub-elements (not even their slots). The first
+//       VENG_PrepareElements of it while it's visible calls the builder.
+// (II)  Layouts don't go into hidden elements anymore, so a built element that is laid out
+//       hidden is put in a small list with the time it was first seen hidden.
+// (III) Once per frame VENG_Present walks that list: elements shown again leave it, the ones
+//       hidden for longer than their release time lose their sub-elements until shown again.
+
+#define ALLOCATED_HIDDEN_START 8
+
+struct VENG_Lazy
+{
+	VENG_BuildCallback build;
+	Uint32 release_ms; // 0 = never released
+	bool built;
+
+	Uint32 hidden_since;
+	size_t hidden_slot; // Index in the hidden list + 1, 0 = not in it
+};
+
+static VENG_Element** hidden = NULL;
+static size_t hidden_size = 0;
+static size_t hidden_count = 0;
+
+static void __Unlist(VENG_Element* element)
+{
+	VENG_Lazy* lazy = element->lazy;
+	if (lazy->hidden_slot == 0)
+	{
+		return;
+	}
+	VENG_Element* last = hidden[--hidden_count];
+	hidden[lazy->hidden_slot - 1] = last;
+	last->lazy->hidden_slot = lazy->hidden_slot;
+	lazy->hidden_slot = 0;
+}
+
+// Destroys the sub-elements and their slots, the builder makes them again
+static void __Release(VENG_Element* element)
+{
+	VENG_Childs* childs = &element->childs;
+	// Laying the element out here would build it again right away
+	VENG_DestroyChilds(element);
+	VENG_FreeAnchors(childs);
+	VENG_Free(VENG_MEMORY_CHILDS, childs->sub_elements, childs->sub_elements_size, sizeof(VENG_Element*));
+	childs->sub_elements = NULL;
+	childs->sub_elements_count = 0;
+	element->lazy->built = false;
+	VENG_TouchContainer(element);
+}
+
+/*==========================================================================*\
+ *                   				 Lazy
+\*==========================================================================*/
+int VENG_SetElementBuilder(VENG_Element* element, VENG_BuildCallback build, Uint32 release_ms)
+{
+	if (!VENG_HasStarted())
+	{
+		printf("VENG is not initialized yet\n");
+		return 1;
+	}
+	if (element == NULL)
+	{
+		printf("Element is NULL\n");
+		return 1;
+	}
+	if (build == NULL)
+	{
+		VENG_FreeLazy(element);
+		return 0;
+	}
+	if (element->lazy == NULL)
+	{
+		if (element->childs.sub_elements_count != 0 || element->childs.sub_elements_queued != 0)
+		{
+			printf("Element already has sub-elements\n");
+			return 1;
+		}
+		element->lazy = VENG_Alloc(VENG_MEMORY_ELEMENTS, 1, sizeof(VENG_Lazy));
+		if (element->lazy == NULL)
+		{
+			printf("Couldn't allocate Lazy\n");
+			return 1;
+		}
+		// The slots are allocated again by the first add
+		VENG_Free(VENG_MEMORY_CHILDS, element->childs.sub_elements, element->childs.sub_elements_size, sizeof(VENG_Element*));
+		element->childs.sub_elements = NULL;
+	}
+	element->lazy->build = build;
+	element->lazy->release_ms = release_ms;
+	if (release_ms == 0)
+	{
+		__Unlist(element);
+	}
+	VENG_TouchContainer(element);
+	return 0;
+}
+
+bool VENG_IsElementBuilt(VENG_Element* element)
+{
+	if (!VENG_HasStarted())
+	{
+		printf("VENG is not initialized yet\n");
+		return false;
+	}
+	if (element == NULL)
+	{
+		printf("Element is NULL\n");
+		return false;
+	}
+	return element->lazy == NULL || element->lazy->built;
+}
+
+/*==========================================================================*\
+ *                   			Internal usage
+\*==========================================================================*/
+void VENG_BuildSubtree(VENG_Element* element)
+{
+	VENG_Lazy* lazy = element->lazy;
+	__Unlist(element);
+	if (lazy->built)
+	{
+		return;
+	}
+	lazy->built = true;
+	if (lazy->build(element) != 0)
+	{
+		printf("Couldn't build Element sub-elements\n");
+		// Nothing half built is kept, the next layout tries again
+		__Release(element);
+	}
+}
+
+void VENG_HideSubtree(VENG_Element* element)
+{
+	VENG_Lazy* lazy = element->lazy;
+	if (!lazy->built || lazy->release_ms == 0 || lazy->hidden_slot != 0)
+	{
+		return;
+	}
+	if (hidden_count >= hidden_size)
+	{
+		VENG_Element** new_hidden = VENG_Realloc(VENG_MEMORY_CHILDS, hidden, hidden_size, hidden_size + ALLOCATED_HIDDEN_START, sizeof(VENG_Element*));
+		if (new_hidden == NULL)
+		{
+			printf("Couldn't allocate Lazy slots\n");
+			return;
+		}
+		hidden = new_hidden;
+		hidden_size += ALLOCATED_HIDDEN_START;
+	}
+	hidden[hidden_count++] = element;
+	lazy->hidden_slot = hidden_count;
+	lazy->hidden_since = SDL_GetTicks();
+}
+
+void VENG_CollectSubtrees()
+{
+	Uint32 now = SDL_GetTicks();
+	for (size_t i = 0; i < hidden_count;)
+	{
+		VENG_Element* element = hidden[i];
+		VENG_Lazy* lazy = element->lazy;
+		if (element->visible)
+		{
+			__Unlist(element);
+		}
+		else if (now - lazy->hidden_since >= lazy->release_ms && element->childs.sub_elements_queued == 0)
+		{
+			// Releasing can unlist lazy sub-elements too, slot i is looked at again
+			__Unlist(element);
+			__Release(element);
+		}
+		else
+		{
+			i++;
+		}
+	}
+}
+
+void VENG_FreeLazy(VENG_Element* element)
+{
+	if (element->lazy == NULL)
+	{
+		return;
+	}
+	__Unlist(element);
+	VENG_Free(VENG_MEMORY_ELEMENTS, element->lazy, 1, sizeof(VENG_Lazy));
+	element->lazy = NULL;
+}
+
+void VENG_DestroyLazy()
+{
+	VENG_Free(VENG_MEMORY_CHILDS, hidden, hidden_size, sizeof(VENG_Element*));
+	hidden = NULL;
+	hidden_size = 0;
+	hidden_count = 0;
+}
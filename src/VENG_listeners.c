@@ -5,9 +5,6 @@
 
 #include "VENG/VENG.h"
 
-// Pointer safety  
-static void* IS_NULL(void *ptr);
-
 #define ALLOCATED_LISTENERS_START 1
 static VENG_Listeners** listeners = NULL;
 static size_t listeners_slots_size = ALLOCATED_LISTENERS_START;
@@ -18,6 +15,31 @@ static VENG_Listener** heap_listener = NULL;
 static size_t listener_slots_size = ALLOCATED_LISTENER_START;
 static size_t listener_slots_count = 0;
 
+static size_t hover_callbacks = 0;
+static size_t listened = 0; // Listeners created for an element
+
+#define HITS_MAX_BUCKETS 16 // Childs over more buckets of an anchored container are always tried
+
+struct VENG_Hits
+{
+	bool stale; // The childs were laid out again since it was built
+	size_t* slots; // Visible childs, in slot order or bucket by bucket
+	size_t slots_size;
+	size_t slots_count;
+
+	// VENG_ANCHORED
+	size_t* buckets; // Start of each bucket in slots, the childs tried everywhere go last
+	size_t buckets_size;
+	int columns, rows;
+	SDL_Rect bounds; // Of the childs when built, split in columns x rows buckets
+	int bucket_w, bucket_h;
+	size_t reference; // Slot of the first child, scrolling moves them all alike
+	SDL_Point reference_at;
+};
+static void __UpdateHover(VENG_Layer* layer, SDL_Event* event, SDL_Point point);
+static bool __ListenLayer(SDL_Event* event, VENG_Layer* layer);
+static void __ListenScreen(SDL_Event* event, VENG_Screen* screen);
+
 int VENG_ListenScreen(SDL_Event* event, VENG_Screen* screen)
 {
 	if (!VENG_HasStarted())
@@ -30,28 +52,82 @@ int VENG_ListenScreen(SDL_Event* event, VENG_Screen* screen)
 		printf("Error, NULL pointer in event or screen\n");
 		return 1;
 	}
-	else if (screen->layers == NULL || screen->layers_size == 0 || screen->layers_count == 0)
+	// Events of other windows aren't for this screen
+	if (!VENG_IsEventForScreen(event, screen))
 	{
-		printf("Warning: The screen given doesnt provide any layer\n");
 		return 0;
 	}
-	else if (listeners == NULL)
+	// The window being painted is still the one VENG_Present shows afterwards, unless a
+	// callback switched to another one on purpose (VENG_SetScreen, VENG_DrawScreen)
+	size_t previous = VENG_GetWindowSlot();
+	VENG_UseScreenWindow(screen);
+	size_t listened = VENG_GetWindowSlot();
+	__ListenScreen(event, screen);
+	if (VENG_GetWindowSlot() == listened)
 	{
-		listeners = IS_NULL(calloc(listeners_slots_size, sizeof(VENG_Listeners*)));
+		VENG_UseWindowSlot(previous);
 	}
-	else if (listeners_slots_count >= listeners_slots_size)
+	return 0;
+}
+
+static void __ListenScreen(SDL_Event* event, VENG_Screen* screen)
+{
+	// Gestures come from recorded finger events, replaying those makes them again
+	if (VENG_IsRecording() && VENG_GetGesture(event) == NULL)
 	{
-		listeners_slots_size += ALLOCATED_LISTENERS_START;
-		listeners = IS_NULL(realloc(listeners, listeners_slots_size * sizeof(VENG_Listeners*)));
+		VENG_RecordEvent(event);
 	}
-	for (size_t i = 0; i < screen->layers_size; i++)
+	if (event->type == SDL_FINGERDOWN || event->type == SDL_FINGERMOTION || event->type == SDL_FINGERUP)
 	{
-		if (screen->layers[i] != NULL)
+		VENG_CollectTouch(event);
+	}
+	// Pointer coordinates are mapped to the scaled resolution layers are laid out in
+	SDL_Event scaled;
+	if (VENG_ScaleEvent(event, &scaled))
+	{
+		event = &scaled;
+	}
+	if (screen->layers == NULL || screen->layers_size == 0 || screen->layers_count == 0)
+	{
+		printf("Warning: The screen given doesnt provide any layer\n");
+		return;
+	}
+	// Layers under a modal or opaque layer don't listen
+	size_t lowest = VENG_GetLowestListeningLayer(screen);
+	VENG_LatencyDispatch(event);
+	if (hover_callbacks > 0)
+	{
+		bool moved = event->type == SDL_MOUSEMOTION;
+		bool left = event->type == SDL_WINDOWEVENT && event->window.event == SDL_WINDOWEVENT_LEAVE;
+		if (moved || left)
 		{
-			if (screen->layers[i]->listeners != NULL) VENG_ListenLayer(event, screen->layers[i]);
+			SDL_Point point = moved ? (SDL_Point){event->motion.x, event->motion.y} : (SDL_Point){-1, -1};
+			for (size_t i = 0; i < screen->layers_size; i++)
+			{
+				if (screen->layers[i] != NULL) __UpdateHover(screen->layers[i], event, i >= lowest ? point : (SDL_Point){-1, -1});
+			}
 		}
 	}
-	return 0;
+	// From the top layer down, until a callback consumes the event. A layer's shortcuts go before its listeners
+	bool consumed = false;
+	for (size_t i = screen->layers_size; i > lowest && !consumed; i--)
+	{
+		VENG_Layer* layer = screen->layers[i - 1];
+		if (layer == NULL)
+		{
+			continue;
+		}
+		consumed = VENG_RunShortcut(layer->shortcuts, event);
+		if (!consumed && layer->listeners != NULL)
+		{
+			consumed = __ListenLayer(event, layer);
+		}
+	}
+	if (!consumed)
+	{
+		VENG_RunShortcut(screen->shortcuts, event);
+	}
+	VENG_LatencyDispatched();
 }
 
 int VENG_ListenLayer(SDL_Event* event, VENG_Layer* layer)
@@ -76,37 +152,35 @@ int VENG_ListenLayer(SDL_Event* event, VENG_Layer* layer)
 		printf("Error: the layer doesnt have listeners\n");
 		return 1;
 	}
-	else if (listeners == NULL)
-	{
-		listeners = IS_NULL(calloc(listeners_slots_size, sizeof(VENG_Listeners*)));
-	}
-	else if (listeners_slots_count >= listeners_slots_size)
+	__ListenLayer(event, layer);
+	return 0;
+}
+
+// Returns true if a callback consumed the event. The rest of the layer still gets it.
+static bool __ListenLayer(SDL_Event* event, VENG_Layer* layer)
+{
+	bool consumed = false;
+	if (layer->listeners->listeners == NULL)
 	{
-		listeners_slots_size += ALLOCATED_LISTENERS_START;
-		listeners = IS_NULL(realloc(listeners, listeners_slots_size * sizeof(VENG_Listeners*)));
-		for (size_t i = listeners_slots_size - ALLOCATED_LISTENERS_START; i < listeners_slots_size; i++)
-		{
-			listeners[i] = NULL;
-		}
+		return false;
 	}
 	for (size_t i = 0; i < layer->listeners->listeners_size; i++)
 	{
-		if (event->type == layer->listeners->listeners[i]->trigger)
+		VENG_Listener* listener = layer->listeners->listeners[i];
+		if (listener != NULL && event->type == listener->trigger)
 		{
-			if (layer->listeners->listeners[i] != NULL)
+			if (listener->condition == NULL || listener->condition(listener->element, event) == 0)
 			{
-				if (layer->listeners->listeners[i]->condition == NULL)
+				VENG_TraceBegin("Listener", listener->element);
+				if (listener->callback(listener->element, event) == VENG_EVENT_CONSUMED)
 				{
-					layer->listeners->listeners[i]->callback(layer->listeners->listeners[i]->element, event);
-				}
-				else if (layer->listeners->listeners[i]->condition(layer->listeners->listeners[i]->element, event) == 0)
-				{
-					layer->listeners->listeners[i]->callback(layer->listeners->listeners[i]->element, event);
+					consumed = true;
 				}
+				VENG_TraceEnd();
 			}
 		}
 	}
-	return 0;
+	return consumed;
 }
 
 int VENG_AddListenerToLayer(VENG_Listener* listener, VENG_Layer* layer)
@@ -125,12 +199,23 @@ int VENG_AddListenerToLayer(VENG_Listener* listener, VENG_Layer* layer)
 	{
 		if (listeners == NULL)
 		{
-			listeners = IS_NULL(calloc(listeners_slots_size, sizeof(VENG_Listeners*)));
+			listeners = VENG_Alloc(VENG_MEMORY_LISTENERS, listeners_slots_size, sizeof(VENG_Listeners*));
+			if (listeners == NULL)
+			{
+				printf("Couldn't allocate Listeners slots\n");
+				return -1;
+			}
 		}
 		else if (listeners_slots_count >= listeners_slots_size)
 		{
+			VENG_Listeners** new_listeners = VENG_Realloc(VENG_MEMORY_LISTENERS, listeners, listeners_slots_size, listeners_slots_size + ALLOCATED_LISTENERS_START, sizeof(VENG_Listeners*));
+			if (new_listeners == NULL)
+			{
+				printf("Couldn't allocate Listeners slots\n");
+				return -1;
+			}
+			listeners = new_listeners;
 			listeners_slots_size += ALLOCATED_LISTENERS_START;
-			listeners = IS_NULL(realloc(listeners, listeners_slots_size * sizeof(VENG_Listeners*)));
 			for (size_t i = listeners_slots_size - ALLOCATED_LISTENERS_START; i < listeners_slots_size; i++)
 			{
 				listeners[i] = NULL;
@@ -140,8 +225,17 @@ int VENG_AddListenerToLayer(VENG_Listener* listener, VENG_Layer* layer)
 		{
 			if (listeners[i] == NULL)
 			{
-				listeners[i] = (VENG_Listeners*)calloc(1, sizeof(VENG_Listeners));
-				listeners[i]->listeners = (VENG_Listener**)calloc(1, sizeof(VENG_Listener*));
+				VENG_Listeners* table = VENG_Alloc(VENG_MEMORY_LISTENERS, 1, sizeof(VENG_Listeners));
+				VENG_Listener** table_listeners = VENG_Alloc(VENG_MEMORY_LISTENERS, 1, sizeof(VENG_Listener*));
+				if (table == NULL || table_listeners == NULL)
+				{
+					printf("Couldn't allocate Listeners\n");
+					VENG_Free(VENG_MEMORY_LISTENERS, table_listeners, 1, sizeof(VENG_Listener*));
+					VENG_Free(VENG_MEMORY_LISTENERS, table, 1, sizeof(VENG_Listeners));
+					return -1;
+				}
+				listeners[i] = table;
+				listeners[i]->listeners = table_listeners;
 				listeners[i]->listeners_size = 1;
 				listeners[i]->listeners_count = 0;
 				layer->listeners = listeners[i];
@@ -152,8 +246,15 @@ int VENG_AddListenerToLayer(VENG_Listener* listener, VENG_Layer* layer)
 	}
 	else if (layer->listeners->listeners_count >= layer->listeners->listeners_size)
 	{
+		VENG_Listener** new_table = VENG_Realloc(VENG_MEMORY_LISTENERS, layer->listeners->listeners, layer->listeners->listeners_size,
+												 layer->listeners->listeners_size + ALLOCATED_LISTENER_START, sizeof(VENG_Listener*));
+		if (new_table == NULL)
+		{
+			printf("Couldn't allocate Listener slots\n");
+			return -1;
+		}
+		layer->listeners->listeners = new_table;
 		layer->listeners->listeners_size += ALLOCATED_LISTENER_START;
-		layer->listeners->listeners = (VENG_Listener**)realloc(layer->listeners->listeners, layer->listeners->listeners_size * sizeof(VENG_Listener*));
 		for (size_t i = layer->listeners->listeners_size - ALLOCATED_LISTENER_START; i < layer->listeners->listeners_size; i++)
 		{
 			layer->listeners->listeners[i] = NULL;
@@ -183,38 +284,619 @@ VENG_Listener* VENG_CreateListener(SDL_EventType trigger, VENG_ListenerCallback
 	{
 		printf("element cant be null\n");
 	}
-	else if (heap_listener == NULL)
+	if (heap_listener == NULL)
 	{
-		heap_listener = (VENG_Listener**)calloc(listener_slots_count, sizeof(VENG_Listener*));
+		heap_listener = VENG_Alloc(VENG_MEMORY_LISTENERS, listener_slots_size, sizeof(VENG_Listener*));
+		if (heap_listener == NULL)
+		{
+			printf("Couldn't allocate Listener slots\n");
+			return NULL;
+		}
 	}
 	else if (listener_slots_count >= listener_slots_size)
 	{
+		VENG_Listener** new_heap = VENG_Realloc(VENG_MEMORY_LISTENERS, heap_listener, listener_slots_size, listener_slots_size + ALLOCATED_LISTENER_START, sizeof(VENG_Listener*));
+		if (new_heap == NULL)
+		{
+			printf("Couldn't allocate Listener slots\n");
+			return NULL;
+		}
+		heap_listener = new_heap;
 		listener_slots_size += ALLOCATED_LISTENER_START;
-		heap_listener = (VENG_Listener**)realloc(heap_listener, listener_slots_size * sizeof(VENG_Listener*));
 		for (size_t i = listener_slots_size - ALLOCATED_LISTENER_START; i < listener_slots_size; i++)
 		{
 			heap_listener[i] = NULL;
 		}
 
 	}
-	VENG_Listener* to_return;
+	VENG_Listener* to_return = NULL;
 	for (size_t i = 0; i < listener_slots_size; i++)
 	{
 		if (heap_listener[i] == NULL)
 		{
-			heap_listener[i] = (VENG_Listener*)calloc(1, sizeof(VENG_Listener));
+			heap_listener[i] = VENG_Alloc(VENG_MEMORY_LISTENERS, 1, sizeof(VENG_Listener));
+			if (heap_listener[i] == NULL)
+			{
+				printf("Couldn't allocate Listener\n");
+				return NULL;
+			}
 			heap_listener[i]->trigger = trigger;
 			heap_listener[i]->callback = callback;
 			heap_listener[i]->condition = condition;
 			heap_listener[i]->element = element;
 			to_return = heap_listener[i];
 			listener_slots_count++;
+			if (element != NULL)
+			{
+				element->listeners++;
+				listened++;
+			}
 			break;
 		}
 	}
 	return to_return;
 }
 
+// Hover
+// The hovered path of each layer is kept as its deepest element plus the parent links.
+// On motion, VENG walks up from the previous hit until a rect still contains the cursor,
+// then walks down again through the lookup of each container (VENG_Hits): a binary search
+// of the flow childs, the cell under the cursor for grids, a bucket grid for anchored ones.
+// It's built the first time the childs are hovered after a layout, so a motion touches a
+// few rects per level, on a child or between them, no matter how many childs there are.
+
+static bool __HoverContains(VENG_Element* element, SDL_Point point)
+{
+	return element->visible && element->rect.w > 0 && element->rect.h > 0 && SDL_PointInRect(&point, &element->rect);
+}
+
+static VENG_Element* __HoverParent(VENG_Element* element)
+{
+	if (element->parent == NULL || ((VENG_Element*)element->parent)->type != VENG_TYPE_ELEMENT)
+	{
+		return NULL;
+	}
+	return (VENG_Element*)element->parent;
+}
+
+static size_t __HoverDepth(VENG_Element* element)
+{
+	size_t depth = 0;
+	for (; element != NULL; element = __HoverParent(element))
+	{
+		depth++;
+	}
+	return depth;
+}
+
+static int __ReserveHits(size_t** array, size_t* size, size_t needed)
+{
+	if (needed <= *size)
+	{
+		return 0;
+	}
+	size_t* new_array = VENG_Realloc(VENG_MEMORY_CHILDS, *array, *size, needed, sizeof(size_t));
+	if (new_array == NULL)
+	{
+		printf("Couldn't allocate Hover lookup\n");
+		return 1;
+	}
+	*array = new_array;
+	*size = needed;
+	return 0;
+}
+
+// Bucket range a rect covers, clamped to the grid
+static void __HitsRange(VENG_Hits* hits, SDL_Rect rect, int* x0, int* y0, int* x1, int* y1)
+{
+	*x0 = SDL_max((rect.x - hits->bounds.x) / hits->bucket_w, 0);
+	*y0 = SDL_max((rect.y - hits->bounds.y) / hits->bucket_h, 0);
+	*x1 = SDL_min((rect.x + rect.w - 1 - hits->bounds.x) / hits->bucket_w, hits->columns - 1);
+	*y1 = SDL_min((rect.y + rect.h - 1 - hits->bounds.y) / hits->bucket_h, hits->rows - 1);
+}
+
+static bool __HitsWide(int x0, int y0, int x1, int y1)
+{
+	return (x1 - x0 + 1) * (y1 - y0 + 1) > HITS_MAX_BUCKETS;
+}
+
+// Anchored childs go in every bucket they cover, counted first and placed after
+static int __BucketHits(VENG_Hits* hits, VENG_Childs* childs)
+{
+	size_t count = hits->slots_count;
+	hits->slots_count = 0;
+	hits->bounds = (SDL_Rect){0, 0, 0, 0};
+	for (size_t i = 0; i < count; i++)
+	{
+		SDL_Rect rect = childs->sub_elements[hits->slots[i]]->rect;
+		SDL_UnionRect(&hits->bounds, &rect, &hits->bounds);
+	}
+	hits->columns = 1;
+	while ((size_t)hits->columns * hits->columns < count) hits->columns++;
+	hits->rows = hits->columns;
+	hits->bucket_w = SDL_max((hits->bounds.w + hits->columns - 1) / hits->columns, 1);
+	hits->bucket_h = SDL_max((hits->bounds.h + hits->rows - 1) / hits->rows, 1);
+	size_t buckets = (size_t)hits->columns * hits->rows;
+	if (hits->bounds.w == 0 || __ReserveHits(&hits->buckets, &hits->buckets_size, buckets + 2) != 0)
+	{
+		return 1;
+	}
+	memset(hits->buckets, 0, (buckets + 2) * sizeof(size_t));
+	size_t entries = 0;
+	for (size_t i = 0; i < count; i++)
+	{
+		int x0, y0, x1, y1;
+		__HitsRange(hits, childs->sub_elements[hits->slots[i]]->rect, &x0, &y0, &x1, &y1);
+		if (__HitsWide(x0, y0, x1, y1))
+		{
+			hits->buckets[buckets + 1]++;
+			entries++;
+			continue;
+		}
+		for (int y = y0; y <= y1; y++)
+		{
+			for (int x = x0; x <= x1; x++)
+			{
+				hits->buckets[(size_t)y * hits->columns + x + 1]++;
+				entries++;
+			}
+		}
+	}
+	// The visible slots go after the entries until they are placed
+	if (__ReserveHits(&hits->slots, &hits->slots_size, entries + count) != 0)
+	{
+		return 1;
+	}
+	memmove(&hits->slots[entries], hits->slots, count * sizeof(size_t));
+	for (size_t b = 0; b <= buckets; b++)
+	{
+		hits->buckets[b + 1] += hits->buckets[b];
+	}
+	// Each bucket start is moved along as it's filled, then shifted back
+	for (size_t i = 0; i < count; i++)
+	{
+		size_t slot = hits->slots[entries + i];
+		int x0, y0, x1, y1;
+		__HitsRange(hits, childs->sub_elements[slot]->rect, &x0, &y0, &x1, &y1);
+		if (__HitsWide(x0, y0, x1, y1))
+		{
+			hits->slots[hits->buckets[buckets]++] = slot;
+			continue;
+		}
+		for (int y = y0; y <= y1; y++)
+		{
+			for (int x = x0; x <= x1; x++)
+			{
+				hits->slots[hits->buckets[(size_t)y * hits->columns + x]++] = slot;
+			}
+		}
+	}
+	memmove(&hits->buckets[1], hits->buckets, buckets * sizeof(size_t));
+	hits->buckets[0] = 0;
+	hits->slots_count = entries;
+	return 0;
+}
+
+static VENG_Hits* __BuildHits(VENG_Childs* childs, VENG_Layout* layout)
+{
+	if (childs->hits == NULL)
+	{
+		childs->hits = VENG_Alloc(VENG_MEMORY_CHILDS, 1, sizeof(VENG_Hits));
+		if (childs->hits == NULL)
+		{
+			printf("Couldn't allocate Hover lookup\n");
+			return NULL;
+		}
+		childs->hits->stale = true;
+	}
+	VENG_Hits* hits = childs->hits;
+	if (!hits->stale)
+	{
+		return hits;
+	}
+	// Flow childs are placed in slot order and grid cells are numbered the same way
+	hits->slots_count = 0;
+	if (__ReserveHits(&hits->slots, &hits->slots_size, childs->sub_elements_count) != 0)
+	{
+		return NULL;
+	}
+	for (size_t i = 0; i < childs->sub_elements_size && hits->slots_count < hits->slots_size; i++)
+	{
+		if (childs->sub_elements[i] != NULL && childs->sub_elements[i]->visible)
+		{
+			hits->slots[hits->slots_count++] = i;
+		}
+	}
+	if (layout->arrangement == VENG_ANCHORED && hits->slots_count > 0)
+	{
+		hits->reference = hits->slots[0];
+		hits->reference_at = (SDL_Point){childs->sub_elements[hits->reference]->rect.x, childs->sub_elements[hits->reference]->rect.y};
+		if (__BucketHits(hits, childs) != 0)
+		{
+			hits->slots_count = 0;
+		}
+	}
+	hits->stale = false;
+	return hits;
+}
+
+static VENG_Element* __HitSlot(VENG_Childs* childs, size_t slot, SDL_Point point)
+{
+	VENG_Element* child = slot < childs->sub_elements_size ? childs->sub_elements[slot] : NULL;
+	return child != NULL && __HoverContains(child, point) ? child : NULL;
+}
+
+static VENG_Element* __HoverFindChild(VENG_Childs* childs, VENG_Layout* layout, SDL_Point point)
+{
+	if (childs->sub_elements == NULL || childs->sub_elements_count == 0)
+	{
+		return NULL;
+	}
+	VENG_Hits* hits = __BuildHits(childs, layout);
+	if (hits == NULL || hits->slots_count == 0)
+	{
+		return NULL;
+	}
+	if (layout->arrangement == VENG_GRID)
+	{
+		size_t cell = VENG_GridCellAt(childs, point);
+		return cell < hits->slots_count ? __HitSlot(childs, hits->slots[cell], point) : NULL;
+	}
+	if (layout->arrangement == VENG_ANCHORED)
+	{
+		VENG_Element* reference = childs->sub_elements[hits->reference];
+		if (reference == NULL)
+		{
+			return NULL;
+		}
+		SDL_Point at = {point.x - (reference->rect.x - hits->reference_at.x), point.y - (reference->rect.y - hits->reference_at.y)};
+		size_t buckets = (size_t)hits->columns * hits->rows;
+		size_t first = hits->buckets[buckets], last = hits->slots_count; // Tried everywhere
+		VENG_Element* found = NULL;
+		if (SDL_PointInRect(&at, &hits->bounds))
+		{
+			size_t bucket = (size_t)((at.y - hits->bounds.y) / hits->bucket_h) * hits->columns + (at.x - hits->bounds.x) / hits->bucket_w;
+			for (size_t i = hits->buckets[bucket]; i < hits->buckets[bucket + 1]; i++)
+			{
+				// Later childs are painted over the earlier ones
+				VENG_Element* child = __HitSlot(childs, hits->slots[i], point);
+				found = child != NULL && (found == NULL || child->slot > found->slot) ? child : found;
+			}
+		}
+		for (size_t i = first; i < last; i++)
+		{
+			VENG_Element* child = __HitSlot(childs, hits->slots[i], point);
+			found = child != NULL && (found == NULL || child->slot > found->slot) ? child : found;
+		}
+		return found;
+	}
+	// Flow childs follow each other along the axis, backwards when they are end aligned
+	bool horizontal = layout->arrangement == VENG_HORIZONTAL;
+	bool backwards = horizontal ? layout->align_horizontal == VENG_RIGHT : layout->align_vertical == VENG_BOTTOM;
+	int position = horizontal ? point.x : point.y;
+	size_t low = 0, high = hits->slots_count; // The child is the last one starting at or before the point
+	while (low < high)
+	{
+		size_t middle = low + (high - low) / 2;
+		size_t index = backwards ? hits->slots_count - 1 - middle : middle;
+		VENG_Element* child = childs->sub_elements[hits->slots[index]];
+		int start = child == NULL ? position + 1 : horizontal ? child->rect.x : child->rect.y;
+		if (start <= position)
+		{
+			low = middle + 1;
+		}
+		else
+		{
+			high = middle;
+		}
+	}
+	if (low == 0)
+	{
+		return NULL;
+	}
+	return __HitSlot(childs, hits->slots[backwards ? hits->slots_count - low : low - 1], point);
+}
+
+static void __HoverEnter(VENG_Element* element, VENG_Element* common, SDL_Event* event)
+{
+	if (element == NULL || element == common)
+	{
+		return;
+	}
+	__HoverEnter(__HoverParent(element), common, event); // Outer elements are entered first
+	element->hovered = true;
+	if (element->hover != NULL)
+	{
+		element->hover(element, VENG_HOVER_ENTER, event);
+	}
+}
+
+// A point of {-1, -1} (cursor left the window) clears the layer's hovered path.
+static void __UpdateHover(VENG_Layer* layer, SDL_Event* event, SDL_Point point)
+{
+	VENG_Element* previous = layer->hovered;
+
+	// (I) Keep the part of the previous path that still contains the cursor
+	VENG_Element* deepest = previous;
+	while (deepest != NULL && !__HoverContains(deepest, point))
+	{
+		deepest = __HoverParent(deepest);
+	}
+
+	// (II) Descend from there
+	while (point.x >= 0 && point.y >= 0)
+	{
+		VENG_Element* child;
+		if (deepest == NULL)
+		{
+			child = __HoverFindChild(&layer->childs, &layer->layout, point);
+		}
+		else
+		{
+			child = __HoverFindChild(&deepest->childs, &deepest->layout, point);
+		}
+		if (child == NULL)
+		{
+			break;
+		}
+		deepest = child;
+	}
+	layer->hovered = deepest;
+
+	// (III) Leave everything below the common ancestor, then enter the new branch
+	VENG_Element* old_node = previous;
+	VENG_Element* new_node = deepest;
+	size_t old_depth = __HoverDepth(old_node);
+	size_t new_depth = __HoverDepth(new_node);
+	while (old_depth > new_depth)
+	{
+		old_node = __HoverParent(old_node);
+		old_depth--;
+	}
+	while (new_depth > old_depth)
+	{
+		new_node = __HoverParent(new_node);
+		new_depth--;
+	}
+	while (old_node != new_node)
+	{
+		old_node = __HoverParent(old_node);
+		new_node = __HoverParent(new_node);
+	}
+	VENG_Element* common = old_node;
+
+	for (VENG_Element* element = previous; element != common; element = __HoverParent(element))
+	{
+		element->hovered = false;
+		if (element->hover != NULL)
+		{
+			element->hover(element, VENG_HOVER_LEAVE, event);
+		}
+	}
+	if (deepest != common)
+	{
+		__HoverEnter(deepest, common, event);
+		return;
+	}
+	for (VENG_Element* element = deepest; element != NULL; element = __HoverParent(element))
+	{
+		if (element->hover != NULL)
+		{
+			element->hover(element, VENG_HOVER_MOVE, event);
+			break;
+		}
+	}
+}
+
+int VENG_SetHoverCallback(VENG_Element* element, VENG_HoverCallback callback)
+{
+	if (!VENG_HasStarted())
+	{
+		printf("Error, veng havent started\n");
+		return 1;
+	}
+	else if (element == NULL)
+	{
+		printf("element cant be null\n");
+		return 1;
+	}
+	if (element->hover == NULL && callback != NULL)
+	{
+		hover_callbacks++;
+	}
+	else if (element->hover != NULL && callback == NULL)
+	{
+		hover_callbacks--;
+	}
+	element->hover = callback;
+	return 0;
+}
+
+VENG_Element* VENG_GetHoveredElement(VENG_Layer* layer)
+{
+	if (!VENG_HasStarted())
+	{
+		printf("Error, veng havent started\n");
+		return NULL;
+	}
+	else if (layer == NULL)
+	{
+		printf("null ptr layer\n");
+		return NULL;
+	}
+	return layer->hovered;
+}
+
+// Memory
+static bool __InSubtree(VENG_Element* element, VENG_Element* root)
+{
+	for (; element != NULL; element = __HoverParent(element))
+	{
+		if (element == root)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+static bool __HasListeners(VENG_Element* element)
+{
+	if (element->listeners > 0)
+	{
+		return true;
+	}
+	for (size_t i = 0; element->childs.sub_elements != NULL && i < element->childs.sub_elements_size; i++)
+	{
+		if (element->childs.sub_elements[i] != NULL && __HasListeners(element->childs.sub_elements[i]))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void VENG_ForgetElement(VENG_Element* element)
+{
+	// Subtrees without listeners skip the tables
+	bool listening = listened > 0 && __HasListeners(element);
+	if (listening && listeners != NULL)
+	{
+		for (size_t i = 0; i < listeners_slots_size; i++)
+		{
+			if (listeners[i] == NULL || listeners[i]->listeners == NULL)
+			{
+				continue;
+			}
+			for (size_t k = 0; k < listeners[i]->listeners_size; k++)
+			{
+				if (listeners[i]->listeners[k] != NULL && __InSubtree(listeners[i]->listeners[k]->element, element))
+				{
+					listeners[i]->listeners[k] = NULL;
+					listeners[i]->listeners_count--;
+				}
+			}
+		}
+	}
+	VENG_ForgetShortcuts(element);
+	VENG_ForgetFocus(element);
+	if (listening && heap_listener != NULL)
+	{
+		for (size_t i = 0; i < listener_slots_size; i++)
+		{
+			if (heap_listener[i] != NULL && __InSubtree(heap_listener[i]->element, element))
+			{
+				VENG_Free(VENG_MEMORY_LISTENERS, heap_listener[i], 1, sizeof(VENG_Listener));
+				heap_listener[i] = NULL;
+				listener_slots_count--;
+				listened--;
+			}
+		}
+	}
+	// The hovered path now ends at its parent
+	void* container = element->parent;
+	while (container != NULL && ((VENG_Element*)container)->type == VENG_TYPE_ELEMENT)
+	{
+		container = ((VENG_Element*)container)->parent;
+	}
+	VENG_Layer* layer = container;
+	if (layer != NULL && __InSubtree(layer->hovered, element))
+	{
+		layer->hovered = __HoverParent(element);
+	}
+}
+
+void VENG_InvalidateHits(VENG_Childs* childs)
+{
+	if (childs->hits != NULL)
+	{
+		childs->hits->stale = true;
+	}
+}
+
+void VENG_FreeHits(VENG_Childs* childs)
+{
+	VENG_Hits* hits = childs->hits;
+	if (hits == NULL)
+	{
+		return;
+	}
+	VENG_Free(VENG_MEMORY_CHILDS, hits->slots, hits->slots_size, sizeof(size_t));
+	VENG_Free(VENG_MEMORY_CHILDS, hits->buckets, hits->buckets_size, sizeof(size_t));
+	VENG_Free(VENG_MEMORY_CHILDS, hits, 1, sizeof(VENG_Hits));
+	childs->hits = NULL;
+}
+
+// The listeners stay with their elements, only the table of the layer goes
+void VENG_FreeLayerListeners(VENG_Layer* layer)
+{
+	for (size_t i = 0; listeners != NULL && layer->listeners != NULL && i < listeners_slots_size; i++)
+	{
+		if (listeners[i] == layer->listeners)
+		{
+			VENG_Free(VENG_MEMORY_LISTENERS, listeners[i]->listeners, listeners[i]->listeners_size, sizeof(VENG_Listener*));
+			VENG_Free(VENG_MEMORY_LISTENERS, listeners[i], 1, sizeof(VENG_Listeners));
+			listeners[i] = NULL;
+			listeners_slots_count--;
+		}
+	}
+	layer->listeners = NULL;
+	layer->hovered = NULL;
+}
+
+void VENG_DestroyListeners()
+{
+	if (listeners != NULL)
+	{
+		for (size_t i = 0; i < listeners_slots_size; i++)
+		{
+			if (listeners[i] != NULL)
+			{
+				VENG_Free(VENG_MEMORY_LISTENERS, listeners[i]->listeners, listeners[i]->listeners_size, sizeof(VENG_Listener*));
+				VENG_Free(VENG_MEMORY_LISTENERS, listeners[i], 1, sizeof(VENG_Listeners));
+			}
+		}
+		VENG_Free(VENG_MEMORY_LISTENERS, listeners, listeners_slots_size, sizeof(VENG_Listeners*));
+	}
+	if (heap_listener != NULL)
+	{
+		for (size_t i = 0; i < listener_slots_size; i++)
+		{
+			VENG_Free(VENG_MEMORY_LISTENERS, heap_listener[i], 1, sizeof(VENG_Listener));
+		}
+		VENG_Free(VENG_MEMORY_LISTENERS, heap_listener, listener_slots_size, sizeof(VENG_Listener*));
+	}
+	listeners = NULL;
+	listeners_slots_size = ALLOCATED_LISTENERS_START;
+	listeners_slots_count = 0;
+	heap_listener = NULL;
+	listener_slots_size = ALLOCATED_LISTENER_START;
+	listener_slots_count = 0;
+	listened = 0;
+	hover_callbacks = 0;
+}
+
+size_t VENG_GetListenersSlack()
+{
+	size_t slack = 0;
+	if (listeners != NULL)
+	{
+		slack += (listeners_slots_size - listeners_slots_count) * sizeof(VENG_Listeners*);
+		for (size_t i = 0; i < listeners_slots_size; i++)
+		{
+			if (listeners[i] != NULL && listeners[i]->listeners != NULL)
+			{
+				slack += (listeners[i]->listeners_size - listeners[i]->listeners_count) * sizeof(VENG_Listener*);
+			}
+		}
+	}
+	if (heap_listener != NULL)
+	{
+		slack += (listener_slots_size - listener_slots_count) * sizeof(VENG_Listener*);
+	}
+	return slack;
+}
+
 // Debug
 int VENG_PrintListenersInternalHierarchy()
 {
@@ -271,13 +953,3 @@ int VENG_PrintLayerListeners(VENG_Layer* layer)
 	
 	return 0;
 }
-
-static void* IS_NULL(void *ptr) 
-{
-    if (!ptr) 
-    {
-        printf("Pointer %p is NULL\n", ptr);
-        exit(EXIT_FAILURE);
-    }
-    return ptr;
-}
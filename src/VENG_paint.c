@@ -0,0 +1,380 @@
+#include <SDL2/SDL.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "VENG/VENG.h"
+
+// Batched primitives:
+// Every primitive is tessellated into convex polygons, clipped on the CPU against the clip rect
+// set by VENG_StartDrawing, and appended to a shared vertex buffer. The buffer is drawn with a
+// single SDL_RenderGeometry call when the texture changes, when it is full, or on VENG_PaintFlush,
+// so primitives of many elements with different clip rects end up in the same call. The flush
+// first composites what the software rasterizer recorded, so both keep the draw order.
+
+#define PAINT_VERTICES_START 1024
+#define PAINT_MAX_VERTICES 65536
+#define PAINT_MAX_POLYGON 16 // Clipping a convex polygon by 4 planes adds up to 4 vertices
+
+static SDL_Vertex* paint_vertices = NULL;
+static size_t paint_vertices_size = 0;
+static size_t paint_vertices_count = 0;
+static int* paint_indices = NULL;
+static size_t paint_indices_size = 0;
+static size_t paint_indices_count = 0;
+static SDL_Texture* paint_texture = NULL;
+static size_t paint_draw_calls = 0;
+
+/*==========================================================================*\
+ *                   				Buffer
+\*==========================================================================*/
+static int __Reserve(size_t vertices, size_t indices)
+{
+	if (paint_vertices_count + vertices > PAINT_MAX_VERTICES)
+	{
+		VENG_PaintFlush();
+	}
+	if (paint_vertices_count + vertices > paint_vertices_size)
+	{
+		size_t new_size = paint_vertices_size == 0 ? PAINT_VERTICES_START : paint_vertices_size * 2;
+		while (new_size < paint_vertices_count + vertices) new_size *= 2;
+		SDL_Vertex* new_vertices = VENG_Realloc(VENG_MEMORY_TEXTURES, paint_vertices, paint_vertices_size, new_size, sizeof(SDL_Vertex));
+		if (new_vertices == NULL) return 1;
+		paint_vertices = new_vertices;
+		paint_vertices_size = new_size;
+	}
+	if (paint_indices_count + indices > paint_indices_size)
+	{
+		size_t new_size = paint_indices_size == 0 ? PAINT_VERTICES_START * 3 : paint_indices_size * 2;
+		while (new_size < paint_indices_count + indices) new_size *= 2;
+		int* new_indices = VENG_Realloc(VENG_MEMORY_TEXTURES, paint_indices, paint_indices_size, new_size, sizeof(int));
+		if (new_indices == NULL) return 1;
+		paint_indices = new_indices;
+		paint_indices_size = new_size;
+	}
+	return 0;
+}
+
+static SDL_Vertex __Lerp(SDL_Vertex a, SDL_Vertex b, float t)
+{
+	SDL_Vertex v;
+	v.position.x = a.position.x + (b.position.x - a.position.x) * t;
+	v.position.y = a.position.y + (b.position.y - a.position.y) * t;
+	v.tex_coord.x = a.tex_coord.x + (b.tex_coord.x - a.tex_coord.x) * t;
+	v.tex_coord.y = a.tex_coord.y + (b.tex_coord.y - a.tex_coord.y) * t;
+	v.color.r = a.color.r + (b.color.r - a.color.r) * t;
+	v.color.g = a.color.g + (b.color.g - a.color.g) * t;
+	v.color.b = a.color.b + (b.color.b - a.color.b) * t;
+	v.color.a = a.color.a + (b.color.a - a.color.a) * t;
+	return v;
+}
+
+// Sutherland-Hodgman against one edge of the clip rect
+static int __ClipEdge(SDL_Vertex* in, int n, SDL_Vertex* out, int axis, float limit, bool keep_greater)
+{
+	int count = 0;
+	for (int i = 0; i < n; i++)
+	{
+		SDL_Vertex a = in[i];
+		SDL_Vertex b = in[(i + 1) % n];
+		float pa = axis == 0 ? a.position.x : a.position.y;
+		float pb = axis == 0 ? b.position.x : b.position.y;
+		bool a_in = keep_greater ? pa >= limit : pa <= limit;
+		bool b_in = keep_greater ? pb >= limit : pb <= limit;
+		if (a_in) out[count++] = a;
+		if (a_in != b_in) out[count++] = __Lerp(a, b, (limit - pa) / (pb - pa));
+	}
+	return count;
+}
+
+static void __PushPolygon(SDL_Texture* texture, SDL_Vertex* polygon, int n)
+{
+	SDL_Renderer* renderer = VENG_GetDriver().renderer;
+	if (SDL_RenderIsClipEnabled(renderer))
+	{
+		SDL_Rect clip;
+		SDL_RenderGetClipRect(renderer, &clip);
+		float left = clip.x, top = clip.y, right = clip.x + clip.w, bottom = clip.y + clip.h;
+		bool inside = true;
+		for (int i = 0; i < n && inside; i++)
+		{
+			inside = polygon[i].position.x >= left && polygon[i].position.x <= right &&
+					 polygon[i].position.y >= top && polygon[i].position.y <= bottom;
+		}
+		if (!inside)
+		{
+			SDL_Vertex a[PAINT_MAX_POLYGON], b[PAINT_MAX_POLYGON];
+			n = __ClipEdge(polygon, n, a, 0, left, true);
+			n = __ClipEdge(a, n, b, 0, right, false);
+			n = __ClipEdge(b, n, a, 1, top, true);
+			n = __ClipEdge(a, n, b, 1, bottom, false);
+			polygon = b;
+		}
+	}
+	if (VENG_RasterPolygon(texture, polygon, n))
+	{
+		return;
+	}
+	if (texture != paint_texture)
+	{
+		VENG_PaintFlush();
+		paint_texture = texture;
+	}
+	if (n < 3 || __Reserve(n, (n - 2) * 3) != 0)
+	{
+		return;
+	}
+	int base = paint_vertices_count;
+	memcpy(&paint_vertices[paint_vertices_count], polygon, n * sizeof(SDL_Vertex));
+	paint_vertices_count += n;
+	for (int i = 1; i < n - 1; i++)
+	{
+		paint_indices[paint_indices_count++] = base;
+		paint_indices[paint_indices_count++] = base + i;
+		paint_indices[paint_indices_count++] = base + i + 1;
+	}
+}
+
+static void __PushQuad(SDL_Texture* texture, float x0, float y0, float x1, float y1, SDL_FRect uv, SDL_Color color)
+{
+	if (x1 <= x0 || y1 <= y0)
+	{
+		return;
+	}
+	SDL_Vertex quad[PAINT_MAX_POLYGON] = {
+		{{x0, y0}, color, {uv.x, uv.y}},
+		{{x1, y0}, color, {uv.x + uv.w, uv.y}},
+		{{x1, y1}, color, {uv.x + uv.w, uv.y + uv.h}},
+		{{x0, y1}, color, {uv.x, uv.y + uv.h}},
+	};
+	__PushPolygon(texture, quad, 4);
+}
+
+static int __ArcSegments(float radius)
+{
+	int segments = radius / 2;
+	return segments < 2 ? 2 : (segments > 12 ? 12 : segments);
+}
+
+int VENG_PaintFlush()
+{
+	// What was rasterized so far goes under whatever SDL draws next
+	VENG_ResolveRaster();
+	if (paint_indices_count == 0)
+	{
+		paint_vertices_count = 0;
+		return 0;
+	}
+	SDL_Renderer* renderer = VENG_GetDriver().renderer;
+	// Geometry is already clipped, the element clip rect must not apply to the whole batch
+	SDL_Rect clip;
+	bool clipped = SDL_RenderIsClipEnabled(renderer);
+	if (clipped)
+	{
+		SDL_RenderGetClipRect(renderer, &clip);
+		SDL_RenderSetClipRect(renderer, NULL);
+	}
+	int result = SDL_RenderGeometry(renderer, paint_texture, paint_vertices, paint_vertices_count, paint_indices, paint_indices_count);
+	if (clipped)
+	{
+		SDL_RenderSetClipRect(renderer, &clip);
+	}
+	paint_vertices_count = 0;
+	paint_indices_count = 0;
+	paint_draw_calls++;
+	return result == 0 ? 0 : 1;
+}
+
+size_t VENG_GetPaintDrawCalls()
+{
+	return paint_draw_calls;
+}
+
+bool VENG_PaintPending()
+{
+	return paint_indices_count > 0;
+}
+
+/*==========================================================================*\
+ *                   			  Primitives
+\*==========================================================================*/
+int VENG_PaintFillRect(SDL_Rect rect, SDL_Color color)
+{
+	if (!VENG_HasStarted())
+	{
+		printf("VENG is not initialized yet\n");
+		return 1;
+	}
+	__PushQuad(NULL, rect.x, rect.y, rect.x + rect.w, rect.y + rect.h, (SDL_FRect){0, 0, 0, 0}, color);
+	return 0;
+}
+
+int VENG_PaintBorder(SDL_Rect rect, int thickness, SDL_Color color)
+{
+	if (!VENG_HasStarted())
+	{
+		printf("VENG is not initialized yet\n");
+		return 1;
+	}
+	if (thickness <= 0)
+	{
+		return 0;
+	}
+	if (thickness * 2 >= rect.w || thickness * 2 >= rect.h)
+	{
+		return VENG_PaintFillRect(rect, color);
+	}
+	SDL_FRect none = {0, 0, 0, 0};
+	float x0 = rect.x, y0 = rect.y, x1 = rect.x + rect.w, y1 = rect.y + rect.h;
+	__PushQuad(NULL, x0, y0, x1, y0 + thickness, none, color);
+	__PushQuad(NULL, x0, y1 - thickness, x1, y1, none, color);
+	__PushQuad(NULL, x0, y0 + thickness, x0 + thickness, y1 - thickness, none, color);
+	__PushQuad(NULL, x1 - thickness, y0 + thickness, x1, y1 - thickness, none, color);
+	return 0;
+}
+
+// Corners are numbered clockwise from the top-left one
+static SDL_FPoint __CornerCenter(SDL_Rect rect, float radius, int corner)
+{
+	SDL_FPoint center;
+	center.x = (corner == 0 || corner == 3) ? rect.x + radius : rect.x + rect.w - radius;
+	center.y = (corner == 0 || corner == 1) ? rect.y + radius : rect.y + rect.h - radius;
+	return center;
+}
+
+int VENG_PaintRoundedRect(SDL_Rect rect, int radius, SDL_Color color)
+{
+	if (!VENG_HasStarted())
+	{
+		printf("VENG is not initialized yet\n");
+		return 1;
+	}
+	float r = radius;
+	if (r * 2 > rect.w) r = rect.w / 2.0f;
+	if (r * 2 > rect.h) r = rect.h / 2.0f;
+	if (r < 1)
+	{
+		return VENG_PaintFillRect(rect, color);
+	}
+	SDL_FRect none = {0, 0, 0, 0};
+	float x0 = rect.x, y0 = rect.y, x1 = rect.x + rect.w, y1 = rect.y + rect.h;
+	__PushQuad(NULL, x0 + r, y0, x1 - r, y1, none, color);
+	__PushQuad(NULL, x0, y0 + r, x0 + r, y1 - r, none, color);
+	__PushQuad(NULL, x1 - r, y0 + r, x1, y1 - r, none, color);
+
+	int segments = __ArcSegments(r);
+	for (int corner = 0; corner < 4; corner++)
+	{
+		SDL_FPoint center = __CornerCenter(rect, r, corner);
+		float start = M_PI + corner * M_PI / 2;
+		// Corner fan: the center plus the arc points
+		SDL_Vertex fan[PAINT_MAX_POLYGON];
+		fan[0] = (SDL_Vertex){center, color, {0, 0}};
+		for (int i = 0; i <= segments; i++)
+		{
+			float angle = start + (M_PI / 2) * i / segments;
+			fan[i + 1] = (SDL_Vertex){{center.x + cosf(angle) * r, center.y + sinf(angle) * r}, color, {0, 0}};
+		}
+		// Split in triangles so each one stays convex after clipping
+		for (int i = 1; i <= segments; i++)
+		{
+			SDL_Vertex triangle[PAINT_MAX_POLYGON] = {fan[0], fan[i], fan[i + 1]};
+			__PushPolygon(NULL, triangle, 3);
+		}
+	}
+	return 0;
+}
+
+int VENG_PaintRoundedBorder(SDL_Rect rect, int radius, int thickness, SDL_Color color)
+{
+	if (!VENG_HasStarted())
+	{
+		printf("VENG is not initialized yet\n");
+		return 1;
+	}
+	float r = radius;
+	if (r * 2 > rect.w) r = rect.w / 2.0f;
+	if (r * 2 > rect.h) r = rect.h / 2.0f;
+	if (r < 1)
+	{
+		return VENG_PaintBorder(rect, thickness, color);
+	}
+	if (thickness <= 0)
+	{
+		return 0;
+	}
+	float t = thickness > r ? r : thickness;
+	SDL_FRect none = {0, 0, 0, 0};
+	float x0 = rect.x, y0 = rect.y, x1 = rect.x + rect.w, y1 = rect.y + rect.h;
+	__PushQuad(NULL, x0 + r, y0, x1 - r, y0 + t, none, color);
+	__PushQuad(NULL, x0 + r, y1 - t, x1 - r, y1, none, color);
+	__PushQuad(NULL, x0, y0 + r, x0 + t, y1 - r, none, color);
+	__PushQuad(NULL, x1 - t, y0 + r, x1, y1 - r, none, color);
+
+	int segments = __ArcSegments(r);
+	for (int corner = 0; corner < 4; corner++)
+	{
+		SDL_FPoint center = __CornerCenter(rect, r, corner);
+		float start = M_PI + corner * M_PI / 2;
+		for (int i = 0; i < segments; i++)
+		{
+			float a0 = start + (M_PI / 2) * i / segments;
+			float a1 = start + (M_PI / 2) * (i + 1) / segments;
+			SDL_Vertex quad[PAINT_MAX_POLYGON] = {
+				{{center.x + cosf(a0) * r, center.y + sinf(a0) * r}, color, {0, 0}},
+				{{center.x + cosf(a1) * r, center.y + sinf(a1) * r}, color, {0, 0}},
+				{{center.x + cosf(a1) * (r - t), center.y + sinf(a1) * (r - t)}, color, {0, 0}},
+				{{center.x + cosf(a0) * (r - t), center.y + sinf(a0) * (r - t)}, color, {0, 0}},
+			};
+			__PushPolygon(NULL, quad, 4);
+		}
+	}
+	return 0;
+}
+
+int VENG_PaintNineSlice(SDL_Texture* texture, SDL_Rect source, VENG_Insets insets, SDL_Rect target, SDL_Color color)
+{
+	if (!VENG_HasStarted())
+	{
+		printf("VENG is not initialized yet\n");
+		return 1;
+	}
+	if (texture == NULL)
+	{
+		printf("Texture is NULL\n");
+		return 1;
+	}
+	int texture_w, texture_h;
+	if (SDL_QueryTexture(texture, NULL, NULL, &texture_w, &texture_h) != 0)
+	{
+		return 1;
+	}
+	// Columns and rows of the source and the target
+	float sx[4] = {source.x, source.x + insets.left, source.x + source.w - insets.right, source.x + source.w};
+	float sy[4] = {source.y, source.y + insets.top, source.y + source.h - insets.bottom, source.y + source.h};
+	float tx[4] = {target.x, target.x + insets.left, target.x + target.w - insets.right, target.x + target.w};
+	float ty[4] = {target.y, target.y + insets.top, target.y + target.h - insets.bottom, target.y + target.h};
+	for (int row = 0; row < 3; row++)
+	{
+		for (int column = 0; column < 3; column++)
+		{
+			SDL_FRect uv = {sx[column] / texture_w, sy[row] / texture_h, (sx[column + 1] - sx[column]) / texture_w, (sy[row + 1] - sy[row]) / texture_h};
+			__PushQuad(texture, tx[column], ty[row], tx[column + 1], ty[row + 1], uv, color);
+		}
+	}
+	return 0;
+}
+
+void VENG_DestroyPaint()
+{
+	VENG_Free(VENG_MEMORY_TEXTURES, paint_vertices, paint_vertices_size, sizeof(SDL_Vertex));
+	VENG_Free(VENG_MEMORY_TEXTURES, paint_indices, paint_indices_size, sizeof(int));
+	paint_vertices = NULL;
+	paint_vertices_size = 0;
+	paint_vertices_count = 0;
+	paint_indices = NULL;
+	paint_indices_size = 0;
+	paint_indices_count = 0;
+	paint_texture = NULL;
+}
@@ -0,0 +1,237 @@
+#include <SDL2/SDL.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "VENG/VENG.h"
+
+// Screen prewarming:
+// A hidden screen is laid out and painted into a snapshot texture in small steps (one
+// layer layout or one top-level element paint), as many as fit in the given budget.
+// The snapshot matches a screen generation: if anything in the screen changes between
+// two calls, the work starts over. VENG_SetScreen shows a complete snapshot on the first
+// VENG_DrawScreen instead of painting every element.
+
+#define PREWARM_LAYOUT ((size_t)-1) // The layer still has to be laid out
+
+struct VENG_Prewarm
+{
+	SDL_Texture* snapshot;
+	int w, h;
+	Uint32 generation; // Screen generation the snapshot (or the work in progress) matches
+	bool complete;
+	bool show; // Drawn by the next VENG_DrawScreen
+
+	size_t layer; // Next layer
+	size_t child; // Next top-level element of that layer, or PREWARM_LAYOUT
+};
+
+static void __FreeSnapshot(VENG_Prewarm* prewarm)
+{
+	if (prewarm->snapshot != NULL)
+	{
+		SDL_DestroyTexture(prewarm->snapshot);
+		VENG_TrackMemory(VENG_MEMORY_TEXTURES, -(long)prewarm->w * prewarm->h * 4, -1);
+		prewarm->snapshot = NULL;
+	}
+}
+
+static bool __IsValid(VENG_Screen* screen)
+{
+	VENG_Prewarm* prewarm = screen->prewarm;
+	int w, h;
+	VENG_GetLogicalSize(&w, &h);
+	return prewarm != NULL && prewarm->snapshot != NULL && prewarm->w == w && prewarm->h == h && prewarm->generation == VENG_GetScreenGeneration(screen);
+}
+
+static int __Restart(VENG_Screen* screen, int w, int h)
+{
+	VENG_Prewarm* prewarm = screen->prewarm;
+	SDL_Renderer* renderer = VENG_GetDriver().renderer;
+	if (prewarm->snapshot == NULL || prewarm->w != w || prewarm->h != h)
+	{
+		__FreeSnapshot(prewarm);
+		prewarm->snapshot = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_TARGET, w, h);
+		if (prewarm->snapshot == NULL)
+		{
+			printf("Couldn't create snapshot: %s\n", SDL_GetError());
+			return 1;
+		}
+		SDL_SetTextureBlendMode(prewarm->snapshot, SDL_BLENDMODE_BLEND);
+		prewarm->w = w;
+		prewarm->h = h;
+		VENG_TrackMemory(VENG_MEMORY_TEXTURES, (long)w * h * 4, 1);
+	}
+	SDL_Texture* target = SDL_GetRenderTarget(renderer);
+	SDL_SetRenderTarget(renderer, prewarm->snapshot);
+	SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+	SDL_RenderClear(renderer);
+	SDL_SetRenderTarget(renderer, target);
+
+	prewarm->complete = false;
+	prewarm->show = false;
+	prewarm->layer = VENG_GetLowestVisibleLayer(screen);
+	prewarm->child = PREWARM_LAYOUT;
+	return 0;
+}
+
+/*==========================================================================*\
+ *                   				Prewarm
+\*==========================================================================*/
+static int __PrewarmScreen(VENG_Screen* screen, Uint32 budget_ms, bool* done);
+int VENG_PrewarmScreen(VENG_Screen* screen, Uint32 budget_ms, bool* done)
+{
+	if (!VENG_HasStarted())
+	{
+		printf("VENG is not initialized yet\n");
+		return 1;
+	}
+	if (screen == NULL)
+	{
+		printf("Screen is NULL\n");
+		return 1;
+	}
+	if (done != NULL)
+	{
+		*done = false;
+	}
+	// Prewarming happens between frames of other windows too, the current one is given back
+	size_t previous = VENG_GetWindowSlot();
+	VENG_UseScreenWindow(screen); // The snapshot is a texture of its renderer
+	int result = __PrewarmScreen(screen, budget_ms, done);
+	VENG_UseWindowSlot(previous);
+	return result;
+}
+
+static int __PrewarmScreen(VENG_Screen* screen, Uint32 budget_ms, bool* done)
+{
+	SDL_Renderer* renderer = VENG_GetDriver().renderer;
+	if (!SDL_RenderTargetSupported(renderer))
+	{
+		// No snapshot, the layout is still worth doing
+		if (!VENG_IsScreenPrepared(screen))
+		{
+			VENG_PrepareScreen(screen);
+		}
+		if (done != NULL)
+		{
+			*done = true;
+		}
+		return 0;
+	}
+	if (screen->prewarm == NULL)
+	{
+		screen->prewarm = VENG_Alloc(VENG_MEMORY_SCREENS, 1, sizeof(VENG_Prewarm));
+		if (screen->prewarm == NULL)
+		{
+			printf("Couldn't allocate Prewarm\n");
+			return 1;
+		}
+	}
+	VENG_Prewarm* prewarm = screen->prewarm;
+	int w, h;
+	VENG_GetLogicalSize(&w, &h);
+	if (!__IsValid(screen) && __Restart(screen, w, h) != 0)
+	{
+		return 1;
+	}
+	if (prewarm->complete)
+	{
+		if (done != NULL)
+		{
+			*done = true;
+		}
+		return 0;
+	}
+
+	VENG_PaintFlush();
+	SDL_Texture* target = SDL_GetRenderTarget(renderer);
+	SDL_SetRenderTarget(renderer, prewarm->snapshot);
+	Uint32 start = SDL_GetTicks();
+	while (screen->layers != NULL && prewarm->layer < screen->layers_size)
+	{
+		VENG_Layer* layer = screen->layers[prewarm->layer];
+		if (layer == NULL)
+		{
+			prewarm->layer++;
+			continue;
+		}
+		if (prewarm->child == PREWARM_LAYOUT)
+		{
+			VENG_PrepareLayer(layer);
+			prewarm->child = 0;
+		}
+		else if (layer->childs.sub_elements != NULL && prewarm->child < layer->childs.sub_elements_size)
+		{
+			VENG_Element* element = layer->childs.sub_elements[prewarm->child++];
+			if (element == NULL)
+			{
+				continue; // Empty slots don't count against the budget
+			}
+			VENG_DrawElement(element);
+		}
+		else
+		{
+			prewarm->layer++;
+			prewarm->child = PREWARM_LAYOUT;
+		}
+		if (SDL_GetTicks() - start >= budget_ms)
+		{
+			break;
+		}
+	}
+	VENG_PaintFlush();
+	SDL_SetRenderTarget(renderer, target);
+
+	if (screen->layers == NULL || prewarm->layer >= screen->layers_size)
+	{
+		prewarm->complete = true;
+		VENG_SetScreenPrepared(screen);
+	}
+	// Our own layouts bumped the generation
+	prewarm->generation = VENG_GetScreenGeneration(screen);
+	if (done != NULL)
+	{
+		*done = prewarm->complete;
+	}
+	return 0;
+}
+
+/*==========================================================================*\
+ *                   			Internal usage
+\*==========================================================================*/
+void VENG_ShowSnapshot(VENG_Screen* screen)
+{
+	if (screen->prewarm != NULL)
+	{
+		screen->prewarm->show = screen->prewarm->complete && __IsValid(screen);
+	}
+}
+
+bool VENG_DrawSnapshot(VENG_Screen* screen)
+{
+	VENG_Prewarm* prewarm = screen->prewarm;
+	if (prewarm == NULL || !prewarm->show)
+	{
+		return false;
+	}
+	prewarm->show = false;
+	if (!__IsValid(screen))
+	{
+		return false;
+	}
+	VENG_PaintFlush();
+	SDL_RenderSetClipRect(VENG_GetDriver().renderer, NULL);
+	SDL_RenderCopy(VENG_GetDriver().renderer, prewarm->snapshot, NULL, NULL);
+	return true;
+}
+
+void VENG_FreePrewarm(VENG_Screen* screen)
+{
+	if (screen->prewarm == NULL)
+	{
+		return;
+	}
+	__FreeSnapshot(screen->prewarm);
+	VENG_Free(VENG_MEMORY_SCREENS, screen->prewarm, 1, sizeof(VENG_Prewarm));
+	screen->prewarm = NULL;
+}
@@ -0,0 +1,867 @@
+#include <SDL2/SDL.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "VENG/VENG.h"
+
+// Software rasterizer:
+// (I)   While it's enabled, paint primitives and text drawn to the frame target are recorded
+//       as commands instead of going to SDL_RenderGeometry: rects, convex polygons and
+//       texture copies, each one bounded by the clip rect of the element drawing it.
+// (II)  Commands are binned into the RASTER_TILE x RASTER_TILE tiles they touch. VENG_PaintFlush
+//       (before anything SDL draws on the frame, and by VENG_Present) rasterizes the tiles in
+//       parallel: every thread takes the next tile until none is left, so no two threads write
+//       the same pixels and the result doesn't depend on their number.
+// (III) Pixels are premultiplied while blending, so "over" is a multiply-add per channel
+//       (SSE2 kernels, scalar fallback), and made straight again at the end of each tile.
+//       Tiles drawn now or the last time are uploaded with a single SDL_UpdateTexture and the
+//       drawn ones are copied over the frame, so the draw order with SDL is kept.
+
+#define RASTER_TILE 64
+#define RASTER_MAX_THREADS 64
+#define RASTER_COMMANDS_START 256
+#define RASTER_BIN_START 16
+
+typedef enum VENG_RasterType
+{
+	RASTER_RECT,
+	RASTER_POLYGON,
+	RASTER_COPY
+} VENG_RasterType;
+
+typedef struct VENG_RasterCommand
+{
+	VENG_RasterType type;
+	SDL_Rect bounds; // Pixels it can touch, inside its clip rect and the surface
+	Uint32 color;    // ARGB, straight alpha. Tint of copies
+
+	size_t points; // RASTER_POLYGON: first point in raster_points
+	int count;
+
+	SDL_Surface* source; // RASTER_COPY
+	SDL_FRect target;    // RASTER_COPY: px
+	SDL_FRect uv;        // RASTER_COPY: source px
+} VENG_RasterCommand;
+
+typedef struct VENG_RasterBin
+{
+	Uint32* commands; // Indices in raster_commands, in draw order
+	size_t size;
+	size_t count;
+	bool drawn; // Had commands the last time, its pixels have to be cleared
+} VENG_RasterBin;
+
+typedef struct VENG_RasterSource
+{
+	SDL_Texture* texture;
+	SDL_Surface* surface;
+} VENG_RasterSource;
+
+static bool rasterizing = false;
+static int raster_threads = 0;
+static SDL_Thread* raster_workers[RASTER_MAX_THREADS];
+static SDL_sem* raster_start = NULL;
+static SDL_sem* raster_done = NULL;
+static bool raster_quit = false;
+static SDL_atomic_t next_tile;
+
+static SDL_Surface* surface = NULL;
+static SDL_Texture* texture = NULL;
+static int tiles_x = 0, tiles_y = 0;
+static VENG_RasterBin* bins = NULL;
+
+static VENG_RasterCommand* raster_commands = NULL;
+static size_t raster_commands_size = 0;
+static size_t raster_commands_count = 0;
+static SDL_FPoint* raster_points = NULL;
+static size_t raster_points_size = 0;
+static size_t raster_points_count = 0;
+
+static VENG_RasterSource* sources = NULL;
+static size_t sources_size = 0;
+static size_t sources_count = 0;
+
+static Uint32 unpremultiply[256]; // 255 / alpha in 16.16
+static bool warned_source = false;
+
+/*==========================================================================*\
+ *                   				Kernels
+\*==========================================================================*/
+static inline Uint32 __Div255(Uint32 x)
+{
+	x += 128;
+	return (x + (x >> 8)) >> 8;
+}
+
+// Straight ARGB to premultiplied
+static inline Uint32 __Premultiply(Uint32 color)
+{
+	Uint32 a = color >> 24;
+	return (a << 24) | (__Div255(((color >> 16) & 0xFF) * a) << 16) | (__Div255(((color >> 8) & 0xFF) * a) << 8) | __Div255((color & 0xFF) * a);
+}
+
+static inline Uint32 __Over(Uint32 dst, Uint32 src)
+{
+	Uint32 inv = 255 - (src >> 24);
+	Uint32 result = 0;
+	for (int shift = 0; shift < 32; shift += 8)
+	{
+		result |= (((src >> shift) & 0xFF) + __Div255(((dst >> shift) & 0xFF) * inv)) << shift;
+	}
+	return result;
+}
+
+#ifdef __SSE2__
+static inline __m128i __Div255x8(__m128i x)
+{
+	x = _mm_add_epi16(x, _mm_set1_epi16(128));
+	return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+}
+
+// src (premultiplied, 16 bits per channel) over dst
+static inline __m128i __Overx2(__m128i dst, __m128i src)
+{
+	__m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(src, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+	__m128i inv = _mm_sub_epi16(_mm_set1_epi16(255), alpha);
+	return _mm_add_epi16(src, __Div255x8(_mm_mullo_epi16(dst, inv)));
+}
+#endif
+
+// Premultiplied color over a span
+static void __FillSpan(Uint32* dst, int n, Uint32 color)
+{
+	if ((color >> 24) == 255)
+	{
+		int i = 0;
+#ifdef __SSE2__
+		__m128i value = _mm_set1_epi32(color);
+		for (; i + 4 <= n; i += 4)
+		{
+			_mm_storeu_si128((__m128i*)&dst[i], value);
+		}
+#endif
+		for (; i < n; i++)
+		{
+			dst[i] = color;
+		}
+		return;
+	}
+	if ((color >> 24) == 0)
+	{
+		return;
+	}
+	int i = 0;
+#ifdef __SSE2__
+	__m128i zero = _mm_setzero_si128();
+	__m128i src = _mm_unpacklo_epi8(_mm_set1_epi32(color), zero);
+	for (; i + 4 <= n; i += 4)
+	{
+		__m128i pixels = _mm_loadu_si128((__m128i*)&dst[i]);
+		__m128i lo = __Overx2(_mm_unpacklo_epi8(pixels, zero), src);
+		__m128i hi = __Overx2(_mm_unpackhi_epi8(pixels, zero), src);
+		_mm_storeu_si128((__m128i*)&dst[i], _mm_packus_epi16(lo, hi));
+	}
+#endif
+	for (; i < n; i++)
+	{
+		dst[i] = __Over(dst[i], color);
+	}
+}
+
+// Straight source pixels, tinted and premultiplied in place
+static void __TintSpan(Uint32* src, int n, Uint32 tint)
+{
+	int i = 0;
+#ifdef __SSE2__
+	__m128i zero = _mm_setzero_si128();
+	__m128i tint16 = _mm_unpacklo_epi8(_mm_set1_epi32(tint), zero);
+	__m128i alpha_lanes = _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0);
+	__m128i color_lanes = _mm_set_epi16(0, -1, -1, -1, 0, -1, -1, -1);
+	for (; i + 4 <= n; i += 4)
+	{
+		__m128i pixels = _mm_loadu_si128((__m128i*)&src[i]);
+		__m128i halves[2] = {_mm_unpacklo_epi8(pixels, zero), _mm_unpackhi_epi8(pixels, zero)};
+		for (int k = 0; k < 2; k++)
+		{
+			__m128i tinted = __Div255x8(_mm_mullo_epi16(halves[k], tint16));
+			__m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(tinted, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+			// The alpha lane is multiplied by 255, so it stays
+			alpha = _mm_or_si128(_mm_and_si128(alpha, color_lanes), alpha_lanes);
+			halves[k] = __Div255x8(_mm_mullo_epi16(tinted, alpha));
+		}
+		_mm_storeu_si128((__m128i*)&src[i], _mm_packus_epi16(halves[0], halves[1]));
+	}
+#endif
+	for (; i < n; i++)
+	{
+		Uint32 tinted = 0;
+		for (int shift = 0; shift < 32; shift += 8)
+		{
+			tinted |= __Div255(((src[i] >> shift) & 0xFF) * ((tint >> shift) & 0xFF)) << shift;
+		}
+		src[i] = __Premultiply(tinted);
+	}
+}
+
+// Premultiplied source pixels over a span
+static void __BlendSpan(Uint32* dst, const Uint32* src, int n)
+{
+	int i = 0;
+#ifdef __SSE2__
+	__m128i zero = _mm_setzero_si128();
+	for (; i + 4 <= n; i += 4)
+	{
+		__m128i pixels = _mm_loadu_si128((__m128i*)&dst[i]);
+		__m128i source = _mm_loadu_si128((__m128i*)&src[i]);
+		__m128i lo = __Overx2(_mm_unpacklo_epi8(pixels, zero), _mm_unpacklo_epi8(source, zero));
+		__m128i hi = __Overx2(_mm_unpackhi_epi8(pixels, zero), _mm_unpackhi_epi8(source, zero));
+		_mm_storeu_si128((__m128i*)&dst[i], _mm_packus_epi16(lo, hi));
+	}
+#endif
+	for (; i < n; i++)
+	{
+		dst[i] = __Over(dst[i], src[i]);
+	}
+}
+
+static void __UnpremultiplySpan(Uint32* dst, int n)
+{
+	for (int i = 0; i < n; i++)
+	{
+		Uint32 a = dst[i] >> 24;
+		if (a == 255 || a == 0)
+		{
+			continue; // Most pixels, and a transparent pixel is already 0
+		}
+		Uint32 scale = unpremultiply[a];
+		dst[i] = (a << 24) | ((((dst[i] >> 16) & 0xFF) * scale + 32768) >> 16 << 16) |
+				 ((((dst[i] >> 8) & 0xFF) * scale + 32768) >> 16 << 8) | (((dst[i] & 0xFF) * scale + 32768) >> 16);
+	}
+}
+
+/*==========================================================================*\
+ *                   				 Tiles
+\*==========================================================================*/
+static Uint32* __Row(int y)
+{
+	return (Uint32*)((Uint8*)surface->pixels + (size_t)y * surface->pitch);
+}
+
+static void __DrawPolygon(VENG_RasterCommand* command, SDL_Rect area, Uint32 color)
+{
+	SDL_FPoint* points = &raster_points[command->points];
+	for (int y = area.y; y < area.y + area.h; y++)
+	{
+		// Convex: the row crosses it in a single span
+		float center = y + 0.5f, left = INFINITY, right = -INFINITY;
+		for (int i = 0; i < command->count; i++)
+		{
+			SDL_FPoint a = points[i], b = points[(i + 1) % command->count];
+			if ((a.y <= center && center < b.y) || (b.y <= center && center < a.y))
+			{
+				float x = a.x + (center - a.y) * (b.x - a.x) / (b.y - a.y);
+				left = SDL_min(left, x);
+				right = SDL_max(right, x);
+			}
+		}
+		if (left > right)
+		{
+			continue;
+		}
+		int x0 = SDL_max((int)ceilf(left - 0.5f), area.x);
+		int x1 = SDL_min((int)ceilf(right - 0.5f), area.x + area.w);
+		if (x1 > x0)
+		{
+			__FillSpan(&__Row(y)[x0], x1 - x0, color);
+		}
+	}
+}
+
+static void __DrawCopy(VENG_RasterCommand* command, SDL_Rect area)
+{
+	Uint32 row[RASTER_TILE];
+	SDL_Surface* source = command->source;
+	float step_x = command->uv.w / command->target.w;
+	float step_y = command->uv.h / command->target.h;
+	for (int y = area.y; y < area.y + area.h; y++)
+	{
+		int sy = SDL_min(SDL_max((int)(command->uv.y + (y + 0.5f - command->target.y) * step_y), 0), source->h - 1);
+		const Uint32* source_row = (const Uint32*)((const Uint8*)source->pixels + (size_t)sy * source->pitch);
+		// Nearest sample, the copies VENG does are mostly 1:1
+		for (int x = 0; x < area.w; x++)
+		{
+			int sx = command->uv.x + (area.x + x + 0.5f - command->target.x) * step_x;
+			row[x] = source_row[SDL_min(SDL_max(sx, 0), source->w - 1)];
+		}
+		__TintSpan(row, area.w, command->color);
+		__BlendSpan(&__Row(y)[area.x], row, area.w);
+	}
+}
+
+static void __DrawTile(int tile)
+{
+	VENG_RasterBin* bin = &bins[tile];
+	if (bin->count == 0 && !bin->drawn)
+	{
+		return;
+	}
+	SDL_Rect rect = {(tile % tiles_x) * RASTER_TILE, (tile / tiles_x) * RASTER_TILE, RASTER_TILE, RASTER_TILE};
+	rect.w = SDL_min(rect.w, surface->w - rect.x);
+	rect.h = SDL_min(rect.h, surface->h - rect.y);
+	for (int y = rect.y; y < rect.y + rect.h; y++)
+	{
+		memset(&__Row(y)[rect.x], 0, rect.w * sizeof(Uint32));
+	}
+	for (size_t i = 0; i < bin->count; i++)
+	{
+		VENG_RasterCommand* command = &raster_commands[bin->commands[i]];
+		SDL_Rect area;
+		if (!SDL_IntersectRect(&command->bounds, &rect, &area))
+		{
+			continue;
+		}
+		switch (command->type)
+		{
+			case RASTER_RECT:
+			{
+				Uint32 color = __Premultiply(command->color);
+				for (int y = area.y; y < area.y + area.h; y++)
+				{
+					__FillSpan(&__Row(y)[area.x], area.w, color);
+				}
+				break;
+			}
+			case RASTER_POLYGON:
+				__DrawPolygon(command, area, __Premultiply(command->color));
+				break;
+			case RASTER_COPY:
+				__DrawCopy(command, area);
+				break;
+		}
+	}
+	for (int y = rect.y; y < rect.y + rect.h; y++)
+	{
+		__UnpremultiplySpan(&__Row(y)[rect.x], rect.w);
+	}
+	bin->drawn = bin->count > 0;
+}
+
+static void __RunTiles()
+{
+	int tiles = tiles_x * tiles_y;
+	for (int tile = SDL_AtomicAdd(&next_tile, 1); tile < tiles; tile = SDL_AtomicAdd(&next_tile, 1))
+	{
+		__DrawTile(tile);
+	}
+}
+
+static int __RasterWorker(void* data)
+{
+	while (true)
+	{
+		SDL_SemWait(raster_start);
+		if (raster_quit)
+		{
+			return 0;
+		}
+		__RunTiles();
+		SDL_SemPost(raster_done);
+	}
+}
+
+/*==========================================================================*\
+ *                   			   Frame
+\*==========================================================================*/
+static void __FreeFrame()
+{
+	for (int i = 0; bins != NULL && i < tiles_x * tiles_y; i++)
+	{
+		VENG_Free(VENG_MEMORY_TEXTURES, bins[i].commands, bins[i].size, sizeof(Uint32));
+	}
+	VENG_Free(VENG_MEMORY_TEXTURES, bins, tiles_x * tiles_y, sizeof(VENG_RasterBin));
+	bins = NULL;
+	if (surface != NULL)
+	{
+		VENG_TrackMemory(VENG_MEMORY_TEXTURES, -(long)surface->w * surface->h * 8, -2);
+		SDL_FreeSurface(surface);
+		SDL_DestroyTexture(texture);
+		surface = NULL;
+		texture = NULL;
+	}
+	tiles_x = 0;
+	tiles_y = 0;
+}
+
+// The surface follows the logical size
+static int __PrepareFrame()
+{
+	int w, h;
+	VENG_GetLogicalSize(&w, &h);
+	if (surface != NULL && surface->w == w && surface->h == h)
+	{
+		return 0;
+	}
+	__FreeFrame();
+	raster_commands_count = 0;
+	raster_points_count = 0;
+	surface = SDL_CreateRGBSurfaceWithFormat(0, w, h, 32, SDL_PIXELFORMAT_ARGB8888);
+	texture = SDL_CreateTexture(VENG_GetDriver().renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, w, h);
+	if (surface == NULL || texture == NULL)
+	{
+		printf("Couldn't create raster surface: %s\n", SDL_GetError());
+		if (surface != NULL) SDL_FreeSurface(surface);
+		if (texture != NULL) SDL_DestroyTexture(texture);
+		surface = NULL;
+		texture = NULL;
+		return 1;
+	}
+	SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+	VENG_TrackMemory(VENG_MEMORY_TEXTURES, (long)w * h * 8, 2);
+	// Stays transparent until the first upload
+	memset(surface->pixels, 0, (size_t)surface->pitch * h);
+	SDL_UpdateTexture(texture, NULL, surface->pixels, surface->pitch);
+	tiles_x = (w + RASTER_TILE - 1) / RASTER_TILE;
+	tiles_y = (h + RASTER_TILE - 1) / RASTER_TILE;
+	bins = VENG_Alloc(VENG_MEMORY_TEXTURES, tiles_x * tiles_y, sizeof(VENG_RasterBin));
+	if (bins == NULL)
+	{
+		printf("Couldn't allocate raster tiles\n");
+		__FreeFrame();
+		return 1;
+	}
+	return 0;
+}
+
+static SDL_Surface* __FindSource(SDL_Texture* source_texture)
+{
+	for (size_t i = 0; i < sources_count; i++)
+	{
+		if (sources[i].texture == source_texture)
+		{
+			return sources[i].surface;
+		}
+	}
+	return NULL;
+}
+
+static int __Bin(Uint32 index, SDL_Rect bounds)
+{
+	for (int ty = bounds.y / RASTER_TILE; ty <= (bounds.y + bounds.h - 1) / RASTER_TILE; ty++)
+	{
+		for (int tx = bounds.x / RASTER_TILE; tx <= (bounds.x + bounds.w - 1) / RASTER_TILE; tx++)
+		{
+			VENG_RasterBin* bin = &bins[ty * tiles_x + tx];
+			if (bin->count >= bin->size)
+			{
+				size_t size = bin->size == 0 ? RASTER_BIN_START : bin->size * 2;
+				Uint32* commands = VENG_Realloc(VENG_MEMORY_TEXTURES, bin->commands, bin->size, size, sizeof(Uint32));
+				if (commands == NULL)
+				{
+					printf("Couldn't allocate raster bin\n");
+					return 1;
+				}
+				bin->commands = commands;
+				bin->size = size;
+			}
+			bin->commands[bin->count++] = index;
+		}
+	}
+	return 0;
+}
+
+static int __ReserveCommands(size_t count)
+{
+	if (raster_commands_count + count <= raster_commands_size)
+	{
+		return 0;
+	}
+	size_t size = raster_commands_size == 0 ? RASTER_COMMANDS_START : raster_commands_size * 2;
+	while (size < raster_commands_count + count) size *= 2;
+	VENG_RasterCommand* commands = VENG_Realloc(VENG_MEMORY_TEXTURES, raster_commands, raster_commands_size, size, sizeof(VENG_RasterCommand));
+	if (commands == NULL)
+	{
+		printf("Couldn't allocate raster commands\n");
+		return 1;
+	}
+	raster_commands = commands;
+	raster_commands_size = size;
+	return 0;
+}
+
+// Drops the commands recorded since count, they are the last ones of every bin
+static void __Rollback(size_t count, size_t points)
+{
+	for (int i = 0; bins != NULL && i < tiles_x * tiles_y; i++)
+	{
+		while (bins[i].count > 0 && bins[i].commands[bins[i].count - 1] >= count)
+		{
+			bins[i].count--;
+		}
+	}
+	raster_commands_count = count;
+	raster_points_count = points;
+}
+
+/*==========================================================================*\
+ *                   				Raster
+\*==========================================================================*/
+int VENG_SetSoftwareRaster(int threads)
+{
+	if (!VENG_HasStarted())
+	{
+		printf("VENG is not initialized yet\n");
+		return 1;
+	}
+	// Stop the current workers
+	if (raster_threads > 1)
+	{
+		raster_quit = true;
+		for (int i = 0; i < raster_threads - 1; i++)
+		{
+			SDL_SemPost(raster_start);
+		}
+		for (int i = 0; i < raster_threads - 1; i++)
+		{
+			SDL_WaitThread(raster_workers[i], NULL);
+		}
+		raster_quit = false;
+	}
+	raster_threads = 0;
+	rasterizing = false;
+	raster_commands_count = 0;
+	raster_points_count = 0;
+	for (int i = 0; bins != NULL && i < tiles_x * tiles_y; i++)
+	{
+		bins[i].count = 0;
+	}
+	if (threads == 0)
+	{
+		__FreeFrame();
+		return 0;
+	}
+	if (threads < 0)
+	{
+		threads = SDL_GetCPUCount();
+	}
+	threads = SDL_max(1, SDL_min(threads, RASTER_MAX_THREADS));
+	if (raster_start == NULL)
+	{
+		raster_start = SDL_CreateSemaphore(0);
+		raster_done = SDL_CreateSemaphore(0);
+		if (raster_start == NULL || raster_done == NULL)
+		{
+			printf("Couldn't create raster semaphores: %s\n", SDL_GetError());
+			return 1;
+		}
+	}
+	for (int a = 1; a < 256; a++)
+	{
+		unpremultiply[a] = (255 * 65536 + a / 2) / a;
+	}
+	// The calling thread is the first one
+	raster_threads = 1;
+	for (int i = 0; i < threads - 1; i++)
+	{
+		raster_workers[i] = SDL_CreateThread(__RasterWorker, "VENG raster", NULL);
+		if (raster_workers[i] == NULL)
+		{
+			printf("Couldn't start raster worker: %s\n", SDL_GetError());
+			break;
+		}
+		raster_threads++;
+	}
+	rasterizing = true;
+	return 0;
+}
+
+bool VENG_IsRasterizing()
+{
+	return rasterizing;
+}
+
+int VENG_SetRasterSource(SDL_Texture* source_texture, SDL_Surface* source)
+{
+	if (!VENG_HasStarted())
+	{
+		printf("VENG is not initialized yet\n");
+		return 1;
+	}
+	if (source_texture == NULL)
+	{
+		printf("Texture is NULL\n");
+		return 1;
+	}
+	if (source != NULL && source->format->format != SDL_PIXELFORMAT_ARGB8888)
+	{
+		printf("Raster sources must be ARGB8888\n");
+		return 1;
+	}
+	for (size_t i = 0; i < sources_count; i++)
+	{
+		if (sources[i].texture == source_texture)
+		{
+			if (source == NULL)
+			{
+				sources[i] = sources[--sources_count];
+			}
+			else
+			{
+				sources[i].surface = source;
+			}
+			return 0;
+		}
+	}
+	if (source == NULL)
+	{
+		return 0;
+	}
+	if (sources_count >= sources_size)
+	{
+		size_t size = sources_size == 0 ? 8 : sources_size * 2;
+		VENG_RasterSource* new_sources = VENG_Realloc(VENG_MEMORY_TEXTURES, sources, sources_size, size, sizeof(VENG_RasterSource));
+		if (new_sources == NULL)
+		{
+			printf("Couldn't allocate raster sources\n");
+			return 1;
+		}
+		sources = new_sources;
+		sources_size = size;
+	}
+	sources[sources_count++] = (VENG_RasterSource){source_texture, source};
+	return 0;
+}
+
+/*==========================================================================*\
+ *                   			Internal usage
+\*==========================================================================*/
+bool VENG_RasterPolygon(SDL_Texture* source_texture, SDL_Vertex* polygon, int n)
+{
+	SDL_Renderer* renderer = VENG_GetDriver().renderer;
+	// Scroll caches and snapshots keep going through SDL
+	if (!rasterizing || n < 3 || !VENG_IsMainWindow() || SDL_GetRenderTarget(renderer) != VENG_GetScaleTarget())
+	{
+		return false;
+	}
+	SDL_Surface* source = NULL;
+	if (source_texture != NULL && (source = __FindSource(source_texture)) == NULL)
+	{
+		if (!warned_source)
+		{
+			printf("Texture without raster source, drawn by SDL\n");
+			warned_source = true;
+		}
+		return false;
+	}
+	if (__PrepareFrame() != 0)
+	{
+		return false;
+	}
+
+	float min_x = INFINITY, min_y = INFINITY, max_x = -INFINITY, max_y = -INFINITY;
+	float min_u = INFINITY, min_v = INFINITY, max_u = -INFINITY, max_v = -INFINITY;
+	for (int i = 0; i < n; i++)
+	{
+		min_x = SDL_min(min_x, polygon[i].position.x);
+		min_y = SDL_min(min_y, polygon[i].position.y);
+		max_x = SDL_max(max_x, polygon[i].position.x);
+		max_y = SDL_max(max_y, polygon[i].position.y);
+		min_u = SDL_min(min_u, polygon[i].tex_coord.x);
+		min_v = SDL_min(min_v, polygon[i].tex_coord.y);
+		max_u = SDL_max(max_u, polygon[i].tex_coord.x);
+		max_v = SDL_max(max_v, polygon[i].tex_coord.y);
+	}
+	// Pixels whose center is inside
+	int x0 = ceilf(min_x - 0.5f), y0 = ceilf(min_y - 0.5f);
+	SDL_Rect bounds = {x0, y0, (int)ceilf(max_x - 0.5f) - x0, (int)ceilf(max_y - 0.5f) - y0};
+	SDL_Rect limit = {0, 0, surface->w, surface->h};
+	if (SDL_RenderIsClipEnabled(renderer))
+	{
+		SDL_Rect clip;
+		SDL_RenderGetClipRect(renderer, &clip);
+		if (!SDL_IntersectRect(&clip, &limit, &limit))
+		{
+			return true;
+		}
+	}
+	if (!SDL_IntersectRect(&bounds, &limit, &bounds))
+	{
+		return true; // Nothing visible, done
+	}
+
+	bool aligned = n == 4;
+	for (int i = 0; i < n && aligned; i++)
+	{
+		aligned = (polygon[i].position.x == min_x || polygon[i].position.x == max_x) && (polygon[i].position.y == min_y || polygon[i].position.y == max_y);
+	}
+	if (source != NULL && !aligned)
+	{
+		return false; // Only axis aligned copies
+	}
+
+	if (__ReserveCommands(1) != 0)
+	{
+		return false;
+	}
+	// Batched primitives were painted before it
+	if (VENG_PaintPending())
+	{
+		VENG_PaintFlush();
+	}
+	VENG_RasterCommand* command = &raster_commands[raster_commands_count];
+	SDL_Color color = polygon[0].color;
+	command->bounds = bounds;
+	command->color = ((Uint32)color.a << 24) | ((Uint32)color.r << 16) | ((Uint32)color.g << 8) | color.b;
+	if (source != NULL)
+	{
+		command->type = RASTER_COPY;
+		command->source = source;
+		command->target = (SDL_FRect){min_x, min_y, max_x - min_x, max_y - min_y};
+		command->uv = (SDL_FRect){min_u * source->w, min_v * source->h, (max_u - min_u) * source->w, (max_v - min_v) * source->h};
+	}
+	else if (aligned)
+	{
+		command->type = RASTER_RECT;
+	}
+	else
+	{
+		if (raster_points_count + n > raster_points_size)
+		{
+			size_t size = raster_points_size == 0 ? RASTER_COMMANDS_START * 4 : raster_points_size * 2;
+			while (size < raster_points_count + n) size *= 2;
+			SDL_FPoint* points = VENG_Realloc(VENG_MEMORY_TEXTURES, raster_points, raster_points_size, size, sizeof(SDL_FPoint));
+			if (points == NULL)
+			{
+				printf("Couldn't allocate raster points\n");
+				return false;
+			}
+			raster_points = points;
+			raster_points_size = size;
+		}
+		command->type = RASTER_POLYGON;
+		command->points = raster_points_count;
+		command->count = n;
+		for (int i = 0; i < n; i++)
+		{
+			raster_points[raster_points_count++] = polygon[i].position;
+		}
+	}
+	if (__Bin(raster_commands_count, bounds) != 0)
+	{
+		return false;
+	}
+	raster_commands_count++;
+	return true;
+}
+
+bool VENG_RasterQuads(SDL_Texture* source_texture, SDL_Vertex* quads, size_t count)
+{
+	if (!rasterizing || __PrepareFrame() != 0 || __ReserveCommands(count) != 0)
+	{
+		return false;
+	}
+	// Resized and flushed before the mark, as the first quad would do it
+	if (VENG_PaintPending())
+	{
+		VENG_PaintFlush();
+	}
+	size_t mark = raster_commands_count, points = raster_points_count;
+	for (SDL_Vertex* quad = quads; quad < quads + count * 4; quad += 4)
+	{
+		SDL_Vertex polygon[4] = {quad[0], quad[1], quad[3], quad[2]};
+		if (!VENG_RasterPolygon(source_texture, polygon, 4))
+		{
+			__Rollback(mark, points);
+			return false;
+		}
+	}
+	return true;
+}
+
+// Stale tiles don't need clearing until something is drawn again
+void VENG_ResolveRaster()
+{
+	if (!rasterizing || surface == NULL || raster_commands_count == 0 || !VENG_IsMainWindow() ||
+		SDL_GetRenderTarget(VENG_GetDriver().renderer) != VENG_GetScaleTarget())
+	{
+		return;
+	}
+	// Tiles drawn now, and the ones drawn the last time that are cleared
+	SDL_Rect region = {0, 0, 0, 0}, visible = {0, 0, 0, 0};
+	for (int i = 0; i < tiles_x * tiles_y; i++)
+	{
+		if (bins[i].count == 0 && !bins[i].drawn)
+		{
+			continue;
+		}
+		SDL_Rect tile = {(i % tiles_x) * RASTER_TILE, (i / tiles_x) * RASTER_TILE, RASTER_TILE, RASTER_TILE};
+		SDL_UnionRect(&region, &tile, &region);
+		if (bins[i].count > 0)
+		{
+			SDL_UnionRect(&visible, &tile, &visible);
+		}
+	}
+
+	SDL_AtomicSet(&next_tile, 0);
+	for (int i = 0; i < raster_threads - 1; i++)
+	{
+		SDL_SemPost(raster_start);
+	}
+	__RunTiles();
+	for (int i = 0; i < raster_threads - 1; i++)
+	{
+		SDL_SemWait(raster_done);
+	}
+
+	SDL_Rect surface_rect = {0, 0, surface->w, surface->h};
+	SDL_IntersectRect(&region, &surface_rect, &region);
+	SDL_IntersectRect(&visible, &surface_rect, &visible);
+	SDL_UpdateTexture(texture, &region, (Uint8*)surface->pixels + (size_t)region.y * surface->pitch + region.x * sizeof(Uint32), surface->pitch);
+	// Commands are already clipped, the clip rect of the element drawing now must stay
+	SDL_Renderer* renderer = VENG_GetDriver().renderer;
+	SDL_Rect clip;
+	bool clipped = SDL_RenderIsClipEnabled(renderer);
+	if (clipped)
+	{
+		SDL_RenderGetClipRect(renderer, &clip);
+		SDL_RenderSetClipRect(renderer, NULL);
+	}
+	SDL_RenderCopy(renderer, texture, &visible, &visible);
+	if (clipped)
+	{
+		SDL_RenderSetClipRect(renderer, &clip);
+	}
+	for (int i = 0; i < tiles_x * tiles_y; i++)
+	{
+		bins[i].count = 0;
+	}
+	raster_commands_count = 0;
+	raster_points_count = 0;
+}
+
+void VENG_DestroyRaster()
+{
+	VENG_SetSoftwareRaster(0);
+	if (raster_start != NULL)
+	{
+		SDL_DestroySemaphore(raster_start);
+		SDL_DestroySemaphore(raster_done);
+		raster_start = NULL;
+		raster_done = NULL;
+	}
+	VENG_Free(VENG_MEMORY_TEXTURES, raster_commands, raster_commands_size, sizeof(VENG_RasterCommand));
+	VENG_Free(VENG_MEMORY_TEXTURES, raster_points, raster_points_size, sizeof(SDL_FPoint));
+	VENG_Free(VENG_MEMORY_TEXTURES, sources, sources_size, sizeof(VENG_RasterSource));
+	raster_commands = NULL;
+	raster_commands_size = 0;
+	raster_points = NULL;
+	raster_points_size = 0;
+	sources = NULL;
+	sources_size = 0;
+	sources_count = 0;
+	warned_source = false;
+}
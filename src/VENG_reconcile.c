@@ -0,0 +1,364 @@
+#include <SDL2/SDL.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "VENG/VENG.h"
+
+// Reconciliation:
+// (I)   The sub-elements of a container are matched with the described ones by key, through
+//       a hash table of the description. The ones left unmatched are destroyed.
+// (II)  Matched elements only get the properties that differ (through the update queue, so
+//       every affected container is laid out once by VENG_EndUpdate), the rest are created.
+// (III) The container then takes the described order, it's only laid out if it changed.
+// A matched node with the same non-0 version as the last time is skipped with its subtree,
+// so the work follows what changed instead of the size of the description.
+
+#define RECONCILE_KEYS_START 16 // Power of 2
+
+typedef struct VENG_KeySlot
+{
+	Uint64 key; // 0 = empty
+	size_t index;
+} VENG_KeySlot;
+
+static size_t __KeyHash(Uint64 key, size_t size)
+{
+	return (size_t)((key * 0x9E3779B97F4A7C15ULL) >> 32) & (size - 1);
+}
+
+// Index of the node with that key, count if there's none
+static size_t __FindKey(VENG_KeySlot* keys, size_t size, size_t count, Uint64 key)
+{
+	for (size_t i = __KeyHash(key, size); keys[i].key != 0; i = (i + 1) & (size - 1))
+	{
+		if (keys[i].key == key)
+		{
+			return keys[i].index;
+		}
+	}
+	return count;
+}
+
+static VENG_Childs* __ContainerChilds(void* container)
+{
+	if (((VENG_Layer*)container)->type == VENG_TYPE_LAYER)
+	{
+		return &((VENG_Layer*)container)->childs;
+	}
+	return &((VENG_Element*)container)->childs;
+}
+
+static bool __SameLayout(VENG_Layout a, VENG_Layout b)
+{
+	return a.arrangement == b.arrangement && a.align_horizontal == b.align_horizontal && a.align_vertical == b.align_vertical;
+}
+
+static void __UpdateElement(VENG_Element* element, const VENG_Node* node, VENG_ReconcileStats* stats)
+{
+	bool changed = false;
+	if (element->w != node->w || element->h != node->h || element->stretch_size != node->stretch_size)
+	{
+		element->stretch_size = node->stretch_size;
+		VENG_SetElementSize(element, node->w, node->h);
+		changed = true;
+	}
+	if (element->visible != node->visible)
+	{
+		VENG_SetElementVisible(element, node->visible);
+		changed = true;
+	}
+	if (!__SameLayout(element->layout, node->layout))
+	{
+		VENG_SetElementLayout(element, node->layout);
+		changed = true;
+	}
+	if (element->paint != node->paint)
+	{
+		VENG_SetPaintCallback(element, node->paint);
+		VENG_InvalidateElement(element);
+		changed = true;
+	}
+	if (element->focusable != node->focusable)
+	{
+		VENG_SetElementFocusable(element, node->focusable);
+		changed = true;
+	}
+	stats->changed += changed;
+}
+
+static VENG_Element* __CreateElement(const VENG_Node* node, VENG_ReconcileStats* stats)
+{
+	VENG_Element* element = VENG_CreateElement(node->w, node->h, node->stretch_size, node->visible, node->layout, SDL_max(node->max_sub_elements, node->childs_count));
+	if (element == NULL)
+	{
+		return NULL;
+	}
+	element->paint = node->paint;
+	element->focusable = node->focusable;
+	stats->created++;
+	return element;
+}
+
+static int __ReconcileChilds(void* container, const VENG_Node* nodes, size_t count, VENG_ReconcileStats* stats)
+{
+	if (count > 0 && nodes == NULL)
+	{
+		printf("Nodes are NULL\n");
+		return 1;
+	}
+	// (I)
+	size_t size = RECONCILE_KEYS_START;
+	while (size < count * 2) size *= 2;
+	VENG_KeySlot* keys = VENG_Alloc(VENG_MEMORY_CHILDS, size, sizeof(VENG_KeySlot));
+	VENG_Element** order = VENG_Alloc(VENG_MEMORY_CHILDS, SDL_max(count, 1), sizeof(VENG_Element*));
+	if (keys == NULL || order == NULL)
+	{
+		printf("Couldn't allocate Reconcile keys\n");
+		VENG_Free(VENG_MEMORY_CHILDS, keys, size, sizeof(VENG_KeySlot));
+		VENG_Free(VENG_MEMORY_CHILDS, order, SDL_max(count, 1), sizeof(VENG_Element*));
+		return 1;
+	}
+	int result = 0;
+	for (size_t i = 0; i < count && result == 0; i++)
+	{
+		size_t slot = __KeyHash(nodes[i].key, size);
+		while (keys[slot].key != 0 && keys[slot].key != nodes[i].key)
+		{
+			slot = (slot + 1) & (size - 1);
+		}
+		if (nodes[i].key == 0 || keys[slot].key != 0)
+		{
+			printf("Keys must be unique among siblings and not 0\n");
+			result = 1;
+		}
+		keys[slot] = (VENG_KeySlot){nodes[i].key, i};
+	}
+	VENG_Childs* childs = __ContainerChilds(container);
+	for (size_t i = 0; result == 0 && childs->sub_elements != NULL && i < childs->sub_elements_size; i++)
+	{
+		VENG_Element* element = childs->sub_elements[i];
+		if (element == NULL)
+		{
+			continue;
+		}
+		size_t index = element->key != 0 ? __FindKey(keys, size, count, element->key) : count;
+		if (index < count && order[index] == NULL)
+		{
+			order[index] = element;
+			continue;
+		}
+		VENG_DestroyElement(element);
+		stats->destroyed++;
+	}
+
+	// (II)
+	for (size_t i = 0; i < count && result == 0; i++)
+	{
+		const VENG_Node* node = &nodes[i];
+		VENG_Element* element = order[i];
+		if (element == NULL)
+		{
+			element = order[i] = __CreateElement(node, stats);
+			if (element == NULL)
+			{
+				result = 1;
+				break;
+			}
+		}
+		else if (node->version != 0 && element->version == node->version)
+		{
+			stats->skipped++;
+			continue;
+		}
+		else
+		{
+			__UpdateElement(element, node, stats);
+		}
+		element->key = node->key;
+		element->version = node->version;
+		// Sub-elements of lazy elements belong to their builder
+		if (element->lazy == NULL && __ReconcileChilds(element, node->childs, node->childs_count, stats) != 0)
+		{
+			element->version = 0; // Compared again next time
+			result = 1;
+		}
+	}
+
+	// (III)
+	if (result == 0)
+	{
+		result = VENG_SetChilds(container, order, count);
+	}
+	if (result != 0)
+	{
+		// Created elements that didn't make it in
+		for (size_t i = 0; i < count; i++)
+		{
+			if (order[i] != NULL && order[i]->parent == NULL)
+			{
+				VENG_DestroyElement(order[i]);
+			}
+		}
+	}
+	VENG_Free(VENG_MEMORY_CHILDS, keys, size, sizeof(VENG_KeySlot));
+	VENG_Free(VENG_MEMORY_CHILDS, order, SDL_max(count, 1), sizeof(VENG_Element*));
+	return result;
+}
+
+/*==========================================================================*\
+ *                   				Reconcile
+\*==========================================================================*/
+int VENG_ReconcileLayer(VENG_Layer* layer, const VENG_Node* childs, size_t count, VENG_ReconcileStats* stats)
+{
+	if (!VENG_HasStarted())
+	{
+		printf("VENG is not initialized yet\n");
+		return 1;
+	}
+	if (layer == NULL)
+	{
+		printf("Layer is NULL\n");
+		return 1;
+	}
+	VENG_ReconcileStats local = {0};
+	if (stats == NULL)
+	{
+		stats = &local;
+	}
+	VENG_BeginUpdate();
+	int result = __ReconcileChilds(layer, childs, count, stats);
+	return VENG_EndUpdate() || result;
+}
+
+int VENG_ReconcileScreen(VENG_Screen* screen, const VENG_LayerNode* layers, size_t count, VENG_ReconcileStats* stats)
+{
+	if (!VENG_HasStarted())
+	{
+		printf("VENG is not initialized yet\n");
+		return 1;
+	}
+	if (screen == NULL || (layers == NULL && count > 0) || count > screen->layers_size)
+	{
+		printf("Screen is NULL or there are more layers than it can hold\n");
+		return 1;
+	}
+	// Screens hold a few layers, a linear search is enough
+	for (size_t i = 0; i < count; i++)
+	{
+		bool repeated = layers[i].key == 0;
+		for (size_t k = 0; k < i && !repeated; k++)
+		{
+			repeated = layers[i].key == layers[k].key;
+		}
+		if (repeated)
+		{
+			printf("Keys must be unique among layers and not 0\n");
+			return 1;
+		}
+	}
+	VENG_Layer** order = VENG_Alloc(VENG_MEMORY_CHILDS, SDL_max(count, 1), sizeof(VENG_Layer*));
+	if (order == NULL)
+	{
+		printf("Couldn't allocate Reconcile layers\n");
+		return 1;
+	}
+	VENG_ReconcileStats local = {0};
+	if (stats == NULL)
+	{
+		stats = &local;
+	}
+	VENG_BeginUpdate();
+	int result = 0;
+	bool arranged = false;
+	for (size_t i = 0; screen->layers != NULL && i < screen->layers_size; i++)
+	{
+		VENG_Layer* layer = screen->layers[i];
+		if (layer == NULL)
+		{
+			continue;
+		}
+		size_t index = count;
+		for (size_t k = 0; k < count && index == count; k++)
+		{
+			index = layer->key != 0 && layers[k].key == layer->key && order[k] == NULL ? k : count;
+		}
+		if (index < count)
+		{
+			order[index] = layer;
+			continue;
+		}
+		// An undescribed layer is destroyed, which also takes it off the screen
+		stats->destroyed += layer->childs.sub_elements_count;
+		result |= VENG_DestroyLayer(layer);
+		arranged = true;
+	}
+	for (size_t i = 0; i < count && result == 0; i++)
+	{
+		const VENG_LayerNode* node = &layers[i];
+		VENG_Layer* layer = order[i];
+		if (layer == NULL)
+		{
+			layer = order[i] = VENG_CreateLayer(node->layout, SDL_max(SDL_max(node->max_elements, node->childs_count), 1));
+			if (layer == NULL)
+			{
+				result = 1;
+				break;
+			}
+			layer->mode = node->mode;
+			arranged = true;
+		}
+		else if (node->version != 0 && layer->version == node->version)
+		{
+			stats->skipped++;
+			continue;
+		}
+		else
+		{
+			bool changed = false;
+			if (!__SameLayout(layer->layout, node->layout))
+			{
+				VENG_SetLayerLayout(layer, node->layout);
+				changed = true;
+			}
+			if (layer->mode != node->mode)
+			{
+				VENG_SetLayerMode(layer, node->mode);
+				changed = true;
+			}
+			stats->changed += changed;
+		}
+		layer->key = node->key;
+		layer->version = node->version;
+		if (__ReconcileChilds(layer, node->childs, node->childs_count, stats) != 0)
+		{
+			layer->version = 0;
+			result = 1;
+		}
+	}
+
+	// Stacked in the described order, the ones that couldn't be made are left out
+	for (size_t i = 0, k = 0; screen->layers != NULL && i < screen->layers_size; i++)
+	{
+		while (k < count && order[k] == NULL) k++;
+		VENG_Layer* layer = k < count ? order[k++] : NULL;
+		arranged = arranged || screen->layers[i] != layer;
+		screen->layers[i] = layer;
+	}
+	if (screen->layers == NULL && count > 0)
+	{
+		printf("Screen has no Layer slots\n");
+		result = 1;
+	}
+	screen->layers_count = 0;
+	for (size_t i = 0; screen->layers != NULL && i < screen->layers_size; i++)
+	{
+		screen->layers_count += screen->layers[i] != NULL;
+	}
+	if (arranged)
+	{
+		screen->generation++;
+	}
+	VENG_Free(VENG_MEMORY_CHILDS, order, SDL_max(count, 1), sizeof(VENG_Layer*));
+	return VENG_EndUpdate() || result;
+}
@@ -0,0 +1,268 @@
+#include <SDL2/SDL.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "VENG/VENG.h"
+
+// File layout (little endian):
+// Header: "VENGREC" + version byte + Uint16 sizeof(SDL_Event)
+// Record: Uint8 flags ; varint ms since previous record ; [Uint16 w, Uint16 h if VENG_RECORD_RESIZED] ;
+//         Uint8 payload size ; payload (the SDL_Event bytes without its trailing zeros)
+#define VENG_RECORD_MAGIC "VENGREC"
+#define VENG_RECORD_VERSION 1
+#define VENG_RECORD_RESIZED 0x01
+
+static FILE* record_file = NULL;
+static Uint32 record_last_time = 0;
+static int record_w = -1, record_h = -1;
+static size_t record_count = 0;
+
+static void __WriteU16(Uint8* buffer, size_t* size, Uint16 value)
+{
+	buffer[(*size)++] = value & 0xFF;
+	buffer[(*size)++] = (value >> 8) & 0xFF;
+}
+
+static void __WriteVarint(Uint8* buffer, size_t* size, Uint32 value)
+{
+	do
+	{
+		Uint8 byte = value & 0x7F;
+		value >>= 7;
+		buffer[(*size)++] = byte | (value ? 0x80 : 0);
+	} while (value);
+}
+
+static int __ReadU16(FILE* file, Uint16* value)
+{
+	Uint8 bytes[2];
+	if (fread(bytes, 1, 2, file) != 2) return 1;
+	*value = bytes[0] | (bytes[1] << 8);
+	return 0;
+}
+
+static int __ReadVarint(FILE* file, Uint32* value)
+{
+	*value = 0;
+	for (int shift = 0; shift < 35; shift += 7)
+	{
+		int byte = fgetc(file);
+		if (byte == EOF) return 1;
+		*value |= (Uint32)(byte & 0x7F) << shift;
+		if (!(byte & 0x80)) return 0;
+	}
+	return 1;
+}
+
+/*==========================================================================*\
+ *                   				Record
+\*==========================================================================*/
+int VENG_StartRecording(const char* path)
+{
+	if (!VENG_HasStarted())
+	{
+		printf("VENG is not initialized yet\n");
+		return 1;
+	}
+	if (path == NULL)
+	{
+		printf("Path is NULL\n");
+		return 1;
+	}
+	if (record_file != NULL)
+	{
+		printf("VENG is already recording\n");
+		return 1;
+	}
+	record_file = fopen(path, "wb");
+	if (record_file == NULL)
+	{
+		printf("Couldn't open %s\n", path);
+		return 1;
+	}
+	Uint8 header[sizeof(VENG_RECORD_MAGIC) + 2];
+	size_t size = 0;
+	memcpy(header, VENG_RECORD_MAGIC, sizeof(VENG_RECORD_MAGIC) - 1);
+	size += sizeof(VENG_RECORD_MAGIC) - 1;
+	header[size++] = VENG_RECORD_VERSION;
+	__WriteU16(header, &size, sizeof(SDL_Event));
+	fwrite(header, 1, size, record_file);
+
+	record_last_time = SDL_GetTicks();
+	record_w = -1;
+	record_h = -1;
+	record_count = 0;
+	return 0;
+}
+
+int VENG_StopRecording()
+{
+	if (record_file == NULL)
+	{
+		printf("VENG is not recording\n");
+		return 1;
+	}
+	int result = fclose(record_file) == 0 ? 0 : 1;
+	record_file = NULL;
+	return result;
+}
+
+bool VENG_IsRecording()
+{
+	return record_file != NULL;
+}
+
+void VENG_RecordEvent(SDL_Event* event)
+{
+	if (record_file == NULL || event == NULL)
+	{
+		return;
+	}
+	SDL_Event copy = *event;
+	// Pointers are meaningless once replayed, so they are dropped
+	if (copy.type == SDL_DROPFILE || copy.type == SDL_DROPTEXT || copy.type == SDL_DROPBEGIN || copy.type == SDL_DROPCOMPLETE)
+	{
+		copy.drop.file = NULL;
+	}
+	else if (copy.type >= SDL_USEREVENT && copy.type < SDL_LASTEVENT)
+	{
+		copy.user.data1 = NULL;
+		copy.user.data2 = NULL;
+	}
+
+	Uint8 buffer[16 + sizeof(SDL_Event)];
+	size_t size = 1;
+	Uint32 now = SDL_GetTicks();
+	int w = 0, h = 0;
+	SDL_GetWindowSize(VENG_GetDriver().window, &w, &h);
+
+	buffer[0] = 0;
+	__WriteVarint(buffer, &size, now - record_last_time);
+	if (w != record_w || h != record_h)
+	{
+		buffer[0] |= VENG_RECORD_RESIZED;
+		__WriteU16(buffer, &size, w);
+		__WriteU16(buffer, &size, h);
+		record_w = w;
+		record_h = h;
+	}
+	const Uint8* payload = (const Uint8*)&copy;
+	size_t payload_size = sizeof(SDL_Event);
+	while (payload_size > 0 && payload[payload_size - 1] == 0)
+	{
+		payload_size--;
+	}
+	buffer[size++] = payload_size;
+	memcpy(buffer + size, payload, payload_size);
+	size += payload_size;
+
+	fwrite(buffer, 1, size, record_file);
+	record_last_time = now;
+	record_count++;
+}
+
+/*==========================================================================*\
+ *                   				Replay
+\*==========================================================================*/
+// Meant to run under SDL_VIDEODRIVER=dummy: events are fed back to VENG_ListenScreen
+// and the window is resized whenever the recorded size changed.
+int VENG_ReplayRecording(const char* path, VENG_Screen* screen, VENG_ReplaySpeed speed, VENG_ReplayCallback callback, VENG_ReplayStats* stats)
+{
+	if (!VENG_HasStarted())
+	{
+		printf("VENG is not initialized yet\n");
+		return 1;
+	}
+	if (path == NULL || screen == NULL)
+	{
+		printf("Path or screen cannot be NULL\n");
+		return 1;
+	}
+	FILE* file = fopen(path, "rb");
+	if (file == NULL)
+	{
+		printf("Couldn't open %s\n", path);
+		return 1;
+	}
+	char magic[sizeof(VENG_RECORD_MAGIC) - 1];
+	int version;
+	Uint16 event_size;
+	if (fread(magic, 1, sizeof(magic), file) != sizeof(magic) || memcmp(magic, VENG_RECORD_MAGIC, sizeof(magic)) != 0 ||
+		(version = fgetc(file)) != VENG_RECORD_VERSION || __ReadU16(file, &event_size) != 0)
+	{
+		printf("%s is not a VENG recording\n", path);
+		fclose(file);
+		return 1;
+	}
+	if (event_size > sizeof(SDL_Event))
+	{
+		printf("%s was recorded with a bigger SDL_Event\n", path);
+		fclose(file);
+		return 1;
+	}
+
+	VENG_ReplayStats replay = {0};
+	Uint64 frequency = SDL_GetPerformanceFrequency();
+	Uint64 replay_start = SDL_GetPerformanceCounter();
+	Uint32 start_ticks = SDL_GetTicks();
+	Uint32 record_time = 0;
+	int result = 0;
+	int flags;
+	while ((flags = fgetc(file)) != EOF)
+	{
+		Uint32 delta;
+		Uint16 w = 0, h = 0;
+		int payload_size;
+		SDL_Event event;
+		SDL_zero(event);
+		if (__ReadVarint(file, &delta) != 0 ||
+			((flags & VENG_RECORD_RESIZED) && (__ReadU16(file, &w) != 0 || __ReadU16(file, &h) != 0)) ||
+			(payload_size = fgetc(file)) == EOF || payload_size > event_size ||
+			fread(&event, 1, payload_size, file) != (size_t)payload_size)
+		{
+			printf("%s is truncated\n", path);
+			result = 1;
+			break;
+		}
+		record_time += delta;
+		if (flags & VENG_RECORD_RESIZED)
+		{
+			SDL_SetWindowSize(VENG_GetDriver().window, w, h);
+			replay.resizes++;
+		}
+		if (speed == VENG_REPLAY_ORIGINAL)
+		{
+			Uint32 elapsed = SDL_GetTicks() - start_ticks;
+			if (record_time > elapsed)
+			{
+				SDL_Delay(record_time - elapsed);
+			}
+		}
+
+		// Sent to the replay window as if it had just happened, not dropped or counted as late
+		VENG_AdoptEvent(&event, screen);
+		Uint64 dispatch_start = SDL_GetPerformanceCounter();
+		VENG_ListenScreen(&event, screen);
+		if (callback != NULL)
+		{
+			callback(screen, &event);
+		}
+		Uint64 dispatch_ns = (SDL_GetPerformanceCounter() - dispatch_start) * 1000000000 / frequency;
+		replay.dispatch_ns += dispatch_ns;
+		if (dispatch_ns > replay.max_event_ns)
+		{
+			replay.max_event_ns = dispatch_ns;
+		}
+		replay.events++;
+	}
+	replay.recorded_ms = record_time;
+	replay.total_ns = (SDL_GetPerformanceCounter() - replay_start) * 1000000000 / frequency;
+	fclose(file);
+
+	if (stats != NULL)
+	{
+		*stats = replay;
+	}
+	return result;
+}
@@ -0,0 +1,305 @@
+#include <SDL2/SDL.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <math.h>
+
+#include "VENG/VENG.h"
+
+// Internal resolution scaling:
+// (I)   While the scale is below 1, everything is drawn into an offscreen target of
+//       (output size * scale) pixels, and layers are laid out in that logical size.
+// (II)  VENG_Present stretches the target over the window before presenting it.
+// (III) With a frame budget, the scale follows the measured frame work, from the first
+//       layout or paint of a frame to its present (drawing cost is about proportional to
+//       the area, so to scale²). Time the application spends sleeping or waiting for vsync
+//       between frames isn't counted. The scale is only re-evaluated every SCALE_WINDOW
+//       frames and in SCALE_STEP steps, as every change needs a new layout.
+// Only the main window is scaled, the other ones are always drawn at their full size.
+
+#define SCALE_WINDOW 30
+#define SCALE_STEP 0.0625f
+#define SCALE_HYSTERESIS 0.75f // Frames must be this far under the budget to scale up
+
+static float render_scale = 1.0f;
+static float min_scale = 1.0f;
+static float max_scale = 1.0f; // Set by VENG_SetRenderScale, the adaptive scale doesn't go over it
+static float frame_budget = 0; // Ms, 0 = fixed scale
+
+static SDL_Texture* target = NULL;
+static int target_w = 0, target_h = 0;
+
+static Uint64 frame_start = 0;
+static bool measuring = false; // frame_start is the first layout or paint of the frame
+static double frame_ms_sum = 0;
+static int frames = 0;
+
+static void __DestroyTarget()
+{
+	if (target != NULL)
+	{
+		SDL_DestroyTexture(target);
+		VENG_TrackMemory(VENG_MEMORY_TEXTURES, -(long)target_w * target_h * 4, -1);
+		target = NULL;
+		target_w = 0;
+		target_h = 0;
+	}
+}
+
+// Creates the offscreen target when the logical size changed and draws into it
+static int __BindTarget()
+{
+	SDL_Renderer* renderer = VENG_GetDriver().renderer;
+	if (!VENG_IsMainWindow())
+	{
+		return 0;
+	}
+	if (render_scale >= 1.0f)
+	{
+		if (target != NULL)
+		{
+			SDL_SetRenderTarget(renderer, NULL);
+			__DestroyTarget();
+		}
+		return 0;
+	}
+	int w, h;
+	VENG_GetLogicalSize(&w, &h);
+	if (target == NULL || w != target_w || h != target_h)
+	{
+		SDL_SetRenderTarget(renderer, NULL);
+		__DestroyTarget();
+		target = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_TARGET, w, h);
+		if (target == NULL)
+		{
+			printf("Couldn't create scaled target: %s\n", SDL_GetError());
+			render_scale = 1.0f;
+			return 1;
+		}
+		SDL_SetTextureScaleMode(target, SDL_ScaleModeLinear);
+		target_w = w;
+		target_h = h;
+		VENG_TrackMemory(VENG_MEMORY_TEXTURES, (long)w * h * 4, 1);
+	}
+	SDL_SetRenderTarget(renderer, target);
+	return 0;
+}
+
+// Applies a new scale and lays the rendering screen out in the new logical size
+static void __ChangeScale(float scale)
+{
+	if (scale == render_scale)
+	{
+		return;
+	}
+	render_scale = scale;
+	__BindTarget();
+	if (VENG_IsMainWindow() && VENG_GetScreen() != NULL)
+	{
+		VENG_PrepareScreen(VENG_GetScreen());
+	}
+}
+
+/*==========================================================================*\
+ *                   				Scale
+\*==========================================================================*/
+int VENG_SetRenderScale(float scale)
+{
+	if (!VENG_HasStarted())
+	{
+		printf("VENG is not initialized yet\n");
+		return 1;
+	}
+	if (scale <= 0 || scale > 1)
+	{
+		printf("Scale must be in (0, 1]\n");
+		return 1;
+	}
+	max_scale = scale;
+	if (min_scale > max_scale)
+	{
+		min_scale = max_scale;
+	}
+	__ChangeScale(scale);
+	return render_scale == scale ? 0 : 1;
+}
+
+int VENG_SetScaleBudget(float frame_ms, float lowest_scale)
+{
+	if (!VENG_HasStarted())
+	{
+		printf("VENG is not initialized yet\n");
+		return 1;
+	}
+	if (frame_ms < 0 || lowest_scale <= 0 || lowest_scale > 1)
+	{
+		printf("Frame budget can't be negative and lowest scale must be in (0, 1]\n");
+		return 1;
+	}
+	frame_budget = frame_ms;
+	min_scale = SDL_min(lowest_scale, max_scale);
+	frame_ms_sum = 0;
+	frames = 0;
+	measuring = false;
+	return 0;
+}
+
+float VENG_GetRenderScale()
+{
+	return render_scale;
+}
+
+int VENG_GetLogicalSize(int* w, int* h)
+{
+	if (!VENG_HasStarted())
+	{
+		printf("VENG is not initialized yet\n");
+		return 1;
+	}
+	if (w == NULL || h == NULL)
+	{
+		printf("W or H is NULL\n");
+		return 1;
+	}
+	SDL_GetRendererOutputSize(VENG_GetDriver().renderer, w, h);
+	if (render_scale < 1.0f && VENG_IsMainWindow())
+	{
+		*w = SDL_max(1, (int)round(*w * render_scale));
+		*h = SDL_max(1, (int)round(*h * render_scale));
+	}
+	return 0;
+}
+
+/*==========================================================================*\
+ *                   			Internal usage
+\*==========================================================================*/
+void VENG_StartScaleFrame()
+{
+	if (frame_budget > 0 && !measuring)
+	{
+		frame_start = SDL_GetPerformanceCounter();
+		measuring = true;
+	}
+}
+
+void VENG_ResolveScale()
+{
+	if (!VENG_IsMainWindow())
+	{
+		return;
+	}
+	if (measuring)
+	{
+		frame_ms_sum += (double)(SDL_GetPerformanceCounter() - frame_start) * 1000.0 / SDL_GetPerformanceFrequency();
+		frames++;
+		measuring = false;
+	}
+	if (target == NULL)
+	{
+		return;
+	}
+	SDL_Renderer* renderer = VENG_GetDriver().renderer;
+	SDL_SetRenderTarget(renderer, NULL);
+	SDL_RenderSetClipRect(renderer, NULL);
+	SDL_RenderCopy(renderer, target, NULL, NULL);
+}
+
+void VENG_AdaptScale()
+{
+	if (!VENG_IsMainWindow())
+	{
+		return;
+	}
+	if (frame_budget > 0 && frames >= SCALE_WINDOW)
+	{
+		double average = frame_ms_sum / frames;
+		frame_ms_sum = 0;
+		frames = 0;
+		float scale = render_scale;
+		if (average > frame_budget || (average < frame_budget * SCALE_HYSTERESIS && render_scale < max_scale))
+		{
+			// Aim a bit under the budget so it doesn't bounce around it
+			scale = render_scale * sqrt(frame_budget * 0.9 / SDL_max(average, 0.001));
+			scale = floor(scale / SCALE_STEP) * SCALE_STEP;
+			scale = SDL_max(min_scale, SDL_min(scale, max_scale));
+		}
+		__ChangeScale(scale);
+		// Its layout isn't the start of the next frame
+		measuring = false;
+	}
+	__BindTarget();
+}
+
+bool VENG_ScaleEvent(SDL_Event* event, SDL_Event* scaled)
+{
+	if (!VENG_IsMainWindow())
+	{
+		return false;
+	}
+	if (event->type == SDL_WINDOWEVENT && event->window.event == SDL_WINDOWEVENT_SIZE_CHANGED)
+	{
+		__BindTarget();
+		return false;
+	}
+	if (event->type == SDL_FINGERDOWN || event->type == SDL_FINGERMOTION || event->type == SDL_FINGERUP)
+	{
+		// Normalized to the window, which the scaled frame covers whole: VENG_ProcessGestures
+		// turns them into pixels of the logical size, the same ones as the mapped mouse
+		return false;
+	}
+	if (target == NULL || (event->type != SDL_MOUSEMOTION && event->type != SDL_MOUSEBUTTONDOWN && event->type != SDL_MOUSEBUTTONUP && event->type != SDL_MOUSEWHEEL))
+	{
+		return false;
+	}
+	// Pointer coordinates are in window units
+	int window_w, window_h;
+	SDL_GetWindowSize(VENG_GetDriver().window, &window_w, &window_h);
+	if (window_w <= 0 || window_h <= 0)
+	{
+		return false;
+	}
+	float sx = (float)target_w / window_w;
+	float sy = (float)target_h / window_h;
+	*scaled = *event;
+	if (event->type == SDL_MOUSEMOTION)
+	{
+		scaled->motion.x = event->motion.x * sx;
+		scaled->motion.y = event->motion.y * sy;
+		scaled->motion.xrel = round(event->motion.xrel * sx);
+		scaled->motion.yrel = round(event->motion.yrel * sy);
+	}
+	else if (event->type == SDL_MOUSEWHEEL)
+	{
+		// The scroll amounts are in notches, only the pointer position is mapped
+#if SDL_VERSION_ATLEAST(2, 26, 0)
+		scaled->wheel.mouseX = event->wheel.mouseX * sx;
+		scaled->wheel.mouseY = event->wheel.mouseY * sy;
+#endif
+	}
+	else
+	{
+		scaled->button.x = event->button.x * sx;
+		scaled->button.y = event->button.y * sy;
+	}
+	return true;
+}
+
+SDL_Texture* VENG_GetScaleTarget()
+{
+	return target;
+}
+
+void VENG_DestroyScale()
+{
+	if (target != NULL)
+	{
+		SDL_SetRenderTarget(VENG_GetDriver().renderer, NULL);
+		__DestroyTarget();
+	}
+	render_scale = 1.0f;
+	min_scale = 1.0f;
+	max_scale = 1.0f;
+	frame_budget = 0;
+	frame_ms_sum = 0;
+	frames = 0;
+	measuring = false;
+}
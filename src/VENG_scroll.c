@@ -0,0 +1,359 @@
+#include <SDL2/SDL.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "VENG/VENG.h"
+
+// Scroll containers:
+// (I)   Childs are laid out in a content rect bigger than the element, shifted by the scroll offset.
+// (II)  The element and its childs are painted once into a cached texture the size of the element.
+// (III) Scrolling shifts the childs' rects, copies the cached pixels that are still visible into
+//       a second texture (SDL can't copy a texture onto itself) and only paints the exposed strips.
+//       Invalidated childs get their rect painted again, everything else comes from the cache.
+
+struct VENG_Scroll
+{
+	float content_w, content_h; // Content size in viewports (>= 1)
+	SDL_Point offset;
+	SDL_Point pending; // Scrolled since the last paint
+
+	SDL_Texture* textures[2]; // Front holds the last paint, back receives the next one
+	int front;
+	int w, h;
+	bool repaint;     // Whole cache
+	bool invalidated; // Some childs are dirty
+};
+
+static void __FreeTextures(VENG_Scroll* scroll)
+{
+	for (int i = 0; i < 2; i++)
+	{
+		if (scroll->textures[i] != NULL)
+		{
+			SDL_DestroyTexture(scroll->textures[i]);
+			scroll->textures[i] = NULL;
+			VENG_TrackMemory(VENG_MEMORY_TEXTURES, -(long)scroll->w * scroll->h * 4, -1);
+		}
+	}
+}
+
+static void __ClampOffset(VENG_Element* element)
+{
+	VENG_Scroll* scroll = element->scroll;
+	int max_x = round(element->rect.w * scroll->content_w) - element->rect.w;
+	int max_y = round(element->rect.h * scroll->content_h) - element->rect.h;
+	scroll->offset.x = SDL_max(0, SDL_min(scroll->offset.x, max_x));
+	scroll->offset.y = SDL_max(0, SDL_min(scroll->offset.y, max_y));
+}
+
+static void __ShiftChilds(VENG_Childs* childs, int dx, int dy)
+{
+	if (childs->sub_elements == NULL)
+	{
+		return;
+	}
+	for (size_t i = 0; i < childs->sub_elements_size; i++)
+	{
+		VENG_Element* element = childs->sub_elements[i];
+		if (element == NULL || !element->visible)
+		{
+			continue;
+		}
+		element->rect.x += dx;
+		element->rect.y += dy;
+		__ShiftChilds(&element->childs, dx, dy);
+	}
+}
+
+/*==========================================================================*\
+ *                   				Scroll
+\*==========================================================================*/
+int VENG_SetElementScroll(VENG_Element* element, float content_w, float content_h)
+{
+	if (!VENG_HasStarted())
+	{
+		printf("VENG is not initialized yet\n");
+		return 1;
+	}
+	if (element == NULL)
+	{
+		printf("Element is NULL\n");
+		return 1;
+	}
+	if (content_w == 0 && content_h == 0)
+	{
+		VENG_FreeScroll(element);
+		VENG_PrepareElements(element, element->rect);
+		return 0;
+	}
+	if (content_w < 1 || content_h < 1)
+	{
+		printf("Content size must be at least 1 viewport\n");
+		return 1;
+	}
+	if (element->scroll == NULL)
+	{
+		element->scroll = VENG_Alloc(VENG_MEMORY_ELEMENTS, 1, sizeof(VENG_Scroll));
+		if (element->scroll == NULL)
+		{
+			printf("Couldn't allocate Scroll\n");
+			return 1;
+		}
+	}
+	element->scroll->content_w = content_w;
+	element->scroll->content_h = content_h;
+	VENG_PrepareElements(element, element->rect);
+	return 0;
+}
+
+int VENG_ScrollElement(VENG_Element* element, int dx, int dy)
+{
+	if (!VENG_HasStarted())
+	{
+		printf("VENG is not initialized yet\n");
+		return 1;
+	}
+	if (element == NULL || element->scroll == NULL)
+	{
+		printf("Element is not a scroll container\n");
+		return 1;
+	}
+	VENG_Scroll* scroll = element->scroll;
+	SDL_Point previous = scroll->offset;
+	scroll->offset.x += dx;
+	scroll->offset.y += dy;
+	__ClampOffset(element);
+	dx = scroll->offset.x - previous.x;
+	dy = scroll->offset.y - previous.y;
+	if (dx == 0 && dy == 0)
+	{
+		return 0;
+	}
+	// Moving the rects is enough, sizes don't change
+	__ShiftChilds(&element->childs, -dx, -dy);
+	VENG_InvalidateFocus(element);
+	scroll->pending.x += dx;
+	scroll->pending.y += dy;
+	VENG_InvalidateElement(element);
+	return 0;
+}
+
+SDL_Point VENG_GetElementScroll(VENG_Element* element)
+{
+	if (!VENG_HasStarted())
+	{
+		printf("VENG is not initialized yet\n");
+		return (SDL_Point){0, 0};
+	}
+	if (element == NULL || element->scroll == NULL)
+	{
+		printf("Element is not a scroll container\n");
+		return (SDL_Point){0, 0};
+	}
+	return element->scroll->offset;
+}
+
+int VENG_InvalidateElement(VENG_Element* element)
+{
+	if (!VENG_HasStarted())
+	{
+		printf("VENG is not initialized yet\n");
+		return 1;
+	}
+	if (element == NULL)
+	{
+		printf("Element is NULL\n");
+		return 1;
+	}
+	element->dirty = true;
+	VENG_TouchContainer(element);
+	// Every cache holding the element has to paint it again, including the caches of outer scroll containers
+	SDL_Rect damage = element->rect;
+	for (VENG_Element* parent = element->parent; parent != NULL && parent->type == VENG_TYPE_ELEMENT; parent = parent->parent)
+	{
+		if (parent->scroll != NULL)
+		{
+			parent->scroll->invalidated = true;
+			parent->dirty = true;
+			if (!SDL_IntersectRect(&damage, &parent->rect, &damage))
+			{
+				damage = (SDL_Rect){0, 0, 0, 0}; // Scrolled out of view
+			}
+		}
+	}
+	VENG_StreamDamage(&damage);
+	return 0;
+}
+
+/*==========================================================================*\
+ *                   			Internal usage
+\*==========================================================================*/
+SDL_Rect VENG_PrepareScroll(VENG_Element* element)
+{
+	VENG_Scroll* scroll = element->scroll;
+	__ClampOffset(element);
+	scroll->pending = (SDL_Point){0, 0};
+	scroll->repaint = true;
+	return (SDL_Rect){element->rect.x - scroll->offset.x, element->rect.y - scroll->offset.y,
+					  round(element->rect.w * scroll->content_w), round(element->rect.h * scroll->content_h)};
+}
+
+static void __ClearRect(SDL_Renderer* renderer, SDL_Rect rect)
+{
+	SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+	SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+	SDL_RenderFillRect(renderer, &rect);
+}
+
+static void __RepaintDirty(VENG_Element* container, VENG_Childs* childs, SDL_Renderer* renderer, bool paint)
+{
+	if (childs->sub_elements == NULL)
+	{
+		return;
+	}
+	for (size_t i = 0; i < childs->sub_elements_size; i++)
+	{
+		VENG_Element* element = childs->sub_elements[i];
+		if (element == NULL || !element->visible)
+		{
+			continue;
+		}
+		SDL_Rect region;
+		if (element->dirty && paint && SDL_IntersectRect(&element->rect, &container->rect, &region))
+		{
+			// Whatever overlaps the child (parents, siblings) is painted again in its rect
+			__ClearRect(renderer, region);
+			VENG_DrawRegion(container, region);
+		}
+		element->dirty = false;
+		if (element->scroll == NULL) // Its own cache takes care of its childs
+		{
+			__RepaintDirty(container, &element->childs, renderer, paint);
+		}
+	}
+}
+
+int VENG_DrawScroll(VENG_Element* element)
+{
+	VENG_Scroll* scroll = element->scroll;
+	SDL_Rect view = element->rect;
+	SDL_Renderer* renderer = VENG_GetDriver().renderer;
+	if (view.w <= 0 || view.h <= 0)
+	{
+		return 0;
+	}
+	if (!SDL_RenderTargetSupported(renderer))
+	{
+		VENG_DrawRegion(element, view);
+		return 0;
+	}
+	if (scroll->textures[0] == NULL || scroll->w != view.w || scroll->h != view.h)
+	{
+		__FreeTextures(scroll);
+		scroll->w = view.w;
+		scroll->h = view.h;
+		for (int i = 0; i < 2; i++)
+		{
+			scroll->textures[i] = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_TARGET, view.w, view.h);
+			if (scroll->textures[i] == NULL)
+			{
+				printf("Couldn't create scroll cache: %s\n", SDL_GetError());
+				__FreeTextures(scroll);
+				VENG_DrawRegion(element, view);
+				return 1;
+			}
+			VENG_TrackMemory(VENG_MEMORY_TEXTURES, (long)view.w * view.h * 4, 1);
+		}
+		scroll->repaint = true;
+	}
+
+	VENG_PaintFlush();
+	SDL_Texture* target = SDL_GetRenderTarget(renderer);
+	SDL_Rect viewport, clip;
+	SDL_RenderGetViewport(renderer, &viewport);
+	SDL_bool clipped = SDL_RenderIsClipEnabled(renderer);
+	SDL_RenderGetClipRect(renderer, &clip);
+	SDL_Color color;
+	SDL_BlendMode blend;
+	SDL_GetRenderDrawColor(renderer, &color.r, &color.g, &color.b, &color.a);
+	SDL_GetRenderDrawBlendMode(renderer, &blend);
+
+	SDL_Point delta = scroll->pending;
+	scroll->pending = (SDL_Point){0, 0};
+	if (abs(delta.x) >= view.w || abs(delta.y) >= view.h)
+	{
+		scroll->repaint = true;
+	}
+	SDL_Rect strips[2];
+	int strips_count = 0;
+	if (!scroll->repaint && (delta.x != 0 || delta.y != 0))
+	{
+		// Copy what stays visible into the back texture
+		SDL_Texture* front = scroll->textures[scroll->front];
+		SDL_Texture* back = scroll->textures[!scroll->front];
+		SDL_Rect source = {SDL_max(delta.x, 0), SDL_max(delta.y, 0), view.w - abs(delta.x), view.h - abs(delta.y)};
+		SDL_Rect destination = {SDL_max(-delta.x, 0), SDL_max(-delta.y, 0), source.w, source.h};
+		SDL_SetRenderTarget(renderer, back);
+		SDL_RenderSetViewport(renderer, NULL);
+		SDL_RenderSetClipRect(renderer, NULL);
+		SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+		SDL_RenderClear(renderer);
+		SDL_SetTextureBlendMode(front, SDL_BLENDMODE_NONE);
+		SDL_RenderCopy(renderer, front, &source, &destination);
+		scroll->front = !scroll->front;
+
+		// Exposed strips, in window coordinates
+		if (delta.x != 0)
+		{
+			strips[strips_count++] = (SDL_Rect){delta.x > 0 ? view.x + view.w - delta.x : view.x, view.y, abs(delta.x), view.h};
+		}
+		if (delta.y != 0)
+		{
+			strips[strips_count++] = (SDL_Rect){view.x, delta.y > 0 ? view.y + view.h - delta.y : view.y, view.w, abs(delta.y)};
+		}
+	}
+
+	// Childs are painted with window coordinates, the viewport moves them into the texture
+	SDL_SetRenderTarget(renderer, scroll->textures[scroll->front]);
+	SDL_RenderSetViewport(renderer, &(SDL_Rect){-view.x, -view.y, view.x + view.w, view.y + view.h});
+	SDL_RenderSetClipRect(renderer, NULL);
+	if (scroll->repaint)
+	{
+		__ClearRect(renderer, view);
+		VENG_DrawRegion(element, view);
+	}
+	for (int i = 0; i < strips_count; i++)
+	{
+		__ClearRect(renderer, strips[i]);
+		VENG_DrawRegion(element, strips[i]);
+	}
+	if (scroll->repaint || scroll->invalidated)
+	{
+		__RepaintDirty(element, &element->childs, renderer, !scroll->repaint);
+	}
+	VENG_PaintFlush();
+	scroll->repaint = false;
+	scroll->invalidated = false;
+
+	SDL_SetRenderTarget(renderer, target);
+	SDL_RenderSetViewport(renderer, &viewport);
+	SDL_RenderSetClipRect(renderer, clipped ? &clip : NULL);
+	SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, color.a);
+	SDL_SetRenderDrawBlendMode(renderer, blend);
+	SDL_SetTextureBlendMode(scroll->textures[scroll->front], SDL_BLENDMODE_BLEND);
+	SDL_RenderCopy(renderer, scroll->textures[scroll->front], NULL, &view);
+	return 0;
+}
+
+void VENG_FreeScroll(VENG_Element* element)
+{
+	if (element->scroll == NULL)
+	{
+		return;
+	}
+	__FreeTextures(element->scroll);
+	VENG_Free(VENG_MEMORY_ELEMENTS, element->scroll, 1, sizeof(VENG_Scroll));
+	element->scroll = NULL;
+}
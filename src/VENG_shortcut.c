@@ -0,0 +1,328 @@
+#include <SDL2/SDL.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "VENG/VENG.h"
+
+// Keyboard shortcuts:
+// (I)   Every layer and screen can own an open addressing hash table of bindings, keyed by
+//       (keycode, modifiers). Modifiers are normalized first: left and right count as the
+//       same key and lock keys (num, caps, mode) are ignored.
+// (II)  On SDL_KEYDOWN, VENG_ListenScreen looks the key up once per listening layer, from
+//       the top one down, before its listeners; then once in the screen table.
+// (III) The table stays at most half full, so a lookup is a probe or two whatever the
+//       number of bindings, and removals shift the following entries back (no tombstones).
+// Elements count the bindings given to them, so destroying a subtree that has none (almost
+// always) doesn't look at the tables.
+
+#define SHORTCUTS_START 16 // Power of 2
+#define SHORTCUT_HASH 0x9E3779B97F4A7C15ULL
+
+typedef struct VENG_Shortcut
+{
+	bool used;
+	SDL_Keycode key;
+	Uint16 mods;
+	VENG_ListenerCallback callback;
+	VENG_Element* element;
+} VENG_Shortcut;
+
+struct VENG_Shortcuts
+{
+	VENG_Shortcut* slots;
+	size_t size; // Power of 2
+	size_t count;
+
+	// Every table, for VENG_ForgetShortcuts
+	VENG_Shortcuts* previous;
+	VENG_Shortcuts* next;
+};
+
+static VENG_Shortcuts* tables = NULL;
+static size_t bound = 0; // Bindings given to an element, in every table
+
+static Uint16 __NormalizeMods(Uint16 mods)
+{
+	Uint16 normalized = 0;
+	if (mods & KMOD_CTRL) normalized |= KMOD_CTRL;
+	if (mods & KMOD_SHIFT) normalized |= KMOD_SHIFT;
+	if (mods & KMOD_ALT) normalized |= KMOD_ALT;
+	if (mods & KMOD_GUI) normalized |= KMOD_GUI;
+	return normalized;
+}
+
+static size_t __Slot(VENG_Shortcuts* shortcuts, SDL_Keycode key, Uint16 mods)
+{
+	Uint64 hash = (((Uint64)(Uint32)key << 16) | mods) * SHORTCUT_HASH;
+	return (hash >> 32) & (shortcuts->size - 1);
+}
+
+// Slot holding the binding, or the free slot it would go in
+static size_t __Find(VENG_Shortcuts* shortcuts, SDL_Keycode key, Uint16 mods)
+{
+	size_t slot = __Slot(shortcuts, key, mods);
+	while (shortcuts->slots[slot].used && (shortcuts->slots[slot].key != key || shortcuts->slots[slot].mods != mods))
+	{
+		slot = (slot + 1) & (shortcuts->size - 1);
+	}
+	return slot;
+}
+
+static int __Grow(VENG_Shortcuts* shortcuts)
+{
+	size_t size = shortcuts->size == 0 ? SHORTCUTS_START : shortcuts->size * 2;
+	VENG_Shortcut* slots = VENG_Alloc(VENG_MEMORY_LISTENERS, size, sizeof(VENG_Shortcut));
+	if (slots == NULL)
+	{
+		printf("Couldn't allocate Shortcut slots\n");
+		return 1;
+	}
+	VENG_Shortcut* old_slots = shortcuts->slots;
+	size_t old_size = shortcuts->size;
+	shortcuts->slots = slots;
+	shortcuts->size = size;
+	for (size_t i = 0; i < old_size; i++)
+	{
+		if (old_slots[i].used)
+		{
+			shortcuts->slots[__Find(shortcuts, old_slots[i].key, old_slots[i].mods)] = old_slots[i];
+		}
+	}
+	VENG_Free(VENG_MEMORY_LISTENERS, old_slots, old_size, sizeof(VENG_Shortcut));
+	return 0;
+}
+
+static void __Bind(VENG_Element* element, int change)
+{
+	if (element != NULL)
+	{
+		element->shortcuts += change;
+		bound += change;
+	}
+}
+
+// Backward shift: the entries after the hole that probed past it move into it
+static void __RemoveSlot(VENG_Shortcuts* shortcuts, size_t hole)
+{
+	size_t mask = shortcuts->size - 1;
+	__Bind(shortcuts->slots[hole].element, -1);
+	shortcuts->slots[hole].used = false;
+	shortcuts->count--;
+	for (size_t slot = (hole + 1) & mask; shortcuts->slots[slot].used; slot = (slot + 1) & mask)
+	{
+		size_t home = __Slot(shortcuts, shortcuts->slots[slot].key, shortcuts->slots[slot].mods);
+		// Stays if its home is in (hole, slot], cyclically
+		if (((slot - home) & mask) < ((slot - hole) & mask))
+		{
+			continue;
+		}
+		shortcuts->slots[hole] = shortcuts->slots[slot];
+		shortcuts->slots[slot].used = false;
+		hole = slot;
+	}
+}
+
+static VENG_Shortcuts** __OwnerTable(void* owner)
+{
+	VENG_ParentType type = ((VENG_Screen*)owner)->type;
+	if (type == VENG_TYPE_SCREEN)
+	{
+		return &((VENG_Screen*)owner)->shortcuts;
+	}
+	if (type == VENG_TYPE_LAYER)
+	{
+		return &((VENG_Layer*)owner)->shortcuts;
+	}
+	return NULL;
+}
+
+static bool __HasBindings(VENG_Element* element)
+{
+	if (element->shortcuts > 0)
+	{
+		return true;
+	}
+	for (size_t i = 0; element->childs.sub_elements != NULL && i < element->childs.sub_elements_size; i++)
+	{
+		if (element->childs.sub_elements[i] != NULL && __HasBindings(element->childs.sub_elements[i]))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+static bool __InSubtree(VENG_Element* element, VENG_Element* root)
+{
+	for (; element != NULL; element = element->parent != NULL && ((VENG_Element*)element->parent)->type == VENG_TYPE_ELEMENT ? element->parent : NULL)
+	{
+		if (element == root)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+/*==========================================================================*\
+ *                   				Shortcuts
+\*==========================================================================*/
+int VENG_AddShortcut(void* owner, SDL_Keycode key, Uint16 mods, VENG_ListenerCallback callback, VENG_Element* element)
+{
+	if (!VENG_HasStarted())
+	{
+		printf("VENG is not initialized yet\n");
+		return 1;
+	}
+	if (owner == NULL || callback == NULL)
+	{
+		printf("Owner and callback can't be NULL\n");
+		return 1;
+	}
+	VENG_Shortcuts** table = __OwnerTable(owner);
+	if (table == NULL)
+	{
+		printf("Shortcuts belong to a screen or a layer\n");
+		return 1;
+	}
+	if (*table == NULL)
+	{
+		*table = VENG_Alloc(VENG_MEMORY_LISTENERS, 1, sizeof(VENG_Shortcuts));
+		if (*table == NULL || __Grow(*table) != 0)
+		{
+			printf("Couldn't allocate Shortcuts\n");
+			VENG_Free(VENG_MEMORY_LISTENERS, *table, 1, sizeof(VENG_Shortcuts));
+			*table = NULL;
+			return 1;
+		}
+		(*table)->next = tables;
+		if (tables != NULL)
+		{
+			tables->previous = *table;
+		}
+		tables = *table;
+	}
+	VENG_Shortcuts* shortcuts = *table;
+	mods = __NormalizeMods(mods);
+	size_t slot = __Find(shortcuts, key, mods);
+	if (!shortcuts->slots[slot].used)
+	{
+		if ((shortcuts->count + 1) * 2 > shortcuts->size)
+		{
+			if (__Grow(shortcuts) != 0)
+			{
+				return 1;
+			}
+			slot = __Find(shortcuts, key, mods);
+		}
+		shortcuts->count++;
+	}
+	else
+	{
+		__Bind(shortcuts->slots[slot].element, -1);
+	}
+	// Replaces the binding of the same keys
+	shortcuts->slots[slot] = (VENG_Shortcut){true, key, mods, callback, element};
+	__Bind(element, 1);
+	return 0;
+}
+
+int VENG_RemoveShortcut(void* owner, SDL_Keycode key, Uint16 mods)
+{
+	if (!VENG_HasStarted())
+	{
+		printf("VENG is not initialized yet\n");
+		return 1;
+	}
+	VENG_Shortcuts** table = owner != NULL ? __OwnerTable(owner) : NULL;
+	if (table == NULL || *table == NULL)
+	{
+		printf("Owner has no shortcuts\n");
+		return 1;
+	}
+	size_t slot = __Find(*table, key, __NormalizeMods(mods));
+	if (!(*table)->slots[slot].used)
+	{
+		printf("No such shortcut\n");
+		return 1;
+	}
+	__RemoveSlot(*table, slot);
+	return 0;
+}
+
+/*==========================================================================*\
+ *                   			Internal usage
+\*==========================================================================*/
+// Returns true if the callback consumed the event
+bool VENG_RunShortcut(VENG_Shortcuts* shortcuts, SDL_Event* event)
+{
+	if (shortcuts == NULL || shortcuts->count == 0 || event->type != SDL_KEYDOWN)
+	{
+		return false;
+	}
+	VENG_Shortcut* shortcut = &shortcuts->slots[__Find(shortcuts, event->key.keysym.sym, __NormalizeMods(event->key.keysym.mod))];
+	if (!shortcut->used)
+	{
+		return false;
+	}
+	VENG_TraceBegin("Shortcut", shortcut->element);
+	bool consumed = shortcut->callback(shortcut->element, event) == VENG_EVENT_CONSUMED;
+	VENG_TraceEnd();
+	return consumed;
+}
+
+void VENG_ForgetShortcuts(VENG_Element* element)
+{
+	// The subtree is about to be freed anyway, walking it is cheaper than walking every table
+	if (bound == 0 || !__HasBindings(element))
+	{
+		return;
+	}
+	for (VENG_Shortcuts* shortcuts = tables; shortcuts != NULL; shortcuts = shortcuts->next)
+	{
+		for (size_t i = 0; i < shortcuts->size;)
+		{
+			// A removal can shift the next entry into slot i
+			if (shortcuts->slots[i].used && __InSubtree(shortcuts->slots[i].element, element))
+			{
+				__RemoveSlot(shortcuts, i);
+			}
+			else
+			{
+				i++;
+			}
+		}
+	}
+}
+
+void VENG_FreeShortcuts(void* owner)
+{
+	VENG_Shortcuts** table = __OwnerTable(owner);
+	if (table == NULL || *table == NULL)
+	{
+		return;
+	}
+	VENG_Shortcuts* shortcuts = *table;
+	if (shortcuts->previous != NULL)
+	{
+		shortcuts->previous->next = shortcuts->next;
+	}
+	else
+	{
+		tables = shortcuts->next;
+	}
+	if (shortcuts->next != NULL)
+	{
+		shortcuts->next->previous = shortcuts->previous;
+	}
+	for (size_t i = 0; i < shortcuts->size; i++)
+	{
+		if (shortcuts->slots[i].used)
+		{
+			__Bind(shortcuts->slots[i].element, -1);
+		}
+	}
+	VENG_Free(VENG_MEMORY_LISTENERS, shortcuts->slots, shortcuts->size, sizeof(VENG_Shortcut));
+	VENG_Free(VENG_MEMORY_LISTENERS, shortcuts, 1, sizeof(VENG_Shortcuts));
+	*table = NULL;
+}
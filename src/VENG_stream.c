@@ -0,0 +1,414 @@
+#include <SDL2/SDL.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <errno.h>
+#endif
+
+#include "VENG/VENG.h"
+
+// Frame streaming:
+// (I)   Layouts, VENG_InvalidateElement and VENG_DestroyElement mark the tiles they touch as
+//       damaged. A screen switch, a resize or a new layer damages the whole frame.
+// (II)  At VENG_Present, before the frame is stretched over the window, only the damaged
+//       tiles are read back (one SDL_RenderReadPixels per row of tiles) and hashed. Without
+//       damage tracking every tile is read and hashed.
+// (III) Tiles whose hash changed are given to the sink, so the bandwidth follows what
+//       changed. The socket sink writes them to a UNIX socket (see tools/VENG_viewer.c).
+
+#define STREAM_HASH_PRIME 0x9E3779B97F4A7C15ULL
+
+typedef struct VENG_SocketSink
+{
+	int fd;
+} VENG_SocketSink;
+
+static bool streaming = false;
+static VENG_StreamSink stream_sink;
+static int tile_size = 0;
+static bool use_damage = false;
+static VENG_StreamStats stats;
+
+static int frame_w = 0, frame_h = 0;
+static int tiles_x = 0, tiles_y = 0;
+static Uint32* pixels = NULL; // Last read frame, ARGB8888
+static Uint64* hashes = NULL;
+static bool* damaged = NULL;
+static bool full_damage = true;
+static VENG_Screen* last_screen = NULL;
+static Uint32 last_screen_generation = 0;
+
+static void __FreeFrame()
+{
+	VENG_Free(VENG_MEMORY_TEXTURES, pixels, (size_t)frame_w * frame_h, sizeof(Uint32));
+	VENG_Free(VENG_MEMORY_TEXTURES, hashes, (size_t)tiles_x * tiles_y, sizeof(Uint64));
+	VENG_Free(VENG_MEMORY_TEXTURES, damaged, (size_t)tiles_x * tiles_y, sizeof(bool));
+	pixels = NULL;
+	hashes = NULL;
+	damaged = NULL;
+	frame_w = 0;
+	frame_h = 0;
+	tiles_x = 0;
+	tiles_y = 0;
+}
+
+static int __PrepareFrame(int w, int h)
+{
+	if (w == frame_w && h == frame_h)
+	{
+		return 0;
+	}
+	__FreeFrame();
+	size_t tiles = (size_t)((w + tile_size - 1) / tile_size) * ((h + tile_size - 1) / tile_size);
+	pixels = VENG_Alloc(VENG_MEMORY_TEXTURES, (size_t)w * h, sizeof(Uint32));
+	hashes = VENG_Alloc(VENG_MEMORY_TEXTURES, tiles, sizeof(Uint64));
+	damaged = VENG_Alloc(VENG_MEMORY_TEXTURES, tiles, sizeof(bool));
+	if (pixels == NULL || hashes == NULL || damaged == NULL)
+	{
+		printf("Couldn't allocate stream frame\n");
+		VENG_Free(VENG_MEMORY_TEXTURES, pixels, (size_t)w * h, sizeof(Uint32));
+		VENG_Free(VENG_MEMORY_TEXTURES, hashes, tiles, sizeof(Uint64));
+		VENG_Free(VENG_MEMORY_TEXTURES, damaged, tiles, sizeof(bool));
+		pixels = NULL;
+		hashes = NULL;
+		damaged = NULL;
+		return 1;
+	}
+	memset(hashes, 0, tiles * sizeof(Uint64));
+	memset(damaged, 0, tiles * sizeof(bool));
+	frame_w = w;
+	frame_h = h;
+	tiles_x = (w + tile_size - 1) / tile_size;
+	tiles_y = (h + tile_size - 1) / tile_size;
+	full_damage = true;
+	return 0;
+}
+
+static SDL_Rect __TileRect(int tile)
+{
+	SDL_Rect rect = {(tile % tiles_x) * tile_size, (tile / tiles_x) * tile_size, tile_size, tile_size};
+	rect.w = SDL_min(rect.w, frame_w - rect.x);
+	rect.h = SDL_min(rect.h, frame_h - rect.y);
+	return rect;
+}
+
+static Uint64 __HashTile(SDL_Rect rect)
+{
+	Uint64 hash = STREAM_HASH_PRIME;
+	for (int y = rect.y; y < rect.y + rect.h; y++)
+	{
+		const Uint32* row = &pixels[(size_t)y * frame_w + rect.x];
+		int x = 0;
+		for (; x + 2 <= rect.w; x += 2)
+		{
+			Uint64 word;
+			memcpy(&word, &row[x], sizeof(word));
+			hash = (hash ^ word) * STREAM_HASH_PRIME;
+			hash ^= hash >> 29;
+		}
+		if (x < rect.w)
+		{
+			hash = (hash ^ row[x]) * STREAM_HASH_PRIME;
+			hash ^= hash >> 29;
+		}
+	}
+	// 0 is kept for tiles never sent
+	return hash == 0 ? 1 : hash;
+}
+
+static void __StopStream()
+{
+	if (stream_sink.close != NULL)
+	{
+		stream_sink.close(stream_sink.context);
+	}
+	streaming = false;
+	stream_sink = (VENG_StreamSink){0};
+	last_screen = NULL;
+	__FreeFrame();
+}
+
+/*==========================================================================*\
+ *                   				Stream
+\*==========================================================================*/
+int VENG_StartStream(VENG_StreamSink sink, int new_tile_size, bool trust_damage)
+{
+	if (!VENG_HasStarted())
+	{
+		printf("VENG is not initialized yet\n");
+		return 1;
+	}
+	if (sink.frame == NULL || sink.tile == NULL || new_tile_size <= 0)
+	{
+		printf("Sink callbacks can't be NULL and tile size must be positive\n");
+		return 1;
+	}
+	if (streaming)
+	{
+		__StopStream();
+	}
+	stream_sink = sink;
+	tile_size = new_tile_size;
+	use_damage = trust_damage;
+	stats = (VENG_StreamStats){0};
+	full_damage = true;
+	streaming = true;
+	return 0;
+}
+
+int VENG_StopStream()
+{
+	if (!streaming)
+	{
+		printf("VENG is not streaming\n");
+		return 1;
+	}
+	__StopStream();
+	return 0;
+}
+
+bool VENG_IsStreaming()
+{
+	return streaming;
+}
+
+int VENG_GetStreamStats(VENG_StreamStats* stream_stats)
+{
+	if (stream_stats == NULL)
+	{
+		printf("Stats is NULL\n");
+		return 1;
+	}
+	*stream_stats = stats;
+	return 0;
+}
+
+/*==========================================================================*\
+ *                   			 Socket sink
+\*==========================================================================*/
+#ifndef _WIN32
+static int __WriteAll(int fd, const void* data, size_t size)
+{
+	const Uint8* bytes = data;
+	while (size > 0)
+	{
+		ssize_t written = send(fd, bytes, size, MSG_NOSIGNAL);
+		if (written < 0 && errno == EINTR)
+		{
+			continue;
+		}
+		if (written <= 0)
+		{
+			return 1;
+		}
+		bytes += written;
+		size -= written;
+	}
+	return 0;
+}
+
+static int __SocketFrame(void* context, int w, int h, Uint32 tiles)
+{
+	VENG_StreamFrameHeader header = {VENG_STREAM_MAGIC, w, h, tiles};
+	return __WriteAll(((VENG_SocketSink*)context)->fd, &header, sizeof(header));
+}
+
+static int __SocketTile(void* context, SDL_Rect rect, const Uint32* tile_pixels, int pitch)
+{
+	int fd = ((VENG_SocketSink*)context)->fd;
+	VENG_StreamTileHeader header = {rect.x, rect.y, rect.w, rect.h};
+	if (__WriteAll(fd, &header, sizeof(header)) != 0)
+	{
+		return 1;
+	}
+	for (int y = 0; y < rect.h; y++)
+	{
+		if (__WriteAll(fd, (const Uint8*)tile_pixels + (size_t)y * pitch, rect.w * sizeof(Uint32)) != 0)
+		{
+			return 1;
+		}
+	}
+	return 0;
+}
+
+static void __SocketClose(void* context)
+{
+	close(((VENG_SocketSink*)context)->fd);
+	VENG_Free(VENG_MEMORY_DIAGNOSTICS, context, 1, sizeof(VENG_SocketSink));
+}
+#endif
+
+int VENG_OpenSocketSink(const char* path, VENG_StreamSink* sink)
+{
+	if (!VENG_HasStarted())
+	{
+		printf("VENG is not initialized yet\n");
+		return 1;
+	}
+	if (path == NULL || sink == NULL)
+	{
+		printf("Path and sink can't be NULL\n");
+		return 1;
+	}
+#ifdef _WIN32
+	printf("Socket sinks need UNIX sockets\n");
+	return 1;
+#else
+	struct sockaddr_un address = {0};
+	if (strlen(path) >= sizeof(address.sun_path))
+	{
+		printf("Socket path is too long\n");
+		return 1;
+	}
+	address.sun_family = AF_UNIX;
+	strcpy(address.sun_path, path);
+	VENG_SocketSink* socket_sink = VENG_Alloc(VENG_MEMORY_DIAGNOSTICS, 1, sizeof(VENG_SocketSink));
+	if (socket_sink == NULL)
+	{
+		printf("Couldn't allocate Socket sink\n");
+		return 1;
+	}
+	socket_sink->fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (socket_sink->fd < 0 || connect(socket_sink->fd, (struct sockaddr*)&address, sizeof(address)) != 0)
+	{
+		printf("Couldn't connect to %s\n", path);
+		if (socket_sink->fd >= 0) close(socket_sink->fd);
+		VENG_Free(VENG_MEMORY_DIAGNOSTICS, socket_sink, 1, sizeof(VENG_SocketSink));
+		return 1;
+	}
+	*sink = (VENG_StreamSink){__SocketFrame, __SocketTile, __SocketClose, socket_sink};
+	return 0;
+#endif
+}
+
+/*==========================================================================*\
+ *                   			Internal usage
+\*==========================================================================*/
+void VENG_StreamDamage(const SDL_Rect* rect)
+{
+	if (!streaming || !use_damage || full_damage)
+	{
+		return;
+	}
+	if (rect == NULL || damaged == NULL)
+	{
+		full_damage = true;
+		return;
+	}
+	SDL_Rect frame = {0, 0, frame_w, frame_h}, area;
+	if (!SDL_IntersectRect(rect, &frame, &area))
+	{
+		return;
+	}
+	for (int ty = area.y / tile_size; ty <= (area.y + area.h - 1) / tile_size; ty++)
+	{
+		for (int tx = area.x / tile_size; tx <= (area.x + area.w - 1) / tile_size; tx++)
+		{
+			damaged[ty * tiles_x + tx] = true;
+		}
+	}
+}
+
+void VENG_StreamFrame()
+{
+	if (!streaming || !VENG_IsMainWindow())
+	{
+		return;
+	}
+	int w, h;
+	VENG_GetLogicalSize(&w, &h);
+	if (__PrepareFrame(w, h) != 0)
+	{
+		__StopStream();
+		return;
+	}
+	VENG_Screen* screen = VENG_GetScreen();
+	if (screen != last_screen || (screen != NULL && screen->generation != last_screen_generation))
+	{
+		full_damage = true;
+		last_screen = screen;
+		last_screen_generation = screen != NULL ? screen->generation : 0;
+	}
+	bool everything = !use_damage || full_damage;
+	SDL_Renderer* renderer = VENG_GetDriver().renderer;
+	size_t changed = 0;
+	for (int ty = 0; ty < tiles_y; ty++)
+	{
+		// Damaged columns of this row of tiles, read in one go
+		int first = -1, last = -1;
+		for (int tx = 0; tx < tiles_x; tx++)
+		{
+			if (everything || damaged[ty * tiles_x + tx])
+			{
+				first = first < 0 ? tx : first;
+				last = tx;
+			}
+		}
+		if (first < 0)
+		{
+			continue;
+		}
+		SDL_Rect band = {first * tile_size, ty * tile_size, 0, 0};
+		band.w = SDL_min((last + 1) * tile_size, frame_w) - band.x;
+		band.h = SDL_min(tile_size, frame_h - band.y);
+		if (SDL_RenderReadPixels(renderer, &band, SDL_PIXELFORMAT_ARGB8888, &pixels[(size_t)band.y * frame_w + band.x], frame_w * sizeof(Uint32)) != 0)
+		{
+			printf("Couldn't read the frame: %s\n", SDL_GetError());
+			__StopStream();
+			return;
+		}
+		for (int tx = first; tx <= last; tx++)
+		{
+			int tile = ty * tiles_x + tx;
+			stats.tiles_read++;
+			if (!everything && !damaged[tile])
+			{
+				continue;
+			}
+			stats.tiles_hashed++;
+			// From here on damaged means changed
+			Uint64 hash = __HashTile(__TileRect(tile));
+			damaged[tile] = hash != hashes[tile];
+			hashes[tile] = hash;
+			changed += damaged[tile];
+		}
+	}
+
+	if (changed > 0)
+	{
+		bool failed = stream_sink.frame(stream_sink.context, frame_w, frame_h, changed) != 0;
+		for (int tile = 0; tile < tiles_x * tiles_y && !failed; tile++)
+		{
+			if (!damaged[tile])
+			{
+				continue;
+			}
+			SDL_Rect rect = __TileRect(tile);
+			failed = stream_sink.tile(stream_sink.context, rect, &pixels[(size_t)rect.y * frame_w + rect.x], frame_w * sizeof(Uint32)) != 0;
+			stats.tiles_sent++;
+			stats.bytes_sent += (Uint64)rect.w * rect.h * sizeof(Uint32);
+		}
+		if (failed)
+		{
+			printf("Stream sink failed, stopping the stream\n");
+			__StopStream();
+			return;
+		}
+	}
+	stats.frames++;
+	memset(damaged, 0, (size_t)tiles_x * tiles_y * sizeof(bool));
+	full_damage = false;
+}
+
+void VENG_DestroyStream()
+{
+	if (streaming)
+	{
+		__StopStream();
+	}
+	stats = (VENG_StreamStats){0};
+}
@@ -0,0 +1,792 @@
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "VENG/VENG.h"
+
+// Text rendering:
+// (I)   Every font (a file at a given size) owns a glyph atlas, glyphs are rasterized once
+//       with SDL_ttf and packed in shelves. Windows share the packing and keep an atlas
+//       texture each, made on their first draw (see __GetAtlas).
+// (II)  Laid-out lines are cached as quads relative to the text origin, keyed by
+//       (string hash, font, size, wrap width), and evicted in LRU order past a byte budget.
+// (III) Drawing a label offsets its cached quads and draws them in one SDL_RenderGeometry call.
+
+#define ATLAS_START_SIZE 512
+#define ATLAS_MAX_SIZE 4096
+#define GLYPHS_START 128
+#define TEXT_BUCKETS_START 256
+#define TEXT_DEFAULT_BUDGET (4 * 1024 * 1024)
+
+typedef struct VENG_Glyph
+{
+	Uint32 codepoint; // 0 = empty slot
+	SDL_Rect atlas;
+	int advance;
+} VENG_Glyph;
+
+struct VENG_Font
+{
+	TTF_Font* ttf;
+	int size;
+	int line_skip;
+
+	SDL_Texture* atlases[VENG_MAX_WINDOWS]; // Per window slot, each holds every packed glyph
+	SDL_Surface* atlas_pixels; // Copy of the main window atlas for the software rasterizer, NULL without it
+	int atlas_size;
+	SDL_Point shelf; // Next free position
+	int shelf_h;
+	Uint32 generation; // Bumped on atlas reset, invalidates cached lines
+
+	VENG_Glyph* glyphs;
+	size_t glyphs_size;
+	size_t glyphs_count;
+
+	VENG_Font* next;
+};
+
+typedef struct VENG_TextLine
+{
+	Uint64 hash;
+	VENG_Font* font;
+	int size;
+	int wrap_width;
+	Uint32 generation;
+
+	char* text;
+	size_t text_length;
+	SDL_Vertex* vertices; // 4 per glyph, relative to the text origin
+	size_t quads;
+	size_t quads_size;
+	int w, h;
+	size_t bytes;
+
+	struct VENG_TextLine* bucket_next;
+	struct VENG_TextLine* lru_prev; // Towards most recently used
+	struct VENG_TextLine* lru_next; // Towards least recently used
+} VENG_TextLine;
+
+static VENG_Font* fonts = NULL;
+
+static VENG_TextLine** text_buckets = NULL;
+static size_t text_buckets_size = 0;
+static size_t text_lines_count = 0;
+static VENG_TextLine* lru_head = NULL;
+static VENG_TextLine* lru_tail = NULL;
+static size_t text_cache_bytes = 0;
+static size_t text_cache_budget = TEXT_DEFAULT_BUDGET;
+
+// Shared draw buffers
+static SDL_Vertex* draw_vertices = NULL;
+static size_t draw_vertices_quads = 0;
+static int* draw_indices = NULL;
+static size_t draw_indices_quads = 0;
+
+static Uint32 __DecodeUTF8(const char** text)
+{
+	const Uint8* s = (const Uint8*)*text;
+	Uint32 codepoint;
+	int extra;
+	if (s[0] < 0x80) { codepoint = s[0]; extra = 0; }
+	else if ((s[0] & 0xE0) == 0xC0) { codepoint = s[0] & 0x1F; extra = 1; }
+	else if ((s[0] & 0xF0) == 0xE0) { codepoint = s[0] & 0x0F; extra = 2; }
+	else if ((s[0] & 0xF8) == 0xF0) { codepoint = s[0] & 0x07; extra = 3; }
+	else { *text += 1; return 0xFFFD; }
+	for (int i = 1; i <= extra; i++)
+	{
+		if ((s[i] & 0xC0) != 0x80)
+		{
+			*text += i;
+			return 0xFFFD;
+		}
+		codepoint = (codepoint << 6) | (s[i] & 0x3F);
+	}
+	*text += extra + 1;
+	return codepoint;
+}
+
+static Uint64 __HashText(const char* text, size_t length, VENG_Font* font, int wrap_width)
+{
+	Uint64 hash = 14695981039346656037ULL; // FNV-1a
+	for (size_t i = 0; i < length; i++)
+	{
+		hash = (hash ^ (Uint8)text[i]) * 1099511628211ULL;
+	}
+	hash ^= (Uint64)(uintptr_t)font * 0x9E3779B97F4A7C15ULL;
+	hash ^= (Uint64)(Uint32)wrap_width << 17;
+	return hash;
+}
+
+/*==========================================================================*\
+ *                   				Atlas
+\*==========================================================================*/
+static void __DestroyAtlas(VENG_Font* font, size_t window)
+{
+	if (font->atlases[window] == NULL)
+	{
+		return;
+	}
+	long bytes = (long)font->atlas_size * font->atlas_size * 4;
+	if (window == 0 && font->atlas_pixels != NULL)
+	{
+		VENG_SetRasterSource(font->atlases[0], NULL);
+		SDL_FreeSurface(font->atlas_pixels);
+		VENG_TrackMemory(VENG_MEMORY_TEXTURES, -bytes, -1);
+		font->atlas_pixels = NULL;
+	}
+	SDL_DestroyTexture(font->atlases[window]);
+	VENG_TrackMemory(VENG_MEMORY_TEXTURES, -bytes, -1);
+	font->atlases[window] = NULL;
+}
+
+static void __DestroyAtlases(VENG_Font* font)
+{
+	for (size_t i = 0; i < VENG_MAX_WINDOWS; i++)
+	{
+		__DestroyAtlas(font, i);
+	}
+}
+
+// Atlas of the current window, at the size of the font's atlases
+static int __CreateAtlas(VENG_Font* font)
+{
+	size_t window = VENG_GetWindowSlot();
+	int size = font->atlas_size;
+	SDL_Texture* atlas = SDL_CreateTexture(VENG_GetDriver().renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC, size, size);
+	if (atlas == NULL)
+	{
+		printf("Couldn't create glyph atlas: %s\n", SDL_GetError());
+		return 1;
+	}
+	// Static textures start undefined, clear it row by row
+	Uint32* row = VENG_Alloc(VENG_MEMORY_TEXTURES, size, sizeof(Uint32));
+	if (row == NULL)
+	{
+		SDL_DestroyTexture(atlas);
+		return 1;
+	}
+	for (int y = 0; y < size; y++)
+	{
+		SDL_UpdateTexture(atlas, &(SDL_Rect){0, y, size, 1}, row, size * sizeof(Uint32));
+	}
+	VENG_Free(VENG_MEMORY_TEXTURES, row, size, sizeof(Uint32));
+	SDL_SetTextureBlendMode(atlas, SDL_BLENDMODE_BLEND);
+	SDL_Surface* pixels = NULL;
+	if (window == 0 && VENG_IsRasterizing())
+	{
+		pixels = SDL_CreateRGBSurfaceWithFormat(0, size, size, 32, SDL_PIXELFORMAT_ARGB8888);
+		if (pixels == NULL || VENG_SetRasterSource(atlas, pixels) != 0)
+		{
+			printf("Couldn't create glyph atlas copy: %s\n", SDL_GetError());
+			SDL_FreeSurface(pixels);
+			SDL_DestroyTexture(atlas);
+			return 1;
+		}
+		memset(pixels->pixels, 0, (size_t)pixels->pitch * size);
+	}
+
+	__DestroyAtlas(font, window);
+	font->atlases[window] = atlas;
+	if (window == 0)
+	{
+		font->atlas_pixels = pixels;
+	}
+	VENG_TrackMemory(VENG_MEMORY_TEXTURES, (long)size * size * (pixels != NULL ? 8 : 4), pixels != NULL ? 2 : 1);
+	return 0;
+}
+
+static void __ForgetGlyphs(VENG_Font* font)
+{
+	memset(font->glyphs, 0, font->glyphs_size * sizeof(VENG_Glyph));
+	font->glyphs_count = 0;
+	font->shelf = (SDL_Point){0, 0};
+	font->shelf_h = 0;
+	font->generation++;
+}
+
+// Forgets every glyph, growing the atlas if it can. Cached lines of this font are rebuilt on use.
+// The other windows make theirs again on their next draw.
+static void __ResetAtlas(VENG_Font* font)
+{
+	if (font->atlas_size < ATLAS_MAX_SIZE)
+	{
+		__DestroyAtlases(font);
+		font->atlas_size *= 2;
+		if (__CreateAtlas(font) != 0)
+		{
+			font->atlas_size /= 2;
+			__CreateAtlas(font);
+		}
+	}
+	__ForgetGlyphs(font);
+}
+
+// Atlas of the current window. A new one starts empty, so the glyphs packed so far are
+// forgotten and uploaded again to every atlas as lines are laid out.
+static SDL_Texture* __GetAtlas(VENG_Font* font)
+{
+	size_t window = VENG_GetWindowSlot();
+	if (font->atlases[window] == NULL)
+	{
+		if (__CreateAtlas(font) != 0)
+		{
+			return NULL;
+		}
+		if (font->glyphs_count > 0)
+		{
+			__ForgetGlyphs(font);
+		}
+	}
+	return font->atlases[window];
+}
+
+static VENG_Glyph* __FindGlyphSlot(VENG_Glyph* glyphs, size_t size, Uint32 codepoint)
+{
+	size_t i = (codepoint * 2654435761u) & (size - 1);
+	while (glyphs[i].codepoint != 0 && glyphs[i].codepoint != codepoint)
+	{
+		i = (i + 1) & (size - 1);
+	}
+	return &glyphs[i];
+}
+
+// Returns NULL if the atlas is full
+static VENG_Glyph* __GetGlyph(VENG_Font* font, Uint32 codepoint)
+{
+	VENG_Glyph* glyph = __FindGlyphSlot(font->glyphs, font->glyphs_size, codepoint);
+	if (glyph->codepoint == codepoint)
+	{
+		return glyph;
+	}
+	if ((font->glyphs_count + 1) * 2 > font->glyphs_size)
+	{
+		VENG_Glyph* glyphs = VENG_Alloc(VENG_MEMORY_TEXTURES, font->glyphs_size * 2, sizeof(VENG_Glyph));
+		if (glyphs == NULL)
+		{
+			return NULL;
+		}
+		for (size_t i = 0; i < font->glyphs_size; i++)
+		{
+			if (font->glyphs[i].codepoint != 0)
+			{
+				*__FindGlyphSlot(glyphs, font->glyphs_size * 2, font->glyphs[i].codepoint) = font->glyphs[i];
+			}
+		}
+		VENG_Free(VENG_MEMORY_TEXTURES, font->glyphs, font->glyphs_size, sizeof(VENG_Glyph));
+		font->glyphs = glyphs;
+		font->glyphs_size *= 2;
+		glyph = __FindGlyphSlot(font->glyphs, font->glyphs_size, codepoint);
+	}
+
+	int minx, maxx, miny, maxy, advance;
+	if (TTF_GlyphMetrics32(font->ttf, codepoint, &minx, &maxx, &miny, &maxy, &advance) != 0)
+	{
+		advance = 0;
+	}
+	SDL_Rect rect = {0, 0, 0, 0};
+	SDL_Surface* rendered = TTF_RenderGlyph32_Blended(font->ttf, codepoint, (SDL_Color){255, 255, 255, 255});
+	if (rendered != NULL)
+	{
+		SDL_Surface* surface = SDL_ConvertSurfaceFormat(rendered, SDL_PIXELFORMAT_ARGB8888, 0);
+		SDL_FreeSurface(rendered);
+		if (surface == NULL)
+		{
+			return NULL;
+		}
+		// Shelf packing, one pixel of padding to avoid bleeding
+		if (font->shelf.x + surface->w + 1 > font->atlas_size)
+		{
+			font->shelf.x = 0;
+			font->shelf.y += font->shelf_h + 1;
+			font->shelf_h = 0;
+		}
+		if (surface->w + 1 > font->atlas_size || font->shelf.y + surface->h + 1 > font->atlas_size)
+		{
+			SDL_FreeSurface(surface);
+			return NULL;
+		}
+		rect = (SDL_Rect){font->shelf.x, font->shelf.y, surface->w, surface->h};
+		for (size_t i = 0; i < VENG_MAX_WINDOWS; i++)
+		{
+			if (font->atlases[i] != NULL)
+			{
+				SDL_UpdateTexture(font->atlases[i], &rect, surface->pixels, surface->pitch);
+			}
+		}
+		for (int y = 0; font->atlas_pixels != NULL && y < surface->h; y++)
+		{
+			memcpy((Uint8*)font->atlas_pixels->pixels + (size_t)(rect.y + y) * font->atlas_pixels->pitch + rect.x * sizeof(Uint32),
+				   (Uint8*)surface->pixels + (size_t)y * surface->pitch, surface->w * sizeof(Uint32));
+		}
+		font->shelf.x += surface->w + 1;
+		if (surface->h > font->shelf_h)
+		{
+			font->shelf_h = surface->h;
+		}
+		SDL_FreeSurface(surface);
+	}
+	glyph->codepoint = codepoint;
+	glyph->atlas = rect;
+	glyph->advance = advance;
+	font->glyphs_count++;
+	return glyph;
+}
+
+/*==========================================================================*\
+ *                   				Fonts
+\*==========================================================================*/
+VENG_Font* VENG_OpenFont(const char* path, int size)
+{
+	if (!VENG_HasStarted())
+	{
+		printf("VENG is not initialized yet\n");
+		return NULL;
+	}
+	if (path == NULL || size <= 0)
+	{
+		printf("Path cannot be NULL and size must be positive\n");
+		return NULL;
+	}
+	if (!TTF_WasInit() && TTF_Init() != 0)
+	{
+		printf("Couldn't start SDL_ttf: %s\n", SDL_GetError());
+		return NULL;
+	}
+	VENG_Font* font = VENG_Alloc(VENG_MEMORY_TEXTURES, 1, sizeof(VENG_Font));
+	if (font == NULL)
+	{
+		return NULL;
+	}
+	memset(font, 0, sizeof(VENG_Font));
+	font->ttf = TTF_OpenFont(path, size);
+	font->glyphs = VENG_Alloc(VENG_MEMORY_TEXTURES, GLYPHS_START, sizeof(VENG_Glyph));
+	font->glyphs_size = GLYPHS_START;
+	font->atlas_size = ATLAS_START_SIZE;
+	if (font->ttf == NULL || font->glyphs == NULL || __CreateAtlas(font) != 0)
+	{
+		printf("Couldn't open font %s\n", path);
+		if (font->ttf != NULL) TTF_CloseFont(font->ttf);
+		VENG_Free(VENG_MEMORY_TEXTURES, font->glyphs, GLYPHS_START, sizeof(VENG_Glyph));
+		VENG_Free(VENG_MEMORY_TEXTURES, font, 1, sizeof(VENG_Font));
+		return NULL;
+	}
+	font->size = size;
+	font->line_skip = TTF_FontLineSkip(font->ttf);
+	font->next = fonts;
+	fonts = font;
+	return font;
+}
+
+static void __FreeTextLine(VENG_TextLine* line);
+
+void VENG_CloseFont(VENG_Font* font)
+{
+	if (font == NULL)
+	{
+		return;
+	}
+	for (VENG_TextLine* line = lru_head; line != NULL;)
+	{
+		VENG_TextLine* next = line->lru_next;
+		if (line->font == font)
+		{
+			__FreeTextLine(line);
+		}
+		line = next;
+	}
+	for (VENG_Font** link = &fonts; *link != NULL; link = &(*link)->next)
+	{
+		if (*link == font)
+		{
+			*link = font->next;
+			break;
+		}
+	}
+	__DestroyAtlases(font);
+	TTF_CloseFont(font->ttf);
+	VENG_Free(VENG_MEMORY_TEXTURES, font->glyphs, font->glyphs_size, sizeof(VENG_Glyph));
+	VENG_Free(VENG_MEMORY_TEXTURES, font, 1, sizeof(VENG_Font));
+}
+
+/*==========================================================================*\
+ *                   			  Line cache
+\*==========================================================================*/
+static void __LRUUnlink(VENG_TextLine* line)
+{
+	if (line->lru_prev != NULL) line->lru_prev->lru_next = line->lru_next;
+	else lru_head = line->lru_next;
+	if (line->lru_next != NULL) line->lru_next->lru_prev = line->lru_prev;
+	else lru_tail = line->lru_prev;
+	line->lru_prev = NULL;
+	line->lru_next = NULL;
+}
+
+static void __LRUPushFront(VENG_TextLine* line)
+{
+	line->lru_next = lru_head;
+	line->lru_prev = NULL;
+	if (lru_head != NULL) lru_head->lru_prev = line;
+	lru_head = line;
+	if (lru_tail == NULL) lru_tail = line;
+}
+
+static void __FreeTextLine(VENG_TextLine* line)
+{
+	VENG_TextLine** link = &text_buckets[line->hash & (text_buckets_size - 1)];
+	while (*link != line)
+	{
+		link = &(*link)->bucket_next;
+	}
+	*link = line->bucket_next;
+	__LRUUnlink(line);
+	text_cache_bytes -= line->bytes;
+	text_lines_count--;
+	VENG_Free(VENG_MEMORY_TEXTURES, line->text, line->text_length + 1, sizeof(char));
+	VENG_Free(VENG_MEMORY_TEXTURES, line->vertices, line->quads_size * 4, sizeof(SDL_Vertex));
+	VENG_Free(VENG_MEMORY_TEXTURES, line, 1, sizeof(VENG_TextLine));
+}
+
+static void __EvictTextLines(VENG_TextLine* keep)
+{
+	while (text_cache_bytes > text_cache_budget && lru_tail != NULL && lru_tail != keep)
+	{
+		__FreeTextLine(lru_tail);
+	}
+}
+
+static int __GrowTextBuckets()
+{
+	size_t new_size = text_buckets_size == 0 ? TEXT_BUCKETS_START : text_buckets_size * 2;
+	VENG_TextLine** buckets = VENG_Alloc(VENG_MEMORY_TEXTURES, new_size, sizeof(VENG_TextLine*));
+	if (buckets == NULL)
+	{
+		return 1;
+	}
+	for (size_t i = 0; i < text_buckets_size; i++)
+	{
+		for (VENG_TextLine* line = text_buckets[i]; line != NULL;)
+		{
+			VENG_TextLine* next = line->bucket_next;
+			line->bucket_next = buckets[line->hash & (new_size - 1)];
+			buckets[line->hash & (new_size - 1)] = line;
+			line = next;
+		}
+	}
+	VENG_Free(VENG_MEMORY_TEXTURES, text_buckets, text_buckets_size, sizeof(VENG_TextLine*));
+	text_buckets = buckets;
+	text_buckets_size = new_size;
+	return 0;
+}
+
+// Lays the text out into quads. Returns 1 if the atlas got full on the way.
+static int __LayoutText(VENG_TextLine* line)
+{
+	VENG_Font* font = line->font;
+	size_t quads_size = 0;
+	for (const char* c = line->text; *c != '\0';)
+	{
+		Uint32 codepoint = __DecodeUTF8(&c);
+		if (codepoint != ' ' && codepoint != '\n' && codepoint != '\t') quads_size++;
+	}
+	SDL_Vertex* vertices = NULL;
+	if (quads_size > 0)
+	{
+		vertices = VENG_Alloc(VENG_MEMORY_TEXTURES, quads_size * 4, sizeof(SDL_Vertex));
+		if (vertices == NULL)
+		{
+			return -1;
+		}
+	}
+	float atlas_size = font->atlas_size;
+	int pen_x = 0, pen_y = 0, width = 0;
+	size_t quads = 0;
+	size_t word_quad = 0; // First quad of the current word
+	int word_x = 0;       // Pen position where the current word starts
+	bool line_has_break = false;
+	Uint32 previous = 0;
+	for (const char* c = line->text; *c != '\0';)
+	{
+		Uint32 codepoint = __DecodeUTF8(&c);
+		if (codepoint == '\n')
+		{
+			pen_x = 0;
+			pen_y += font->line_skip;
+			word_quad = quads;
+			word_x = 0;
+			line_has_break = false;
+			previous = 0;
+			continue;
+		}
+		if (codepoint == ' ' || codepoint == '\t')
+		{
+			VENG_Glyph* space = __GetGlyph(font, ' ');
+			pen_x += space != NULL ? space->advance * (codepoint == '\t' ? 4 : 1) : 0;
+			word_quad = quads;
+			word_x = pen_x;
+			line_has_break = true;
+			previous = codepoint;
+			continue;
+		}
+		VENG_Glyph* glyph = __GetGlyph(font, codepoint);
+		if (glyph == NULL)
+		{
+			VENG_Free(VENG_MEMORY_TEXTURES, vertices, quads_size * 4, sizeof(SDL_Vertex));
+			return 1;
+		}
+		if (previous != 0)
+		{
+			pen_x += TTF_GetFontKerningSizeGlyphs32(font->ttf, previous, codepoint);
+		}
+		// Greedy wrap: the current word moves to a new line
+		if (line->wrap_width > 0 && pen_x + glyph->advance > line->wrap_width && line_has_break)
+		{
+			int shift = word_x;
+			for (size_t q = word_quad * 4; q < quads * 4; q++)
+			{
+				vertices[q].position.x -= shift;
+				vertices[q].position.y += font->line_skip;
+			}
+			pen_x -= shift;
+			pen_y += font->line_skip;
+			word_x = 0;
+			line_has_break = false;
+		}
+		SDL_Rect r = glyph->atlas;
+		if (r.w > 0 && r.h > 0)
+		{
+			float x0 = pen_x, y0 = pen_y, x1 = pen_x + r.w, y1 = pen_y + r.h;
+			float u0 = r.x / atlas_size, v0 = r.y / atlas_size, u1 = (r.x + r.w) / atlas_size, v1 = (r.y + r.h) / atlas_size;
+			SDL_Color white = {255, 255, 255, 255};
+			vertices[quads * 4 + 0] = (SDL_Vertex){{x0, y0}, white, {u0, v0}};
+			vertices[quads * 4 + 1] = (SDL_Vertex){{x1, y0}, white, {u1, v0}};
+			vertices[quads * 4 + 2] = (SDL_Vertex){{x0, y1}, white, {u0, v1}};
+			vertices[quads * 4 + 3] = (SDL_Vertex){{x1, y1}, white, {u1, v1}};
+			quads++;
+		}
+		pen_x += glyph->advance;
+		if (pen_x > width) width = pen_x;
+		previous = codepoint;
+	}
+	line->vertices = vertices;
+	line->quads = quads;
+	line->quads_size = quads_size;
+	line->w = width;
+	line->h = pen_y + font->line_skip;
+	line->generation = font->generation;
+	return 0;
+}
+
+static VENG_TextLine* __GetTextLine(VENG_Font* font, const char* text, int wrap_width)
+{
+	size_t length = strlen(text);
+	Uint64 hash = __HashText(text, length, font, wrap_width);
+	VENG_TextLine* line = NULL;
+	if (text_buckets != NULL)
+	{
+		for (line = text_buckets[hash & (text_buckets_size - 1)]; line != NULL; line = line->bucket_next)
+		{
+			if (line->hash == hash && line->font == font && line->size == font->size && line->wrap_width == wrap_width &&
+				line->text_length == length && memcmp(line->text, text, length) == 0)
+			{
+				break;
+			}
+		}
+	}
+	if (line != NULL && line->generation == font->generation)
+	{
+		__LRUUnlink(line);
+		__LRUPushFront(line);
+		return line;
+	}
+	if (line != NULL)
+	{
+		// The atlas was reset since, lay it out again
+		__FreeTextLine(line);
+	}
+
+	if ((text_lines_count + 1) * 2 > text_buckets_size && __GrowTextBuckets() != 0)
+	{
+		return NULL;
+	}
+	line = VENG_Alloc(VENG_MEMORY_TEXTURES, 1, sizeof(VENG_TextLine));
+	char* copy = VENG_Alloc(VENG_MEMORY_TEXTURES, length + 1, sizeof(char));
+	if (line == NULL || copy == NULL)
+	{
+		VENG_Free(VENG_MEMORY_TEXTURES, copy, length + 1, sizeof(char));
+		VENG_Free(VENG_MEMORY_TEXTURES, line, 1, sizeof(VENG_TextLine));
+		return NULL;
+	}
+	memcpy(copy, text, length + 1);
+	line->hash = hash;
+	line->font = font;
+	line->size = font->size;
+	line->wrap_width = wrap_width;
+	line->text = copy;
+	line->text_length = length;
+
+	int result = __LayoutText(line);
+	if (result == 1)
+	{
+		// Atlas full: start over with a clean (and if possible bigger) one
+		__ResetAtlas(font);
+		result = __LayoutText(line);
+	}
+	if (result != 0)
+	{
+		printf("Couldn't lay out text\n");
+		VENG_Free(VENG_MEMORY_TEXTURES, copy, length + 1, sizeof(char));
+		VENG_Free(VENG_MEMORY_TEXTURES, line, 1, sizeof(VENG_TextLine));
+		return NULL;
+	}
+	line->bytes = sizeof(VENG_TextLine) + length + 1 + line->quads_size * 4 * sizeof(SDL_Vertex);
+	line->bucket_next = text_buckets[hash & (text_buckets_size - 1)];
+	text_buckets[hash & (text_buckets_size - 1)] = line;
+	__LRUPushFront(line);
+	text_lines_count++;
+	text_cache_bytes += line->bytes;
+	__EvictTextLines(line);
+	return line;
+}
+
+/*==========================================================================*\
+ *                   				Text
+\*==========================================================================*/
+static int __ReserveDrawBuffers(size_t quads)
+{
+	size_t new_size = 64;
+	while (new_size < quads) new_size *= 2;
+	if (quads > draw_vertices_quads)
+	{
+		SDL_Vertex* vertices = VENG_Realloc(VENG_MEMORY_TEXTURES, draw_vertices, draw_vertices_quads * 4, new_size * 4, sizeof(SDL_Vertex));
+		if (vertices == NULL) return 1;
+		draw_vertices = vertices;
+		draw_vertices_quads = new_size;
+	}
+	if (quads > draw_indices_quads)
+	{
+		int* indices = VENG_Realloc(VENG_MEMORY_TEXTURES, draw_indices, draw_indices_quads * 6, new_size * 6, sizeof(int));
+		if (indices == NULL) return 1;
+		draw_indices = indices;
+		// Every quad uses the same two triangles
+		for (size_t q = draw_indices_quads; q < new_size; q++)
+		{
+			int base = q * 4;
+			int* index = &draw_indices[q * 6];
+			index[0] = base; index[1] = base + 1; index[2] = base + 2;
+			index[3] = base + 2; index[4] = base + 1; index[5] = base + 3;
+		}
+		draw_indices_quads = new_size;
+	}
+	return 0;
+}
+
+int VENG_DrawText(VENG_Font* font, const char* text, int x, int y, int wrap_width, SDL_Color color)
+{
+	if (!VENG_HasStarted())
+	{
+		printf("VENG is not initialized yet\n");
+		return 1;
+	}
+	if (font == NULL || text == NULL)
+	{
+		printf("Font or text cannot be NULL\n");
+		return 1;
+	}
+	if (__GetAtlas(font) == NULL)
+	{
+		return 1;
+	}
+	VENG_TextLine* line = __GetTextLine(font, text, wrap_width);
+	SDL_Texture* atlas = font->atlases[VENG_GetWindowSlot()]; // Made again if the atlas grew on the way
+	if (line == NULL || atlas == NULL)
+	{
+		return 1;
+	}
+	if (line->quads == 0)
+	{
+		return 0;
+	}
+	if (__ReserveDrawBuffers(line->quads) != 0)
+	{
+		return 1;
+	}
+	for (size_t i = 0; i < line->quads * 4; i++)
+	{
+		draw_vertices[i] = line->vertices[i];
+		draw_vertices[i].position.x += x;
+		draw_vertices[i].position.y += y;
+		draw_vertices[i].color = color;
+	}
+	// Rasterized whole or not at all
+	if (font->atlas_pixels != NULL && VENG_IsMainWindow() && VENG_RasterQuads(atlas, draw_vertices, line->quads))
+	{
+		return 0;
+	}
+	VENG_PaintFlush(); // Keeps the order with batched and rasterized primitives
+	return SDL_RenderGeometry(VENG_GetDriver().renderer, atlas, draw_vertices, line->quads * 4, draw_indices, line->quads * 6) == 0 ? 0 : 1;
+}
+
+int VENG_MeasureText(VENG_Font* font, const char* text, int wrap_width, int* w, int* h)
+{
+	if (!VENG_HasStarted())
+	{
+		printf("VENG is not initialized yet\n");
+		return 1;
+	}
+	if (font == NULL || text == NULL)
+	{
+		printf("Font or text cannot be NULL\n");
+		return 1;
+	}
+	VENG_TextLine* line = __GetTextLine(font, text, wrap_width);
+	if (line == NULL)
+	{
+		return 1;
+	}
+	if (w != NULL) *w = line->w;
+	if (h != NULL) *h = line->h;
+	return 0;
+}
+
+int VENG_SetTextCacheBudget(size_t bytes)
+{
+	text_cache_budget = bytes;
+	__EvictTextLines(NULL);
+	return 0;
+}
+
+void VENG_ClearTextCache()
+{
+	while (lru_tail != NULL)
+	{
+		__FreeTextLine(lru_tail);
+	}
+}
+
+void VENG_ForgetWindowText(size_t window)
+{
+	for (VENG_Font* font = fonts; font != NULL; font = font->next)
+	{
+		__DestroyAtlas(font, window);
+	}
+}
+
+void VENG_DestroyText()
+{
+	VENG_ClearTextCache();
+	while (fonts != NULL)
+	{
+		VENG_CloseFont(fonts);
+	}
+	VENG_Free(VENG_MEMORY_TEXTURES, text_buckets, text_buckets_size, sizeof(VENG_TextLine*));
+	VENG_Free(VENG_MEMORY_TEXTURES, draw_vertices, draw_vertices_quads * 4, sizeof(SDL_Vertex));
+	VENG_Free(VENG_MEMORY_TEXTURES, draw_indices, draw_indices_quads * 6, sizeof(int));
+	text_buckets = NULL;
+	text_buckets_size = 0;
+	draw_vertices = NULL;
+	draw_vertices_quads = 0;
+	draw_indices = NULL;
+	draw_indices_quads = 0;
+}
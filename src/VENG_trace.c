@@ -0,0 +1,311 @@
+#include <SDL2/SDL.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "VENG/VENG.h"
+
+// Tracing:
+// Spans are stored as complete events in a ring buffer owned by the thread that produced
+// them (single producer, single consumer), so recording one is a couple of stores.
+// A writer thread drains every ring into a Chrome/Perfetto JSON trace file.
+
+#define TRACE_RING_SIZE 8192 // Power of 2
+#define TRACE_MAX_DEPTH 64
+#define TRACE_FLUSH_MS 50
+
+typedef struct VENG_TraceEvent
+{
+	const char* name;
+	const void* object;
+	Uint64 start;
+	Uint64 duration;
+} VENG_TraceEvent;
+
+typedef struct VENG_TraceRing
+{
+	VENG_TraceEvent events[TRACE_RING_SIZE];
+	SDL_atomic_t head; // Written by the producer
+	SDL_atomic_t tail; // Written by the writer thread
+	unsigned long thread_id;
+	Uint64 dropped;
+
+	// Open spans, only touched by the producer
+	int depth;
+	const char* names[TRACE_MAX_DEPTH];
+	const void* objects[TRACE_MAX_DEPTH];
+	Uint64 starts[TRACE_MAX_DEPTH];
+
+	struct VENG_TraceRing* next;
+} VENG_TraceRing;
+
+static bool tracing = false;
+static FILE* trace_file = NULL;
+static bool trace_first_event = true;
+static size_t trace_prepare_threshold = 0;
+static Uint64 trace_start = 0;
+static Uint64 trace_frequency = 1;
+static Uint64 trace_last_frame = 0;
+
+static SDL_mutex* trace_mutex = NULL; // Guards the ring list and the file
+static SDL_cond* trace_cond = NULL;
+static SDL_Thread* trace_writer = NULL;
+static bool trace_writer_quit = false;
+
+static VENG_TraceRing* trace_rings = NULL;
+static Uint32 trace_rings_generation = 1; // Bumped when rings are freed
+static _Thread_local VENG_TraceRing* thread_ring = NULL;
+static _Thread_local Uint32 thread_ring_generation = 0;
+
+static VENG_TraceRing* __GetThreadRing()
+{
+	if (thread_ring != NULL && thread_ring_generation == trace_rings_generation)
+	{
+		return thread_ring;
+	}
+	VENG_TraceRing* ring = VENG_Alloc(VENG_MEMORY_DIAGNOSTICS, 1, sizeof(VENG_TraceRing));
+	if (ring == NULL)
+	{
+		return NULL;
+	}
+	ring->thread_id = SDL_ThreadID();
+	SDL_LockMutex(trace_mutex);
+	ring->next = trace_rings;
+	trace_rings = ring;
+	SDL_UnlockMutex(trace_mutex);
+	thread_ring = ring;
+	thread_ring_generation = trace_rings_generation;
+	return ring;
+}
+
+static void __PushEvent(VENG_TraceRing* ring, const char* name, const void* object, Uint64 start, Uint64 end)
+{
+	Uint32 head = SDL_AtomicGet(&ring->head);
+	if (head - (Uint32)SDL_AtomicGet(&ring->tail) >= TRACE_RING_SIZE)
+	{
+		ring->dropped++;
+		return;
+	}
+	VENG_TraceEvent* event = &ring->events[head & (TRACE_RING_SIZE - 1)];
+	event->name = name;
+	event->object = object;
+	event->start = start;
+	event->duration = end - start;
+	SDL_MemoryBarrierRelease();
+	SDL_AtomicSet(&ring->head, head + 1);
+}
+
+// Must be called with trace_mutex locked
+static void __DrainRings()
+{
+	for (VENG_TraceRing* ring = trace_rings; ring != NULL; ring = ring->next)
+	{
+		Uint32 head = SDL_AtomicGet(&ring->head);
+		SDL_MemoryBarrierAcquire();
+		Uint32 tail = SDL_AtomicGet(&ring->tail);
+		for (; tail != head; tail++)
+		{
+			VENG_TraceEvent* event = &ring->events[tail & (TRACE_RING_SIZE - 1)];
+			double ts = (double)(event->start - trace_start) * 1000000.0 / trace_frequency;
+			double dur = (double)event->duration * 1000000.0 / trace_frequency;
+			fprintf(trace_file, "%s{\"name\":\"%s\",\"cat\":\"VENG\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%lu,\"args\":{\"object\":\"%p\"}}",
+					trace_first_event ? "" : ",\n", event->name, ts, dur, ring->thread_id, event->object);
+			trace_first_event = false;
+		}
+		SDL_AtomicSet(&ring->tail, tail);
+	}
+}
+
+static int __TraceWriter(void* data)
+{
+	SDL_LockMutex(trace_mutex);
+	while (!trace_writer_quit)
+	{
+		SDL_CondWaitTimeout(trace_cond, trace_mutex, TRACE_FLUSH_MS);
+		__DrainRings();
+	}
+	SDL_UnlockMutex(trace_mutex);
+	return 0;
+}
+
+/*==========================================================================*\
+ *                   				Session
+\*==========================================================================*/
+int VENG_StartTracing(const char* path, size_t prepare_threshold)
+{
+	if (!VENG_HasStarted())
+	{
+		printf("VENG is not initialized yet\n");
+		return 1;
+	}
+	if (path == NULL)
+	{
+		printf("Path is NULL\n");
+		return 1;
+	}
+	if (tracing)
+	{
+		printf("VENG is already tracing\n");
+		return 1;
+	}
+	if (trace_mutex == NULL)
+	{
+		trace_mutex = SDL_CreateMutex();
+		trace_cond = SDL_CreateCond();
+		if (trace_mutex == NULL || trace_cond == NULL)
+		{
+			printf("Couldn't create trace mutex: %s\n", SDL_GetError());
+			return 1;
+		}
+	}
+	trace_file = fopen(path, "w");
+	if (trace_file == NULL)
+	{
+		printf("Couldn't open %s\n", path);
+		return 1;
+	}
+	fprintf(trace_file, "[\n");
+	trace_first_event = true;
+	trace_prepare_threshold = prepare_threshold;
+	trace_frequency = SDL_GetPerformanceFrequency();
+	trace_start = SDL_GetPerformanceCounter();
+	trace_last_frame = trace_start;
+	for (VENG_TraceRing* ring = trace_rings; ring != NULL; ring = ring->next)
+	{
+		SDL_AtomicSet(&ring->tail, SDL_AtomicGet(&ring->head));
+		ring->depth = 0;
+		ring->dropped = 0;
+	}
+
+	trace_writer_quit = false;
+	trace_writer = SDL_CreateThread(__TraceWriter, "VENG trace", NULL);
+	if (trace_writer == NULL)
+	{
+		printf("Couldn't start trace writer: %s\n", SDL_GetError());
+		fclose(trace_file);
+		trace_file = NULL;
+		return 1;
+	}
+	tracing = true;
+	return 0;
+}
+
+int VENG_StopTracing()
+{
+	if (!tracing)
+	{
+		printf("VENG is not tracing\n");
+		return 1;
+	}
+	tracing = false;
+	SDL_LockMutex(trace_mutex);
+	trace_writer_quit = true;
+	SDL_CondSignal(trace_cond);
+	SDL_UnlockMutex(trace_mutex);
+	SDL_WaitThread(trace_writer, NULL);
+	trace_writer = NULL;
+
+	SDL_LockMutex(trace_mutex);
+	__DrainRings();
+	Uint64 dropped = 0;
+	for (VENG_TraceRing* ring = trace_rings; ring != NULL; ring = ring->next)
+	{
+		dropped += ring->dropped;
+	}
+	SDL_UnlockMutex(trace_mutex);
+	fprintf(trace_file, "\n]\n");
+	int result = fclose(trace_file) == 0 ? 0 : 1;
+	trace_file = NULL;
+	if (dropped > 0)
+	{
+		printf("Trace ring full: %llu events dropped\n", (unsigned long long)dropped);
+	}
+	return result;
+}
+
+bool VENG_IsTracing()
+{
+	return tracing;
+}
+
+size_t VENG_GetTracePrepareThreshold()
+{
+	return trace_prepare_threshold;
+}
+
+/*==========================================================================*\
+ *                   				Spans
+\*==========================================================================*/
+void VENG_TraceBegin(const char* name, const void* object)
+{
+	if (!tracing)
+	{
+		return;
+	}
+	VENG_TraceRing* ring = __GetThreadRing();
+	if (ring == NULL)
+	{
+		return;
+	}
+	if (ring->depth < TRACE_MAX_DEPTH)
+	{
+		ring->names[ring->depth] = name;
+		ring->objects[ring->depth] = object;
+		ring->starts[ring->depth] = SDL_GetPerformanceCounter();
+	}
+	ring->depth++;
+}
+
+void VENG_TraceEnd()
+{
+	if (!tracing)
+	{
+		return;
+	}
+	VENG_TraceRing* ring = __GetThreadRing();
+	if (ring == NULL || ring->depth == 0)
+	{
+		return;
+	}
+	ring->depth--;
+	if (ring->depth < TRACE_MAX_DEPTH)
+	{
+		__PushEvent(ring, ring->names[ring->depth], ring->objects[ring->depth], ring->starts[ring->depth], SDL_GetPerformanceCounter());
+	}
+}
+
+void VENG_TraceFrame()
+{
+	Uint64 now = SDL_GetPerformanceCounter();
+	if (tracing)
+	{
+		VENG_TraceRing* ring = __GetThreadRing();
+		if (ring != NULL)
+		{
+			__PushEvent(ring, "Frame", NULL, trace_last_frame, now);
+		}
+	}
+	trace_last_frame = now;
+}
+
+void VENG_DestroyTrace()
+{
+	if (tracing)
+	{
+		VENG_StopTracing();
+	}
+	while (trace_rings != NULL)
+	{
+		VENG_TraceRing* next = trace_rings->next;
+		VENG_Free(VENG_MEMORY_DIAGNOSTICS, trace_rings, 1, sizeof(VENG_TraceRing));
+		trace_rings = next;
+	}
+	trace_rings_generation++;
+	if (trace_mutex != NULL)
+	{
+		SDL_DestroyCond(trace_cond);
+		SDL_DestroyMutex(trace_mutex);
+		trace_cond = NULL;
+		trace_mutex = NULL;
+	}
+}
@@ -0,0 +1,441 @@
+#include <SDL2/SDL.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "VENG/VENG.h"
+
+// Headless paint benchmark and pixel regression suite:
+// (I)   Runs on the dummy video driver with a software renderer drawing into a surface, so
+//       it needs no display and every machine paints the same pixels.
+// (II)  Every scene is laid out once, then painted for a number of frames (VENG_DrawScreen
+//       and VENG_Present) and the time of each frame goes into a distribution.
+// (III) The last frame is compared with the scene's golden image. --update only writes the
+//       missing ones, an existing golden image is replaced by hand after looking at the diff.
+// Usage: VENG_bench [--frames n] [--scene name] [--font path] [--raster threads]
+//                   [--golden dir] [--update]
+
+#define BENCH_W 800
+#define BENCH_H 600
+#define BENCH_WARMUP 10
+#define BENCH_FONT_SIZE 14
+
+typedef struct BenchScene
+{
+	const char* name;
+	VENG_Screen* (*build)();
+} BenchScene;
+
+static VENG_Font* font = NULL;
+
+static SDL_Color __Color(size_t seed)
+{
+	Uint32 hash = (Uint32)(seed * 2654435761u);
+	return (SDL_Color){64 + (hash & 0x7F), 64 + ((hash >> 8) & 0x7F), 64 + ((hash >> 16) & 0x7F), 255};
+}
+
+static size_t __Depth(VENG_Element* element)
+{
+	size_t depth = 0;
+	for (void* parent = element->parent; parent != NULL && ((VENG_Element*)parent)->type == VENG_TYPE_ELEMENT; parent = ((VENG_Element*)parent)->parent)
+	{
+		depth++;
+	}
+	return depth;
+}
+
+static VENG_Screen* __Screen(VENG_Layer* layer)
+{
+	VENG_Screen* screen = VENG_CreateScreen("VENG bench", NULL, 1);
+	if (screen == NULL || layer == NULL || VENG_AddLayerToScreen(layer, screen) != 0)
+	{
+		return NULL;
+	}
+	return screen;
+}
+
+/*==========================================================================*\
+ *                   				Scenes
+\*==========================================================================*/
+// Dense text: wrapped paragraphs filling 3 x 10 cells
+static const char* paragraph = "The quick brown fox jumps over the lazy dog, then 0123456789 times back again (!?).";
+
+static void __PaintText(VENG_Element* element, SDL_Renderer* renderer)
+{
+	VENG_PaintFillRect(element->rect, (SDL_Color){245, 245, 240, 255});
+	VENG_DrawText(font, paragraph, element->rect.x + 4, element->rect.y + 2, element->rect.w - 8, __Color(element->slot));
+}
+
+static VENG_Screen* __BuildText()
+{
+	if (font == NULL)
+	{
+		return NULL;
+	}
+	VENG_Layer* layer = VENG_CreateLayer(VENG_CreateLayout(VENG_GRID, VENG_LEFT, VENG_TOP), 3 * 10);
+	VENG_Track columns[3] = {{VENG_TRACK_FRACTION, 1}, {VENG_TRACK_FRACTION, 1}, {VENG_TRACK_FRACTION, 1}};
+	VENG_Track rows[1] = {{VENG_TRACK_FRACTION, 1}};
+	if (layer == NULL || VENG_SetGridTracks(layer, columns, 3, rows, 1) != 0)
+	{
+		return NULL;
+	}
+	for (size_t i = 0; i < 3 * 10; i++)
+	{
+		// Stretched, so every paragraph takes its whole cell and wraps at its width
+		VENG_Element* element = VENG_CreateElement(1, 1, true, true, VENG_CreateLayout(VENG_VERTICAL, VENG_LEFT, VENG_TOP), 0);
+		if (element == NULL || VENG_SetPaintCallback(element, __PaintText) != 0 || VENG_AddElementToLayer(element, layer) != 0)
+		{
+			return NULL;
+		}
+	}
+	return __Screen(layer);
+}
+
+// Many small elements: a 64x64 grid of cells
+static void __PaintCell(VENG_Element* element, SDL_Renderer* renderer)
+{
+	VENG_PaintFillRect(element->rect, __Color(element->slot));
+}
+
+static VENG_Screen* __BuildSmall()
+{
+	VENG_Layer* layer = VENG_CreateLayer(VENG_CreateLayout(VENG_GRID, VENG_LEFT, VENG_TOP), 64 * 64);
+	VENG_Track columns[64];
+	for (size_t i = 0; i < 64; i++)
+	{
+		columns[i] = (VENG_Track){VENG_TRACK_FRACTION, 1};
+	}
+	VENG_Track rows[1] = {{VENG_TRACK_FIXED, BENCH_H / 64}};
+	if (layer == NULL || VENG_SetGridTracks(layer, columns, 64, rows, 1) != 0)
+	{
+		return NULL;
+	}
+	for (size_t i = 0; i < 64 * 64; i++)
+	{
+		VENG_Element* element = VENG_CreateElement(1, 1, false, true, VENG_CreateLayout(VENG_HORIZONTAL, VENG_LEFT, VENG_TOP), 0);
+		if (element == NULL || VENG_SetPaintCallback(element, __PaintCell) != 0 || VENG_AddElementToLayer(element, layer) != 0)
+		{
+			return NULL;
+		}
+	}
+	return __Screen(layer);
+}
+
+// Deep nesting: columns of 48 elements nested in each other
+static void __PaintNested(VENG_Element* element, SDL_Renderer* renderer)
+{
+	size_t depth = __Depth(element);
+	VENG_PaintBorder(element->rect, 1 + depth % 3, __Color(depth));
+}
+
+static VENG_Screen* __BuildNesting()
+{
+	VENG_Layer* layer = VENG_CreateLayer(VENG_CreateLayout(VENG_HORIZONTAL, VENG_LEFT, VENG_TOP), 8);
+	if (layer == NULL)
+	{
+		return NULL;
+	}
+	for (size_t i = 0; i < 8; i++)
+	{
+		void* parent = layer;
+		for (size_t depth = 0; depth < 48; depth++)
+		{
+			VENG_Element* element = VENG_CreateElement(depth == 0 ? 1.0f / 8 : 0.96f, depth == 0 ? 1 : 0.97f, false, true, VENG_CreateLayout(VENG_HORIZONTAL, VENG_CENTER, VENG_CENTER), 1);
+			if (element == NULL || VENG_SetPaintCallback(element, __PaintNested) != 0)
+			{
+				return NULL;
+			}
+			if ((parent == layer ? VENG_AddElementToLayer(element, layer) : VENG_AddSubElementToElement(element, parent)) != 0)
+			{
+				return NULL;
+			}
+			parent = element;
+		}
+	}
+	return __Screen(layer);
+}
+
+// Heavy clipping: every element paints far past its rect, VENG_StartDrawing cuts it
+static void __PaintOverflow(VENG_Element* element, SDL_Renderer* renderer)
+{
+	SDL_Rect rect = element->rect;
+	VENG_PaintRoundedRect((SDL_Rect){rect.x - rect.w, rect.y - rect.h / 2, rect.w * 2, rect.h * 2}, rect.h / 2, __Color(element->slot));
+	VENG_PaintRoundedBorder((SDL_Rect){rect.x + rect.w / 2, rect.y - rect.h, rect.w, rect.h * 3}, 12, 3, __Color(element->slot + 7));
+}
+
+static VENG_Screen* __BuildClipping()
+{
+	VENG_Layer* layer = VENG_CreateLayer(VENG_CreateLayout(VENG_GRID, VENG_LEFT, VENG_TOP), 16 * 12);
+	VENG_Track columns[16];
+	for (size_t i = 0; i < 16; i++)
+	{
+		columns[i] = (VENG_Track){VENG_TRACK_FRACTION, 1};
+	}
+	VENG_Track rows[1] = {{VENG_TRACK_FIXED, BENCH_H / 12}};
+	if (layer == NULL || VENG_SetGridTracks(layer, columns, 16, rows, 1) != 0)
+	{
+		return NULL;
+	}
+	for (size_t i = 0; i < 16 * 12; i++)
+	{
+		VENG_Element* element = VENG_CreateElement(1, 1, false, true, VENG_CreateLayout(VENG_HORIZONTAL, VENG_CENTER, VENG_CENTER), 1);
+		VENG_Element* inner = VENG_CreateElement(0.5f, 0.5f, false, true, VENG_CreateLayout(VENG_HORIZONTAL, VENG_LEFT, VENG_TOP), 0);
+		if (element == NULL || inner == NULL || VENG_SetPaintCallback(element, __PaintOverflow) != 0 || VENG_SetPaintCallback(inner, __PaintOverflow) != 0)
+		{
+			return NULL;
+		}
+		if (VENG_AddSubElementToElement(inner, element) != 0 || VENG_AddElementToLayer(element, layer) != 0)
+		{
+			return NULL;
+		}
+	}
+	return __Screen(layer);
+}
+
+static const BenchScene scenes[] = {
+	{"text", __BuildText},
+	{"small", __BuildSmall},
+	{"nesting", __BuildNesting},
+	{"clipping", __BuildClipping}
+};
+
+/*==========================================================================*\
+ *                   				Measure
+\*==========================================================================*/
+static int __CompareTimes(const void* a, const void* b)
+{
+	double x = *(const double*)a, y = *(const double*)b;
+	return (x > y) - (x < y);
+}
+
+static double __Percentile(double* sorted, size_t count, double percentile)
+{
+	size_t index = (size_t)(percentile * (count - 1) + 0.5);
+	return sorted[index];
+}
+
+static void __DrawFrame(VENG_Screen* screen, SDL_Renderer* renderer)
+{
+	SDL_SetRenderDrawColor(renderer, 24, 24, 28, 255);
+	SDL_RenderClear(renderer);
+	VENG_DrawScreen(screen);
+	VENG_Present();
+}
+
+static void __Measure(const char* name, VENG_Screen* screen, SDL_Renderer* renderer, size_t frames)
+{
+	double* times = malloc(frames * sizeof(double));
+	if (times == NULL)
+	{
+		printf("Couldn't allocate frame times\n");
+		return;
+	}
+	for (size_t i = 0; i < BENCH_WARMUP; i++)
+	{
+		__DrawFrame(screen, renderer);
+	}
+	double frequency = (double)SDL_GetPerformanceFrequency();
+	size_t draw_calls = VENG_GetPaintDrawCalls();
+	double total = 0;
+	for (size_t i = 0; i < frames; i++)
+	{
+		Uint64 start = SDL_GetPerformanceCounter();
+		__DrawFrame(screen, renderer);
+		times[i] = (SDL_GetPerformanceCounter() - start) * 1000.0 / frequency;
+		total += times[i];
+	}
+	draw_calls = VENG_GetPaintDrawCalls() - draw_calls;
+	qsort(times, frames, sizeof(double), __CompareTimes);
+	printf("%-10s %8.1f fps | ms mean %7.3f  p50 %7.3f  p90 %7.3f  p99 %7.3f  max %7.3f | %zu draw calls/frame\n",
+		name, frames * 1000.0 / total, total / frames, __Percentile(times, frames, 0.5), __Percentile(times, frames, 0.9),
+		__Percentile(times, frames, 0.99), times[frames - 1], draw_calls / frames);
+	free(times);
+}
+
+/*==========================================================================*\
+ *                   				Golden images
+\*==========================================================================*/
+static SDL_Surface* __ReadFrame(SDL_Renderer* renderer)
+{
+	SDL_Surface* frame = SDL_CreateRGBSurfaceWithFormat(0, BENCH_W, BENCH_H, 32, SDL_PIXELFORMAT_ARGB8888);
+	if (frame == NULL || SDL_RenderReadPixels(renderer, NULL, SDL_PIXELFORMAT_ARGB8888, frame->pixels, frame->pitch) != 0)
+	{
+		printf("Couldn't read the frame: %s\n", SDL_GetError());
+		if (frame != NULL) SDL_FreeSurface(frame);
+		return NULL;
+	}
+	return frame;
+}
+
+// Returns the number of pixels that differ, -1 if the golden image can't be read
+static long __Compare(SDL_Surface* frame, const char* path)
+{
+	SDL_Surface* loaded = SDL_LoadBMP(path);
+	SDL_Surface* golden = loaded != NULL ? SDL_ConvertSurfaceFormat(loaded, SDL_PIXELFORMAT_ARGB8888, 0) : NULL;
+	if (loaded != NULL) SDL_FreeSurface(loaded);
+	if (golden == NULL || golden->w != frame->w || golden->h != frame->h)
+	{
+		if (golden != NULL) SDL_FreeSurface(golden);
+		return -1;
+	}
+	long different = 0;
+	for (int y = 0; y < frame->h; y++)
+	{
+		Uint32* a = (Uint32*)((Uint8*)frame->pixels + y * frame->pitch);
+		Uint32* b = (Uint32*)((Uint8*)golden->pixels + y * golden->pitch);
+		for (int x = 0; x < frame->w; x++)
+		{
+			// The alpha channel of a saved frame isn't meaningful
+			different += (a[x] & 0xFFFFFF) != (b[x] & 0xFFFFFF);
+		}
+	}
+	SDL_FreeSurface(golden);
+	return different;
+}
+
+static int __CheckGolden(const char* name, SDL_Renderer* renderer, const char* directory, bool raster, bool update)
+{
+	char path[512];
+	snprintf(path, sizeof(path), "%s/%s%s.bmp", directory, name, raster ? "_raster" : "");
+	SDL_Surface* frame = __ReadFrame(renderer);
+	if (frame == NULL)
+	{
+		return 1;
+	}
+	int result = 0;
+	SDL_RWops* existing = update ? SDL_RWFromFile(path, "rb") : NULL;
+	if (existing != NULL)
+	{
+		SDL_RWclose(existing); // Compared like without --update
+	}
+	else if (update)
+	{
+		if (SDL_SaveBMP(frame, path) != 0)
+		{
+			printf("Couldn't write %s: %s\n", path, SDL_GetError());
+			result = 1;
+		}
+		else
+		{
+			printf("%-10s wrote %s\n", name, path);
+		}
+		SDL_FreeSurface(frame);
+		return result;
+	}
+	long different = __Compare(frame, path);
+	if (different != 0)
+	{
+		// The frame is kept next to the build to look at
+		char actual[512];
+		snprintf(actual, sizeof(actual), "build/%s%s.bmp", name, raster ? "_raster" : "");
+		SDL_SaveBMP(frame, actual);
+		if (different < 0)
+		{
+			printf("%-10s FAILED, no usable golden image at %s (--update writes missing ones), frame saved in %s\n", name, path, actual);
+		}
+		else
+		{
+			printf("%-10s FAILED, %ld pixels differ from %s, frame saved in %s (copy it over the golden image if the change is intended)\n", name, different, path, actual);
+		}
+		result = 1;
+	}
+	else
+	{
+		printf("%-10s matches %s\n", name, path);
+	}
+	SDL_FreeSurface(frame);
+	return result;
+}
+
+int main(int argc, char* argv[])
+{
+	size_t frames = 200;
+	const char* only = NULL;
+	const char* font_path = NULL;
+	const char* directory = "tools/golden";
+	int raster_threads = 0;
+	bool update = false;
+	for (int i = 1; i < argc; i++)
+	{
+		bool value = i + 1 < argc;
+		if (strcmp(argv[i], "--update") == 0) update = true;
+		else if (strcmp(argv[i], "--frames") == 0 && value) frames = (size_t)strtoul(argv[++i], NULL, 10);
+		else if (strcmp(argv[i], "--scene") == 0 && value) only = argv[++i];
+		else if (strcmp(argv[i], "--font") == 0 && value) font_path = argv[++i];
+		else if (strcmp(argv[i], "--golden") == 0 && value) directory = argv[++i];
+		else if (strcmp(argv[i], "--raster") == 0 && value) raster_threads = atoi(argv[++i]);
+		else
+		{
+			printf("Usage: %s [--frames n] [--scene name] [--font path] [--raster threads] [--golden dir] [--update]\n", argv[0]);
+			return 1;
+		}
+	}
+	if (frames == 0)
+	{
+		printf("At least one frame is needed\n");
+		return 1;
+	}
+
+	// SDL_VIDEODRIVER set in the environment still wins over the hint
+	SDL_SetHint(SDL_HINT_VIDEODRIVER, "dummy");
+	if (SDL_Init(SDL_INIT_VIDEO) != 0)
+	{
+		printf("Couldn't start SDL: %s\n", SDL_GetError());
+		return 1;
+	}
+	SDL_Window* window = SDL_CreateWindow("VENG bench", 0, 0, BENCH_W, BENCH_H, SDL_WINDOW_HIDDEN);
+	SDL_Surface* target = SDL_CreateRGBSurfaceWithFormat(0, BENCH_W, BENCH_H, 32, SDL_PIXELFORMAT_ARGB8888);
+	SDL_Renderer* renderer = target != NULL ? SDL_CreateSoftwareRenderer(target) : NULL;
+	if (window == NULL || renderer == NULL)
+	{
+		printf("Couldn't create the software renderer: %s\n", SDL_GetError());
+		return 1;
+	}
+	if (VENG_Init(VENG_CreateDriver(window, renderer)) != 0 || (raster_threads != 0 && VENG_SetSoftwareRaster(raster_threads) != 0))
+	{
+		return 1;
+	}
+	if (font_path != NULL && (font = VENG_OpenFont(font_path, BENCH_FONT_SIZE)) == NULL)
+	{
+		printf("Couldn't open %s\n", font_path);
+	}
+
+	int result = 0;
+	size_t ran = 0;
+	for (size_t i = 0; i < sizeof(scenes) / sizeof(scenes[0]); i++)
+	{
+		if (only != NULL && strcmp(only, scenes[i].name) != 0)
+		{
+			continue;
+		}
+		VENG_Screen* screen = scenes[i].build();
+		if (screen == NULL)
+		{
+			printf("%-10s skipped%s\n", scenes[i].name, font == NULL && scenes[i].build == __BuildText ? " (needs --font)" : ", couldn't build it");
+			result |= font != NULL || scenes[i].build != __BuildText;
+			continue;
+		}
+		if (VENG_SetScreen(screen) != 0)
+		{
+			result = 1;
+			continue;
+		}
+		__Measure(scenes[i].name, screen, renderer, frames);
+		result |= __CheckGolden(scenes[i].name, renderer, directory, raster_threads != 0, update);
+		ran++;
+	}
+	if (ran == 0)
+	{
+		printf("No scene ran\n");
+		result = 1;
+	}
+
+	if (font != NULL) VENG_CloseFont(font);
+	VENG_Destroy();
+	SDL_DestroyRenderer(renderer);
+	SDL_FreeSurface(target);
+	SDL_DestroyWindow(window);
+	SDL_Quit();
+	return result;
+}
@@ -0,0 +1,168 @@
+#include <SDL2/SDL.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <errno.h>
+
+#include "VENG/VENG.h"
+
+// Stand-in viewer for VENG_OpenSocketSink:
+// Listens on a UNIX socket, takes one VENG program at a time and applies the tiles it
+// streams to a texture the size of its frames.
+// Usage: VENG_viewer [socket path] (/tmp/VENG_stream.sock by default)
+
+static int __ReadAll(int fd, void* data, size_t size)
+{
+	Uint8* bytes = data;
+	while (size > 0)
+	{
+		ssize_t got = read(fd, bytes, size);
+		if (got < 0 && errno == EINTR)
+		{
+			continue;
+		}
+		if (got <= 0)
+		{
+			return 1;
+		}
+		bytes += got;
+		size -= got;
+	}
+	return 0;
+}
+
+// Reads a whole frame into the texture, recreated when the frame size changes
+static int __ReadFrame(int fd, SDL_Renderer* renderer, SDL_Texture** texture, Uint32** tile_pixels, size_t* tile_size)
+{
+	VENG_StreamFrameHeader frame;
+	if (__ReadAll(fd, &frame, sizeof(frame)) != 0 || frame.magic != VENG_STREAM_MAGIC || frame.w <= 0 || frame.h <= 0)
+	{
+		return 1;
+	}
+	int w = 0, h = 0;
+	if (*texture != NULL)
+	{
+		SDL_QueryTexture(*texture, NULL, NULL, &w, &h);
+	}
+	if (*texture == NULL || w != frame.w || h != frame.h)
+	{
+		if (*texture != NULL) SDL_DestroyTexture(*texture);
+		*texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, frame.w, frame.h);
+		if (*texture == NULL)
+		{
+			printf("Couldn't create texture: %s\n", SDL_GetError());
+			return 1;
+		}
+	}
+	for (Uint32 i = 0; i < frame.tiles; i++)
+	{
+		VENG_StreamTileHeader tile;
+		if (__ReadAll(fd, &tile, sizeof(tile)) != 0 || tile.w <= 0 || tile.h <= 0 || tile.x < 0 || tile.y < 0 || tile.x + tile.w > frame.w || tile.y + tile.h > frame.h)
+		{
+			return 1;
+		}
+		size_t size = (size_t)tile.w * tile.h;
+		if (size > *tile_size)
+		{
+			Uint32* new_pixels = realloc(*tile_pixels, size * sizeof(Uint32));
+			if (new_pixels == NULL)
+			{
+				return 1;
+			}
+			*tile_pixels = new_pixels;
+			*tile_size = size;
+		}
+		if (__ReadAll(fd, *tile_pixels, size * sizeof(Uint32)) != 0)
+		{
+			return 1;
+		}
+		SDL_UpdateTexture(*texture, &(SDL_Rect){tile.x, tile.y, tile.w, tile.h}, *tile_pixels, tile.w * sizeof(Uint32));
+	}
+	return 0;
+}
+
+int main(int argc, char* argv[])
+{
+	const char* path = argc > 1 ? argv[1] : "/tmp/VENG_stream.sock";
+	struct sockaddr_un address = {0};
+	if (strlen(path) >= sizeof(address.sun_path))
+	{
+		printf("Socket path is too long\n");
+		return 1;
+	}
+	address.sun_family = AF_UNIX;
+	strcpy(address.sun_path, path);
+	unlink(path);
+	int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (listener < 0 || bind(listener, (struct sockaddr*)&address, sizeof(address)) != 0 || listen(listener, 1) != 0)
+	{
+		printf("Couldn't listen on %s\n", path);
+		return 1;
+	}
+
+	if (SDL_Init(SDL_INIT_VIDEO) != 0)
+	{
+		printf("Couldn't start SDL: %s\n", SDL_GetError());
+		return 1;
+	}
+	SDL_Window* window = SDL_CreateWindow("VENG viewer", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, 800, 600, SDL_WINDOW_RESIZABLE);
+	SDL_Renderer* renderer = window != NULL ? SDL_CreateRenderer(window, -1, 0) : NULL;
+	if (renderer == NULL)
+	{
+		printf("Couldn't create the window: %s\n", SDL_GetError());
+		return 1;
+	}
+	printf("Waiting on %s\n", path);
+
+	SDL_Texture* texture = NULL;
+	Uint32* tile_pixels = NULL;
+	size_t tile_size = 0;
+	int client = -1;
+	bool running = true;
+	while (running)
+	{
+		SDL_Event event;
+		while (SDL_PollEvent(&event))
+		{
+			running = running && event.type != SDL_QUIT;
+		}
+		// One frame at most per loop, so the window keeps responding
+		struct pollfd poll_fd = {client >= 0 ? client : listener, POLLIN, 0};
+		if (poll(&poll_fd, 1, 16) > 0)
+		{
+			if (client < 0)
+			{
+				client = accept(listener, NULL, NULL);
+				printf(client >= 0 ? "Connected\n" : "Couldn't accept\n");
+			}
+			else if (__ReadFrame(client, renderer, &texture, &tile_pixels, &tile_size) != 0)
+			{
+				printf("Disconnected\n");
+				close(client);
+				client = -1;
+			}
+		}
+		SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+		SDL_RenderClear(renderer);
+		if (texture != NULL)
+		{
+			SDL_RenderCopy(renderer, texture, NULL, NULL);
+		}
+		SDL_RenderPresent(renderer);
+	}
+
+	if (client >= 0) close(client);
+	close(listener);
+	unlink(path);
+	free(tile_pixels);
+	if (texture != NULL) SDL_DestroyTexture(texture);
+	SDL_DestroyRenderer(renderer);
+	SDL_DestroyWindow(window);
+	SDL_Quit();
+	return 0;
+}